@@ -1091,6 +1091,66 @@ struct wsrep {
 };
 
 
+/*!
+ * Optional provider extensions.
+ *
+ * Extensions are not members of wsrep_t to keep its binary layout intact.
+ * A provider that supports an extension exports a function under the given
+ * symbol name, application can look it up with dlsym() on wsrep_t::dlh.
+ */
+
+/*!
+ * @brief Asynchronous commit completion callback
+ *
+ * Called from a provider thread once certification and ordering outcome of
+ * a transaction submitted with wsrep_pre_commit_async() is known. If status
+ * is WSREP_OK, the transaction holds its place in commit order, so
+ * the application must complete the commit and call post_commit() (or
+ * post_rollback()) before returning from the callback, otherwise following
+ * transactions will not be able to commit.
+ *
+ * @param ctx    application context passed to wsrep_pre_commit_async()
+ * @param status same as would be returned by pre_commit()
+ * @param meta   transaction meta data, valid only for the duration of call
+ */
+typedef void (*wsrep_async_commit_cb_t) (void*                   ctx,
+                                         wsrep_status_t          status,
+                                         const wsrep_trx_meta_t* meta);
+
+#define WSREP_PRE_COMMIT_ASYNC_SYMBOL "wsrep_pre_commit_async"
+
+/*!
+ * @brief Asynchronous version of pre_commit()
+ *
+ * Returns as soon as the transaction is queued for replication, so that
+ * the caller may proceed with the next transaction while this one is being
+ * replicated and certified. The outcome is delivered to cb. Transactions
+ * of the same connection are replicated one at a time in the order they
+ * were submitted, ordering between connections is not guaranteed. Until cb
+ * is called the application must not access the transaction handle.
+ *
+ * @param wsrep     provider handle
+ * @param conn_id   connection ID
+ * @param ws_handle writeset of committing transaction
+ * @param flags     fine tuning the replication WSREP_FLAG_*
+ * @param cb        completion callback
+ * @param ctx       application context passed to cb
+ *
+ * @retval WSREP_OK              transaction accepted, cb will be called
+ * @retval WSREP_NOT_IMPLEMENTED asynchronous commit is not enabled,
+ *                               pre_commit() must be used
+ * @retval other                 transaction was not accepted (status as
+ *                               returned by pre_commit()), cb won't be called
+ */
+typedef wsrep_status_t (*wsrep_pre_commit_async_t) (
+    wsrep_t*                wsrep,
+    wsrep_conn_id_t         conn_id,
+    wsrep_ws_handle_t*      ws_handle,
+    uint32_t                flags,
+    wsrep_async_commit_cb_t cb,
+    void*                   ctx);
+
+
 /*!
  *
  * @brief Loads wsrep library
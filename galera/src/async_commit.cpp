@@ -0,0 +1,147 @@
+//
+// Copyright (C) 2017 Codership Oy <info@codership.com>
+//
+
+#include "async_commit.hpp"
+
+#include "gu_logger.hpp"
+#include "gu_throw.hpp"
+#include "gu_thread.hpp"
+
+#include <cassert>
+#include <cstring>
+
+std::deque<galera::AsyncCommit::Job>::iterator
+galera::AsyncCommit::next_job()
+{
+    std::deque<Job>::iterator i(queue_.begin());
+
+    while (i != queue_.end() && busy_.find(i->conn_id_) != busy_.end()) ++i;
+
+    return i;
+}
+
+void*
+galera::AsyncCommit::thd_func(void* arg)
+{
+    gu::RegisteredThread const reg("async_commit");
+    AsyncCommit* const ac(static_cast<AsyncCommit*>(arg));
+
+    while (true)
+    {
+        Job job;
+
+        {
+            gu::Lock lock(ac->mtx_);
+            std::deque<Job>::iterator i;
+
+            while ((i = ac->next_job()) == ac->queue_.end() && !ac->exit_)
+            {
+                lock.wait(ac->cond_);
+            }
+
+            if (ac->exit_) break;
+
+            job = *i;
+            ac->queue_.erase(i);
+            ac->busy_.insert(job.conn_id_);
+        }
+
+        ac->handler_.process_async_commit(job);
+
+        {
+            gu::Lock lock(ac->mtx_);
+            ac->busy_.erase(job.conn_id_);
+            // next job of this connection may be waited for by any worker
+            if (!ac->queue_.empty()) ac->cond_.broadcast();
+        }
+    }
+
+    return 0;
+}
+
+galera::AsyncCommit::AsyncCommit(Handler& handler)
+    :
+    handler_(handler),
+    mtx_    (),
+    cond_   (),
+    queue_  (),
+    busy_   (),
+    thds_   (),
+    exit_   (false)
+{ }
+
+galera::AsyncCommit::~AsyncCommit()
+{
+    stop();
+}
+
+void
+galera::AsyncCommit::start(int const n)
+{
+    gu::Lock lock(mtx_);
+
+    assert(thds_.empty());
+    exit_ = false;
+
+    for (int i(0); i < n; ++i)
+    {
+        gu_thread_t thd;
+        int const err(gu_thread_create(&thd, NULL, thd_func, this));
+
+        if (err)
+        {
+            log_warn << "Failed to start async commit thread: " << err
+                     << " (" << strerror(err) << "), " << thds_.size()
+                     << " threads running";
+            break;
+        }
+
+        thds_.push_back(thd);
+    }
+}
+
+void
+galera::AsyncCommit::stop()
+{
+    std::deque<Job> pending;
+
+    {
+        gu::Lock lock(mtx_);
+        if (thds_.empty()) return;
+        exit_ = true;
+        pending.swap(queue_);
+        cond_.broadcast();
+    }
+
+    // only stop() changes thds_, it can be read here without the lock
+    for (size_t i(0); i < thds_.size(); ++i)
+    {
+        gu_thread_join(thds_[i], NULL);
+    }
+
+    {
+        gu::Lock lock(mtx_);
+        thds_.clear();
+        assert(busy_.empty());
+    }
+
+    for (std::deque<Job>::iterator i(pending.begin()); i != pending.end();
+         ++i)
+    {
+        handler_.cancel_async_commit(*i);
+    }
+}
+
+bool
+galera::AsyncCommit::submit(const Job& job)
+{
+    gu::Lock lock(mtx_);
+
+    if (gu_unlikely(thds_.empty() || exit_)) return false;
+
+    queue_.push_back(job);
+    cond_.signal();
+
+    return true;
+}
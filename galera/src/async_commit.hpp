@@ -0,0 +1,98 @@
+//
+// Copyright (C) 2017 Codership Oy <info@codership.com>
+//
+
+//! @file async_commit.hpp
+//
+// @brief Thread pool serving asynchronous pre_commit() requests
+//
+// Jobs of the same connection are processed one at a time in the order
+// they were submitted, jobs of different connections run concurrently.
+//
+
+#ifndef GALERA_ASYNC_COMMIT_HPP
+#define GALERA_ASYNC_COMMIT_HPP
+
+#include "wsrep_api.h"
+
+#include "gu_lock.hpp"
+#include "gu_threads.h"
+
+#include <deque>
+#include <set>
+#include <vector>
+
+namespace galera
+{
+    class TrxHandle;
+
+    class AsyncCommit
+    {
+    public:
+
+        struct Job
+        {
+            TrxHandle*              trx_;
+            wsrep_conn_id_t         conn_id_;
+            uint32_t                flags_;
+            wsrep_async_commit_cb_t cb_;
+            void*                   ctx_;
+        };
+
+        class Handler
+        {
+        public:
+            /*! replicates and certifies trx, must call job.cb_ */
+            virtual void process_async_commit(const Job& job) = 0;
+            /*! called for jobs which are dropped at shutdown */
+            virtual void cancel_async_commit(const Job& job) = 0;
+        protected:
+            virtual ~Handler() {}
+        };
+
+        AsyncCommit(Handler& handler);
+
+        ~AsyncCommit();
+
+        /*! starts n worker threads */
+        void start(int n);
+
+        /*! stops worker threads, cancels pending jobs */
+        void stop();
+
+        /*! @return false if no worker threads are running */
+        bool submit(const Job& job);
+
+        bool enabled() const
+        {
+            gu::Lock lock(mtx_);
+            return !thds_.empty();
+        }
+
+        size_t queue_len() const
+        {
+            gu::Lock lock(mtx_);
+            return queue_.size();
+        }
+
+    private:
+
+        Handler&              handler_;
+        mutable gu::Mutex     mtx_;
+        gu::Cond              cond_;
+        std::deque<Job>       queue_;
+        std::set<wsrep_conn_id_t> busy_; // connections being processed
+        std::vector<gu_thread_t> thds_;
+        bool                  exit_;
+
+        /*! @return first queued job of a connection which is not busy */
+        std::deque<Job>::iterator next_job();
+
+        static void* thd_func(void*);
+
+        AsyncCommit(const AsyncCommit&);
+        AsyncCommit& operator=(const AsyncCommit&);
+    };
+}
+
+#endif /* GALERA_ASYNC_COMMIT_HPP */
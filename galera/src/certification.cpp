@@ -7,8 +7,10 @@
 
 #include "gu_lock.hpp"
 #include "gu_throw.hpp"
+#include "gu_event_trace.hpp"
 
 #include <map>
+#include <algorithm>
 
 using namespace galera;
 
@@ -23,6 +25,8 @@ static std::string const CERT_PARAM_PREFIX("cert.");
 
 std::string const galera::Certification::PARAM_LOG_CONFLICTS(CERT_PARAM_PREFIX +
                                                              "log_conflicts");
+std::string const galera::Certification::PARAM_KEYED_TOI(CERT_PARAM_PREFIX +
+                                                         "keyed_toi");
 
 static std::string const CERT_PARAM_MAX_LENGTH   (CERT_PARAM_PREFIX +
                                                   "max_length");
@@ -30,6 +34,7 @@ static std::string const CERT_PARAM_LENGTH_CHECK (CERT_PARAM_PREFIX +
                                                   "length_check");
 
 static std::string const CERT_PARAM_LOG_CONFLICTS_DEFAULT("no");
+static std::string const CERT_PARAM_KEYED_TOI_DEFAULT("no");
 
 /*** It is EXTREMELY important that these constants are the same on all nodes.
  *** Don't change them ever!!! ***/
@@ -40,6 +45,7 @@ void
 galera::Certification::register_params(gu::Config& cnf)
 {
     cnf.add(CERT_PARAM_LOG_CONFLICTS, CERT_PARAM_LOG_CONFLICTS_DEFAULT);
+    cnf.add(Certification::PARAM_KEYED_TOI, CERT_PARAM_KEYED_TOI_DEFAULT);
     /* The defaults below are deliberately not reflected in conf: people
      * should not know about these dangerous setting unless they read RTFM. */
     cnf.add(CERT_PARAM_MAX_LENGTH);
@@ -500,7 +506,9 @@ certify_and_depend_v3(const galera::KeyEntryNG*   const found,
         // cert conflict takes place if
         // 1) write sets originated from different nodes, are within cert range
         // 2) ref_trx is in isolation mode, write sets are within cert range
-        if ((trx->source_id() != ref_trx->source_id() || ref_trx->is_toi()) &&
+        // isolated trxs never fail, they only collect dependencies
+        if (!trx->is_toi() &&
+            (trx->source_id() != ref_trx->source_id() || ref_trx->is_toi()) &&
             ref_seqno >  trx->last_seen_seqno())
         {
             if (gu_unlikely(log_conflict == true))
@@ -565,10 +573,9 @@ certify_v3(galera::Certification::CertIndexNG& cert_index_ng,
         cert_debug << "found existing entry";
 
         galera::KeyEntryNG* const kep(*ci);
-        // Note: For we skip certification for isolated trxs, only
-        // cert index and key_list is populated.
-        return (!trx->is_toi() &&
-                certify_and_depend_v3(kep, key, trx, log_conflicts));
+        // Note: isolated trxs are not checked for conflicts, only their
+        // dependencies are updated and cert index and key_list populated.
+        return certify_and_depend_v3(kep, key, trx, log_conflicts);
     }
 }
 
@@ -727,8 +734,9 @@ galera::Certification::do_test(TrxHandle* trx, bool store_keys)
     gu::Lock lock(mutex_); // why do we need that? - e.g. set_trx_committed()
 
     /* initialize parent seqno */
-    if ((trx->flags() & (TrxHandle::F_ISOLATION | TrxHandle::F_PA_UNSAFE))
-        || trx_map_.empty())
+    if ((trx->flags() & TrxHandle::F_PA_UNSAFE) ||
+        (trx->is_toi() && !keyed_toi(trx)) ||
+        trx_map_.empty())
     {
         trx->set_depends_seqno(trx->global_seqno() - 1);
     }
@@ -816,7 +824,7 @@ galera::Certification::Certification(gu::Config& conf, ServiceThd& thd)
     cert_index_ng_         (),
     deps_set_              (),
     service_thd_           (thd),
-    mutex_                 (),
+    mutex_                 ("certification"),
     trx_size_warn_count_   (0),
     initial_position_      (-1),
     position_              (-1),
@@ -835,7 +843,8 @@ galera::Certification::Certification(gu::Config& conf, ServiceThd& thd)
 
     max_length_            (max_length(conf)),
     max_length_check_      (length_check(conf)),
-    log_conflicts_         (conf.get<bool>(CERT_PARAM_LOG_CONFLICTS))
+    log_conflicts_         (conf.get<bool>(CERT_PARAM_LOG_CONFLICTS)),
+    keyed_toi_             (conf.get<bool>(PARAM_KEYED_TOI))
 {}
 
 
@@ -920,9 +929,14 @@ galera::Certification::test(TrxHandle* trx, bool bval)
 {
     assert(trx->global_seqno() >= 0 && trx->local_seqno() >= 0);
 
+    long long const start(gu::EventTrace::start());
+
     const TestResult ret
         (trx->preordered() ? do_test_preordered(trx) : do_test(trx, bval));
 
+    gu::EventTrace::record(gu::EventTrace::EV_CERT_TEST, trx->global_seqno(),
+                           trx->trx_id(), start);
+
     if (gu_unlikely(ret != TEST_OK))
     {
         // make sure that last depends seqno is -1 for trxs that failed
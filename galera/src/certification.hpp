@@ -24,6 +24,7 @@ namespace galera
     public:
 
         static std::string const PARAM_LOG_CONFLICTS;
+        static std::string const PARAM_KEYED_TOI;
 
         static void register_params(gu::Config&);
 
@@ -107,6 +108,16 @@ namespace galera
 
         void set_log_conflicts(const std::string& str);
 
+        /*! TO isolated actions which carry keys are certified as regular
+         *  write sets and don't serialize unrelated ones (cert.keyed_toi) */
+        bool keyed_toi(const TrxHandle* trx) const
+        {
+            return (keyed_toi_ && trx->is_toi() && trx->new_version() &&
+                    trx->write_set_in().keyset().count() > 0);
+        }
+
+        bool keyed_toi() const { return keyed_toi_; }
+
     private:
 
         TestResult do_test(TrxHandle*, bool);
@@ -211,6 +222,7 @@ namespace galera
         unsigned int const max_length_check_; /* Mask how often to check */
 
         bool               log_conflicts_;
+        bool         const keyed_toi_;
     };
 }
 
@@ -43,7 +43,7 @@ namespace galera
         virtual ssize_t replv(const WriteSetVector&,
                               gcs_action& act, bool) = 0;
         virtual ssize_t repl (gcs_action& act, bool) = 0;
-        virtual gcs_seqno_t caused() = 0;
+        virtual gcs_seqno_t caused(long long lease) = 0;
         virtual ssize_t schedule() = 0;
         virtual ssize_t interrupt(ssize_t) = 0;
         virtual ssize_t resume_recv() = 0;
@@ -54,6 +54,7 @@ namespace galera
                                                const gu_uuid_t& ist_uuid,
                                                gcs_seqno_t ist_seqno,
                                                gcs_seqno_t* seqno_l) = 0;
+        virtual int     ist_stripes() = 0;
         virtual ssize_t desync(gcs_seqno_t* seqno_l) = 0;
         virtual void    join(gcs_seqno_t seqno) = 0;
         virtual gcs_seqno_t local_sequence() = 0;
@@ -141,7 +142,10 @@ namespace galera
             return gcs_repl(conn_, &act, scheduled);
         }
 
-        gcs_seqno_t caused() { return gcs_caused(conn_);   }
+        gcs_seqno_t caused(long long lease)
+        {
+            return gcs_caused(conn_, lease);
+        }
 
         ssize_t schedule()   { return gcs_schedule(conn_); }
 
@@ -175,6 +179,11 @@ namespace galera
                                               seqno_l);
         }
 
+        int ist_stripes()
+        {
+            return gcs_ist_stripes(conn_);
+        }
+
         ssize_t desync (gcs_seqno_t* seqno_l)
         {
             return gcs_desync(conn_, seqno_l);
@@ -311,7 +320,7 @@ namespace galera
             return ret;
         }
 
-        gcs_seqno_t caused() { return global_seqno_; }
+        gcs_seqno_t caused(long long lease) { return global_seqno_; }
 
         ssize_t schedule()
         {
@@ -347,6 +356,11 @@ namespace galera
             return -ENOSYS;
         }
 
+        int ist_stripes()
+        {
+            return 1;
+        }
+
         ssize_t desync (gcs_seqno_t* seqno_l)
         {
             *seqno_l = GCS_SEQNO_ILL;
@@ -7,6 +7,8 @@
 
 #include "galera_service_thd.hpp"
 
+#include "gu_thread.hpp"
+
 const uint32_t galera::ServiceThd::A_NONE = 0;
 
 static const uint32_t A_LAST_COMMITTED = 1U <<  0;
@@ -17,6 +19,7 @@ static const uint32_t A_EXIT           = 1U << 31;
 void*
 galera::ServiceThd::thd_func (void* arg)
 {
+    gu::RegisteredThread const reg("service");
     galera::ServiceThd* st = reinterpret_cast<galera::ServiceThd*>(arg);
     bool exit = false;
 
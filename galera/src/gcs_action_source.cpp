@@ -7,6 +7,7 @@
 #include "trx_handle.hpp"
 
 #include "gu_serialize.hpp"
+#include "gu_probe.h"
 
 #include "galera_info.hpp"
 
@@ -111,6 +112,7 @@ void galera::GcsActionSource::dispatch(void* const              recv_ctx,
     case GCS_ACT_TORDERED:
     {
         assert(act.seqno_g > 0);
+        GU_PROBE2(galera, trx_delivered, act.seqno_g, act.size);
         GcsActionTrx trx(trx_pool_, act);
         trx.trx()->set_state(TrxHandle::S_REPLICATING);
         gu_trace(replicator_.process_trx(recv_ctx, trx.trx()));
@@ -148,8 +150,16 @@ void galera::GcsActionSource::dispatch(void* const              recv_ctx,
         break;
     }
     case GCS_ACT_STATE_REQ:
-        gu_trace(replicator_.process_state_req(recv_ctx, act.buf, act.size,
-                                               act.seqno_l, act.seqno_g));
+        if (gu_unlikely(GCS_STR_STRIPE_HELPER == act.seqno_g))
+        {
+            gu_trace(replicator_.process_ist_stripe_req(act.buf, act.size,
+                                                        act.seqno_l));
+        }
+        else
+        {
+            gu_trace(replicator_.process_state_req(recv_ctx, act.buf, act.size,
+                                                   act.seqno_l, act.seqno_g));
+        }
         break;
     case GCS_ACT_JOIN:
     {
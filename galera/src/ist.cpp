@@ -8,7 +8,11 @@
 #include "gu_logger.hpp"
 #include "gu_uri.hpp"
 #include "gu_debug_sync.hpp"
+#include "gu_probe.h"
 #include "gu_progress.hpp"
+#include "gu_limits.h"
+#include "gu_time.h"
+#include "gu_thread.hpp"
 
 #include "GCache.hpp"
 #include "galera_common.hpp"
@@ -16,10 +20,81 @@
 #include <fstream>
 #include <algorithm>
 
+#include <poll.h>
+#include <sys/mman.h>
+
 namespace
 {
     static std::string const CONF_KEEP_KEYS     ("ist.keep_keys");
     static bool        const CONF_KEEP_KEYS_DEFAULT (true);
+
+    // length of seqno blocks the range is split into for striped IST
+    static uint32_t    const STRIPE_BLOCK       (256);
+    static int         const STRIPE_ACCEPT_TIMEOUT_MS (60000);
+
+    // number of batches kept for overlapping async senders, each up to
+    // 1024 write sets
+    static size_t      const SHARED_WINDOW      (16);
+
+    typedef asio::ip::tcp::socket                    Socket;
+    typedef asio::ssl::stream<asio::ip::tcp::socket> SslStream;
+
+    template <class S> S* new_stream(asio::io_service&, asio::ssl::context&);
+
+    template <> Socket*
+    new_stream<Socket>(asio::io_service& io_service, asio::ssl::context&)
+    {
+        return new Socket(io_service);
+    }
+
+    template <> SslStream*
+    new_stream<SslStream>(asio::io_service& io_service,
+                          asio::ssl::context& ssl_ctx)
+    {
+        return new SslStream(io_service, ssl_ctx);
+    }
+
+    void stream_accepted(Socket& socket)
+    {
+        gu::set_fd_options(socket);
+    }
+
+    void stream_accepted(SslStream& ssl_stream)
+    {
+        gu::set_fd_options(ssl_stream.lowest_layer());
+        ssl_stream.handshake(SslStream::server);
+    }
+
+    // waits for incoming connection on listening socket fd, restarts with
+    // the remaining time if interrupted by a signal
+    // @return false on timeout, throws on error
+    bool wait_acceptable(int const fd, long long const timeout_ms)
+    {
+        long long const until(gu_time_monotonic() +
+                              timeout_ms * gu::datetime::MSec);
+
+        struct pollfd pfd;
+        pfd.fd     = fd;
+        pfd.events = POLLIN;
+
+        for (;;)
+        {
+            long long const left((until - gu_time_monotonic()) /
+                                 gu::datetime::MSec);
+
+            pfd.revents = 0;
+            int const ret(::poll(&pfd, 1, left > 0 ? left : 0));
+
+            if (ret > 0)  return true;
+            if (ret == 0) return false;
+
+            int const err(errno);
+            if (err != EINTR)
+            {
+                gu_throw_error(err) << "poll() on IST listener failed";
+            }
+        }
+    }
 }
 
 
@@ -39,29 +114,56 @@ namespace galera
                 :
                 Sender (conf, asmap.gcache(), peer, version),
                 conf_  (conf),
-                peer_  (peer),
                 first_ (first),
                 last_  (last),
                 asmap_ (asmap),
-                thread_()
-            { }
+                thread_(),
+                busy_q_len_(conf.get("gcs.fc_limit", 16) / 2)
+            {
+                // gcache lock is managed by the shared cursor from now on
+                release_lock_ = false;
+                asmap_.cursor().attach(this, first);
+            }
+
+            ~AsyncSender()
+            {
+                asmap_.cursor().detach(this);
+            }
 
             const gu::Config&  conf()   { return conf_;   }
-            const std::string& peer()   { return peer_;   }
             wsrep_seqno_t      first()  { return first_;  }
             wsrep_seqno_t      last()   { return last_;   }
             AsyncSenderMap&    asmap()  { return asmap_;  }
             gu_thread_t          thread() { return thread_; }
 
+            bool donor_busy() const
+            {
+                // back off before donor's recv queue hits flow control
+                gcs_stats stats;
+                asmap_.gcs().get_stats(&stats);
+                return (stats.recv_q_len > busy_q_len_);
+            }
+
+            ssize_t get_buffers(std::vector<gcache::GCache::Buffer>& bufs,
+                                wsrep_seqno_t const                  first)
+            {
+                return asmap_.cursor().get(this, bufs, first);
+            }
+
+            bool buffers_shared() const
+            {
+                return asmap_.cursor().shared();
+            }
+
         private:
 
             friend class AsyncSenderMap;
             const gu::Config&  conf_;
-            const std::string  peer_;
             wsrep_seqno_t      first_;
             wsrep_seqno_t      last_;
             AsyncSenderMap&    asmap_;
             gu_thread_t        thread_;
+            int const          busy_q_len_;
 
             // GCC 4.8.5 on FreeBSD wants it
             AsyncSender(const AsyncSender&);
@@ -75,12 +177,27 @@ std::string const
 galera::ist::Receiver::RECV_ADDR("ist.recv_addr");
 std::string const
 galera::ist::Receiver::RECV_BIND("ist.recv_bind");
+std::string const
+galera::ist::Receiver::STRIPES("ist.stripes");
+std::string const
+galera::ist::Receiver::RESUME_TIMEOUT("ist.resume_timeout");
+std::string const
+galera::ist::Sender::SEND_RATE("ist.send_rate");
+std::string const
+galera::ist::Sender::READAHEAD("ist.readahead");
+std::string const
+galera::ist::Sender::ADAPTIVE("ist.adaptive");
 
 void
 galera::ist::register_params(gu::Config& conf)
 {
     conf.add(Receiver::RECV_ADDR);
     conf.add(Receiver::RECV_BIND);
+    conf.add(Receiver::STRIPES);
+    conf.add(Receiver::RESUME_TIMEOUT);
+    conf.add(Sender::SEND_RATE);
+    conf.add(Sender::READAHEAD);
+    conf.add(Sender::ADAPTIVE);
     conf.add(CONF_KEEP_KEYS);
 }
 
@@ -103,9 +220,11 @@ galera::ist::Receiver::Receiver(gu::Config&           conf,
     thread_       (),
     error_code_   (0),
     version_      (-1),
+    stripes_      (1),
     use_ssl_      (false),
     running_      (false),
-    ready_        (false)
+    ready_        (false),
+    interrupted_  (false)
 {
     std::string recv_addr;
     std::string recv_bind;
@@ -143,6 +262,7 @@ galera::ist::Receiver::~Receiver()
 
 extern "C" void* run_receiver_thread(void* arg)
 {
+    gu::RegisteredThread const reg("ist_recv");
     galera::ist::Receiver* receiver(static_cast<galera::ist::Receiver*>(arg));
     receiver->run();
     return 0;
@@ -281,6 +401,8 @@ galera::ist::Receiver::prepare(wsrep_seqno_t first_seqno,
                                int           version)
 {
     ready_ = false;
+    interrupted_ = false;
+    stripes_ = 1;
     version_ = version;
     recv_addr_ = IST_determine_recv_addr(conf_);
     try
@@ -306,23 +428,19 @@ galera::ist::Receiver::prepare(wsrep_seqno_t first_seqno,
             gu::ssl_prepare_context(conf_, ssl_ctx_, version >= 7);
         }
 
-        asio::ip::tcp::resolver resolver(io_service_);
-        asio::ip::tcp::resolver::query
-            query(gu::unescape_addr(uri_bind.get_host()),
-                  uri_bind.get_port(),
-                  asio::ip::tcp::resolver::query::flags(0));
-        asio::ip::tcp::resolver::iterator i(resolver.resolve(query));
-        acceptor_.open(i->endpoint().protocol());
-        acceptor_.set_option(asio::ip::tcp::socket::reuse_address(true));
-        gu::set_fd_options(acceptor_);
-        acceptor_.bind(*i);
-        acceptor_.listen();
+        listen(recv_bind_);
         // read recv_addr_ from acceptor_ in case zero port was specified
         recv_addr_ = uri_addr.get_scheme()
             + "://"
             + uri_addr.get_host()
             + ":"
             + gu::to_string(acceptor_.local_endpoint().port());
+        // resume_stripe() reopens the listener, it must be the same port
+        recv_bind_ = uri_bind.get_scheme()
+            + "://"
+            + uri_bind.get_host()
+            + ":"
+            + gu::to_string(acceptor_.local_endpoint().port());
     }
     catch (asio::system_error& e)
     {
@@ -354,24 +472,58 @@ galera::ist::Receiver::prepare(wsrep_seqno_t first_seqno,
 }
 
 
+void galera::ist::Receiver::listen(const std::string& bind)
+{
+    gu::URI const uri_bind(bind);
+    asio::ip::tcp::resolver resolver(io_service_);
+    asio::ip::tcp::resolver::query
+        query(gu::unescape_addr(uri_bind.get_host()),
+              uri_bind.get_port(),
+              asio::ip::tcp::resolver::query::flags(0));
+    asio::ip::tcp::resolver::iterator i(resolver.resolve(query));
+    acceptor_.open(i->endpoint().protocol());
+    acceptor_.set_option(asio::ip::tcp::socket::reuse_address(true));
+    gu::set_fd_options(acceptor_);
+    acceptor_.bind(*i);
+    acceptor_.listen();
+}
+
+
 void galera::ist::Receiver::run()
 {
-    asio::ip::tcp::socket socket(io_service_);
-    asio::ssl::stream<asio::ip::tcp::socket> ssl_stream(io_service_, ssl_ctx_);
-    try
+    if (use_ssl_ == true)
     {
-        if (use_ssl_ == true)
-        {
-            acceptor_.accept(ssl_stream.lowest_layer());
-            gu::set_fd_options(ssl_stream.lowest_layer());
-            ssl_stream.handshake(asio::ssl::stream<asio::ip::tcp::socket>::server);
-        }
-        else
+        run_stripes<SslStream>();
+    }
+    else
+    {
+        run_stripes<Socket>();
+    }
+}
+
+
+template <class S>
+void galera::ist::Receiver::accept_stripe(std::vector<S*>& streams, Proto& p)
+{
+    S* const stream(new_stream<S>(io_service_, ssl_ctx_));
+    streams.push_back(stream);
+
+    if (streams.size() > 1)
+    {
+        // helpers connect as soon as they process the request, normally
+        // long before we get here, don't wait forever for one that failed
+        if (!wait_acceptable(acceptor_.native(), STRIPE_ACCEPT_TIMEOUT_MS))
         {
-            acceptor_.accept(socket);
-            gu::set_fd_options(socket);
+            gu_throw_error(ETIMEDOUT) << "IST stripe " << streams.size() - 1
+                                      << " sender did not connect";
         }
     }
+
+    try
+    {
+        acceptor_.accept(stream->lowest_layer());
+        stream_accepted(*stream);
+    }
     catch (asio::system_error& e)
     {
         gu_throw_error(e.code().value()) << "accept() failed"
@@ -379,32 +531,129 @@ void galera::ist::Receiver::run()
                                          << e.what() << "': "
                                          << gu::extra_error_info(e.code());
     }
+
+    p.send_handshake(*stream);
+    p.recv_handshake_response(*stream);
+}
+
+
+/* Replaces broken stream idx with a connection from a sender that resumes
+ * the stripe from current_seqno_. The acceptor is closed while streaming so
+ * that interrupt() can't get stuck in it, reopen it for ist.resume_timeout.
+ * @return false if no sender came back in time */
+template <class S>
+bool galera::ist::Receiver::resume_stripe(std::vector<S*>& streams,
+                                          Proto&           p,
+                                          int const        idx)
+{
+    {
+        gu::Lock lock(mutex_);
+        if (interrupted_) return false;
+    }
+
+    streams[idx]->lowest_layer().close();
+    delete streams[idx];
+    streams[idx] = 0;
+
+    gu::datetime::Period const timeout(
+        conf_.get(RESUME_TIMEOUT, std::string("PT30S")));
+
+    if (timeout.get_nsecs() <= 0) return false;
+
+    try
+    {
+        listen(recv_bind_);
+    }
+    catch (asio::system_error& e)
+    {
+        log_warn << "Failed to reopen IST listener: " << e.what();
+        return false;
+    }
+
+    log_info << "Waiting " << timeout << " for IST stripe " << idx
+             << " sender to resume from " << current_seqno_;
+
+    bool accepted(false);
+
+    try
+    {
+        accepted = wait_acceptable(acceptor_.native(),
+                                   timeout.get_nsecs() / gu::datetime::MSec);
+    }
+    catch (gu::Exception& e)
+    {
+        log_warn << e.what();
+    }
+
+    if (!accepted)
+    {
+        acceptor_.close();
+        return false;
+    }
+
+    S* const stream(new_stream<S>(io_service_, ssl_ctx_));
+    streams[idx] = stream;
+
+    acceptor_.accept(stream->lowest_layer());
     acceptor_.close();
+    stream_accepted(*stream);
+
+    p.send_handshake(*stream, current_seqno_);
+    p.recv_handshake_response(*stream);
+    p.send_ctrl(*stream, Ctrl::C_OK,
+                Stripe(idx, streams.size(), STRIPE_BLOCK).packed());
+
+    log_info << "IST stripe " << idx << " resumed from " << current_seqno_;
+
+    return true;
+}
+
+
+template <class S>
+void galera::ist::Receiver::run_stripes()
+{
+    std::vector<S*> streams;
+    // each stream has its own receive buffer
+    std::vector<Proto*> readers;
     int ec(0);
     try
     {
-        Proto p(trx_pool_, version_,
-                conf_.get(CONF_KEEP_KEYS, CONF_KEEP_KEYS_DEFAULT));
+        bool const keep_keys(conf_.get(CONF_KEEP_KEYS,
+                                       CONF_KEEP_KEYS_DEFAULT));
+        Proto p(trx_pool_, version_, keep_keys);
 
-        if (use_ssl_ == true)
+        accept_stripe(streams, p);
+
+        /* wait for ready signal from the STR thread, it also tells how many
+         * senders to expect */
         {
-            p.send_handshake(ssl_stream);
-            p.recv_handshake_response(ssl_stream);
-            p.send_ctrl(ssl_stream, Ctrl::C_OK);
+            gu::Lock lock(mutex_);
+            while (ready_ == false && interrupted_ == false) lock.wait(cond_);
+            if (interrupted_) gu_throw_error(EINTR);
         }
-        else
+
+        while (streams.size() < size_t(stripes_))
         {
-            p.send_handshake(socket);
-            p.recv_handshake_response(socket);
-            p.send_ctrl(socket, Ctrl::C_OK);
+            accept_stripe(streams, p);
         }
 
-        /* wait for ready signal from the STR thread */
+        acceptor_.close();
+
+        for (size_t i(0); i < streams.size(); ++i)
         {
-            gu::Lock lock(mutex_);
-            while (ready_ == false) lock.wait(cond_);
+            Stripe const stripe(i, streams.size(), STRIPE_BLOCK);
+            p.send_ctrl(*streams[i], Ctrl::C_OK, stripe.packed());
+            readers.push_back(new Proto(trx_pool_, version_, keep_keys));
+        }
+
+        if (streams.size() > 1)
+        {
+            log_info << "Receiving IST in " << streams.size() << " stripes";
         }
 
+        Stripe const layout(0, streams.size(), STRIPE_BLOCK);
+        wsrep_seqno_t const first(current_seqno_);
+
         gu::Progress<wsrep_seqno_t> progress(
             "Receiving IST",
             " events",
@@ -415,15 +664,31 @@ void galera::ist::Receiver::run()
 
         while (true)
         {
+            // seqno blocks are dealt round robin, so the stream to read the
+            // next write set from is known, the rest keep buffering meanwhile
+            int const idx(layout.of(first, current_seqno_));
             TrxHandle* trx;
-            if (use_ssl_ == true)
+
+            try
             {
-                trx = p.recv_trx(ssl_stream);
+                trx = readers[idx]->recv_trx(*streams[idx]);
             }
-            else
+            catch (asio::system_error& e)
             {
-                trx = p.recv_trx(socket);
+                log_warn << "IST stripe " << idx << " broken at "
+                         << current_seqno_ << ": " << e.what();
+
+                if (resume_stripe(streams, p, idx))
+                {
+                    readers[idx]->reset_recv();
+                    continue;
+                }
+
+                log_error << "IST stripe " << idx << " was not resumed";
+                ec = ECONNABORTED;
+                goto err;
             }
+
             if (trx != 0)
             {
                 if (trx->global_seqno() != current_seqno_)
@@ -433,10 +698,32 @@ void galera::ist::Receiver::run()
                     ec = EINVAL;
                     goto err;
                 }
+                GU_PROBE1(galera, ist_recv, current_seqno_);
                 ++current_seqno_;
 
                 progress.update(1);
             }
+            else
+            {
+                // no sender may have anything past the end of this stripe
+                for (size_t i(0); i < streams.size(); ++i)
+                {
+                    if (int(i) == idx) continue;
+
+                    TrxHandle* const extra(readers[i]->recv_trx(*streams[i]));
+
+                    if (extra != 0)
+                    {
+                        log_error << "stripe " << i << " sent "
+                                  << extra->global_seqno()
+                                  << " after stripe " << idx << " ended at "
+                                  << current_seqno_ - 1;
+                        extra->unref();
+                        ec = EPROTO;
+                        goto err;
+                    }
+                }
+            }
             gu::Lock lock(mutex_);
             assert(ready_);
             while (consumers_.empty()) lock.wait(cond_);
@@ -469,18 +756,20 @@ void galera::ist::Receiver::run()
 
 err:
     gu::Lock lock(mutex_);
-    if (use_ssl_ == true)
+    for (size_t i(0); i < streams.size(); ++i)
     {
-        ssl_stream.lowest_layer().close();
-        // ssl_stream.shutdown();
+        if (streams[i] == 0) continue;
+        streams[i]->lowest_layer().close();
+        delete streams[i];
     }
-    else
+    for (size_t i(0); i < readers.size(); ++i)
     {
-        socket.close();
+        delete readers[i];
     }
 
     running_ = false;
-    if (ec != EINTR && current_seqno_ - 1 < last_seqno_)
+    if (ec != EINTR && ec != ECONNABORTED &&
+        current_seqno_ - 1 < last_seqno_)
     {
         log_error << "IST didn't contain all write sets, expected last: "
                   << last_seqno_ << " last received: " << current_seqno_ - 1;
@@ -498,9 +787,10 @@ err:
 }
 
 
-void galera::ist::Receiver::ready()
+void galera::ist::Receiver::ready(int const stripes)
 {
     gu::Lock lock(mutex_);
+    stripes_ = std::max(stripes, 1);
     ready_ = true;
     cond_.signal();
 }
@@ -541,6 +831,14 @@ wsrep_seqno_t galera::ist::Receiver::finished()
     }
     else
     {
+        {
+            // receiver thread may be waiting for ready() with a sender
+            // already connected
+            gu::Lock lock(mutex_);
+            interrupted_ = true;
+            cond_.signal();
+        }
+
         interrupt();
 
         int err;
@@ -627,16 +925,34 @@ galera::ist::Sender::Sender(const gu::Config&  conf,
                             const std::string& peer,
                             int                version)
     :
+    release_lock_(true),
     io_service_(),
     socket_    (io_service_),
     ssl_ctx_   (io_service_, asio::ssl::context::sslv23),
     ssl_stream_(0),
+    stream_mtx_(),
     conf_      (conf),
     gcache_    (gcache),
+    peer_      (peer),
     version_   (version),
-    use_ssl_   (false)
+    use_ssl_   (false),
+    cancelled_ (false)
 {
-    gu::URI uri(peer);
+    gu::URI uri(peer_);
+    if (uri.get_scheme() == "ssl")
+    {
+        use_ssl_ = true;
+        log_info << "IST sender using ssl";
+        ssl_prepare_context(conf, ssl_ctx_);
+    }
+
+    connect();
+}
+
+
+void galera::ist::Sender::connect()
+{
+    gu::URI uri(peer_);
     try
     {
         asio::ip::tcp::resolver resolver(io_service_);
@@ -645,17 +961,14 @@ galera::ist::Sender::Sender(const gu::Config&  conf,
                   uri.get_port(),
                   asio::ip::tcp::resolver::query::flags(0));
         asio::ip::tcp::resolver::iterator i(resolver.resolve(query));
-        if (uri.get_scheme() == "ssl")
-        {
-            use_ssl_ = true;
-        }
         if (use_ssl_ == true)
         {
-            log_info << "IST sender using ssl";
-            ssl_prepare_context(conf, ssl_ctx_);
-            // ssl_stream must be created after ssl_ctx_ is prepared...
-            ssl_stream_ = new asio::ssl::stream<asio::ip::tcp::socket>(
-                io_service_, ssl_ctx_);
+            {
+                // ssl_stream must be created after ssl_ctx_ is prepared...
+                gu::Lock lock(stream_mtx_);
+                ssl_stream_ = new asio::ssl::stream<asio::ip::tcp::socket>(
+                    io_service_, ssl_ctx_);
+            }
             ssl_stream_->lowest_layer().connect(*i);
             gu::set_fd_options(ssl_stream_->lowest_layer());
             ssl_stream_->handshake(asio::ssl::stream<asio::ip::tcp::socket>::client);
@@ -669,127 +982,435 @@ galera::ist::Sender::Sender(const gu::Config&  conf,
     catch (asio::system_error& e)
     {
         gu_throw_error(e.code().value()) << "IST sender, failed to connect '"
-                                         << peer.c_str() << "': " << e.what();
+                                         << peer_.c_str() << "': " << e.what();
     }
 }
 
 
-galera::ist::Sender::~Sender()
+void galera::ist::Sender::close()
 {
+    gu::Lock lock(stream_mtx_);
+
     if (use_ssl_ == true)
     {
-        ssl_stream_->lowest_layer().close();
-        delete ssl_stream_;
+        if (ssl_stream_)
+        {
+            ssl_stream_->lowest_layer().close();
+            delete ssl_stream_;
+            ssl_stream_ = 0;
+        }
     }
     else
     {
         socket_.close();
     }
-    gcache_.seqno_unlock();
 }
 
-void galera::ist::Sender::send(wsrep_seqno_t first, wsrep_seqno_t last)
+
+void galera::ist::Sender::cancel()
 {
-    if (first > last)
+    cancelled_ = true;
+
+    gu::Lock lock(stream_mtx_);
+
+    if (use_ssl_ == true)
     {
-        gu_throw_error(EINVAL) << "sender send first greater than last: "
-                               << first << " > " << last ;
+        if (ssl_stream_) ssl_stream_->lowest_layer().close();
     }
-    try
+    else
     {
-        TrxHandle::SlavePool unused(1, 0, "");
-        Proto p(unused, version_,
-                conf_.get(CONF_KEEP_KEYS, CONF_KEEP_KEYS_DEFAULT));
-        int32_t ctrl;
+        socket_.close();
+    }
+}
 
-        if (use_ssl_ == true)
+
+bool galera::ist::Sender::reconnect(const gu::datetime::Date& deadline)
+{
+    close();
+
+    while (!cancelled_ && gu::datetime::Date::monotonic() < deadline)
+    {
+        try
         {
-            p.recv_handshake(*ssl_stream_);
-            p.send_handshake_response(*ssl_stream_);
-            ctrl = p.recv_ctrl(*ssl_stream_);
+            connect();
+            return true;
         }
-        else
+        catch (gu::Exception& e)
         {
-            p.recv_handshake(socket_);
-            p.send_handshake_response(socket_);
-            ctrl = p.recv_ctrl(socket_);
+            close();
+            log_debug << "IST sender reconnect failed: " << e.what();
         }
-        if (ctrl < 0)
+
+        usleep(1000000);
+    }
+
+    return false;
+}
+
+
+galera::ist::Sender::~Sender()
+{
+    close();
+    if (release_lock_) gcache_.seqno_unlock();
+}
+
+namespace
+{
+    static long long const THROTTLE_MAX_BURST   (gu::datetime::Sec);
+    static long long const THROTTLE_MIN_BACKOFF (10   * gu::datetime::MSec);
+    static long long const THROTTLE_MAX_BACKOFF (1000 * gu::datetime::MSec);
+    static long long const THROTTLE_SLEEP_SLICE (100  * gu::datetime::MSec);
+
+    /* Keeps IST from starving donor's own clients: paces sending to
+     * ist.send_rate bytes per second, with ist.adaptive backs off
+     * exponentially while the donor is busy and with ist.readahead asks
+     * the kernel to fault in the next batch of gcache buffers ahead of time
+     * and to reclaim the sent ones first. */
+    class Throttle
+    {
+    public:
+
+        Throttle(const gu::Config& conf, const galera::ist::Sender& sender)
+            :
+            sender_   (sender),
+            rate_     (conf.get<long long>(galera::ist::Sender::SEND_RATE,
+                                           0)),
+            readahead_(conf.get<bool>(galera::ist::Sender::READAHEAD, true)),
+            adaptive_ (conf.get<bool>(galera::ist::Sender::ADAPTIVE, false)),
+            next_     (gu_time_monotonic()),
+            backoff_  (0)
+        { }
+
+        /* called with a batch of buffers about to be sent */
+        void prefetch(const std::vector<gcache::GCache::Buffer>& bufs,
+                      ssize_t const n)
         {
-            gu_throw_error(EPROTO)
-                << "ist send failed, peer reported error: " << ctrl;
+            if (readahead_) advise(bufs, n, true);
         }
 
-        std::vector<gcache::GCache::Buffer> buf_vec(
-            std::min(static_cast<size_t>(last - first + 1),
-                     static_cast<size_t>(1024)));
-        ssize_t n_read;
-        while ((n_read = gcache_.seqno_get_buffers(buf_vec, first)) > 0)
+        /* called after the batch has been sent, may sleep */
+        void sent(const std::vector<gcache::GCache::Buffer>& bufs,
+                  ssize_t const n)
         {
-            GU_DBUG_SYNC_WAIT("ist_sender_send_after_get_buffers")
-            //log_info << "read " << first << " + " << n_read << " from gcache";
-            for (wsrep_seqno_t i(0); i < n_read; ++i)
+            // leave them to the last one if other senders may need them
+            if (readahead_ && !sender_.buffers_shared())
             {
-                // log_info << "sending " << buf_vec[i].seqno_g();
-                if (use_ssl_ == true)
-                {
-                    p.send_trx(*ssl_stream_, buf_vec[i]);
-                }
-                else
+                advise(bufs, n, false);
+            }
+
+            if (rate_ > 0)
+            {
+                long long bytes(0);
+                for (ssize_t i(0); i < n; ++i) bytes += bufs[i].size();
+                pace(bytes);
+            }
+
+            if (adaptive_) backoff();
+        }
+
+    private:
+
+        void pace(long long const bytes)
+        {
+            next_ += static_cast<long long>(
+                double(bytes) * gu::datetime::Sec / rate_);
+
+            long long const now(gu_time_monotonic());
+
+            if (next_ > now)
+            {
+                sleep(next_ - now);
+            }
+            else if (now - next_ > THROTTLE_MAX_BURST)
+            {
+                // don't let idle time accumulate into a long burst
+                next_ = now - THROTTLE_MAX_BURST;
+            }
+        }
+
+        void backoff()
+        {
+            if (sender_.donor_busy())
+            {
+                backoff_ = (backoff_ > 0 ?
+                            std::min(backoff_ * 2, THROTTLE_MAX_BACKOFF) :
+                            THROTTLE_MIN_BACKOFF);
+                sleep(backoff_);
+            }
+            else
+            {
+                backoff_ = 0;
+            }
+        }
+
+        /* sleeps in slices to stay responsive to cancel() */
+        void sleep(long long nsecs) const
+        {
+            while (nsecs > 0 && !sender_.cancelled())
+            {
+                long long const slice(std::min(nsecs, THROTTLE_SLEEP_SLICE));
+                usleep(slice / gu::datetime::USec);
+                nsecs -= slice;
+            }
+        }
+
+        /* Buffers of a batch mostly sit next to each other in gcache, so
+         * they are advised in contiguous runs. Prefetch extends runs to
+         * page boundaries, reclaim shrinks them in order not to touch
+         * neighbouring buffers that are not sent yet. */
+        static void advise(const std::vector<gcache::GCache::Buffer>& bufs,
+                           ssize_t const n, bool const willneed)
+        {
+            uintptr_t const page(GU_PAGE_SIZE);
+            uintptr_t begin(0), end(0);
+
+            for (ssize_t i(0); i <= n; ++i)
+            {
+                uintptr_t b(0), e(0);
+
+                if (i < n)
                 {
-                    p.send_trx(socket_, buf_vec[i]);
+                    b = reinterpret_cast<uintptr_t>(bufs[i].ptr());
+                    e = b + bufs[i].size();
+
+                    if (b >= begin && b <= end + page && end > 0)
+                    {
+                        end = std::max(end, e);
+                        continue;
+                    }
                 }
 
-                if (buf_vec[i].seqno_g() == last)
+                if (end > 0)
                 {
-                    if (use_ssl_ == true)
+                    if (willneed)
                     {
-                        p.send_ctrl(*ssl_stream_, Ctrl::C_EOF);
+                        begin &= ~(page - 1);
+                        end    = (end + page - 1) & ~(page - 1);
+                        posix_madvise(reinterpret_cast<void*>(begin),
+                                      end - begin, POSIX_MADV_WILLNEED);
                     }
                     else
                     {
-                        p.send_ctrl(socket_, Ctrl::C_EOF);
+                        begin = (begin + page - 1) & ~(page - 1);
+                        end  &= ~(page - 1);
+#ifdef MADV_COLD
+                        // unlike MADV_DONTNEED safe for anonymous memory
+                        if (end > begin)
+                            madvise(reinterpret_cast<void*>(begin),
+                                    end - begin, MADV_COLD);
+#endif
                     }
-                    // wait until receiver closes the connection
-                    try
-                    {
-                        gu::byte_t b;
-                        size_t n;
-                        if (use_ssl_ == true)
-                        {
-                            n = asio::read(*ssl_stream_, asio::buffer(&b, 1));
-                        }
-                        else
-                        {
-                            n = asio::read(socket_, asio::buffer(&b, 1));
-                        }
-                        if (n > 0)
-                        {
-                            log_warn << "received " << n
-                                     << " bytes, expected none";
-                        }
-                    }
-                    catch (asio::system_error& e)
-                    { }
-                    return;
                 }
+
+                begin = b;
+                end   = e;
             }
-            first += n_read;
+        }
+
+        const galera::ist::Sender& sender_;
+        long long const            rate_;
+        bool const                 readahead_;
+        bool const                 adaptive_;
+        long long                  next_;
+        long long                  backoff_;
+    };
+
+    /* sends write sets first..last from gcache,
+     * @return false if gcache didn't have all of them */
+    template <class S>
+    bool send_range(galera::ist::Proto&                  p,
+                    S&                                   stream,
+                    galera::ist::Sender&                 sender,
+                    Throttle&                            throttle,
+                    std::vector<gcache::GCache::Buffer>& buf_vec,
+                    wsrep_seqno_t                        first,
+                    wsrep_seqno_t const                  last)
+    {
+        while (first <= last)
+        {
             // resize buf_vec to avoid scanning gcache past last
-            size_t next_size(std::min(static_cast<size_t>(last - first + 1),
-                                      static_cast<size_t>(1024)));
+            size_t const next_size(std::min(static_cast<size_t>(last-first+1),
+                                            static_cast<size_t>(1024)));
 
             if (buf_vec.size() != next_size)
             {
                 buf_vec.resize(next_size);
             }
+
+            ssize_t const n_read(sender.get_buffers(buf_vec, first));
+
+            if (n_read <= 0) return false;
+
+            GU_DBUG_SYNC_WAIT("ist_sender_send_after_get_buffers")
+            GU_PROBE2(galera, ist_batch_send, first, n_read);
+            throttle.prefetch(buf_vec, n_read);
+            //log_info << "read " << first << " + " << n_read << " from gcache";
+            p.send_batch(stream, buf_vec, n_read);
+            throttle.sent(buf_vec, n_read);
+
+            first += n_read;
         }
+
+        return true;
     }
-    catch (asio::system_error& e)
+
+    /* sends stripe's share of first..last skipping write sets below from,
+     * which is past first when resuming interrupted transfer */
+    template <class S>
+    void send_stripe(galera::ist::Proto&         p,
+                     S&                          stream,
+                     galera::ist::Sender&        sender,
+                     Throttle&                   throttle,
+                     const galera::ist::Stripe&  stripe,
+                     wsrep_seqno_t const         first,
+                     wsrep_seqno_t const         last,
+                     wsrep_seqno_t const         from)
     {
-        gu_throw_error(e.code().value()) << "ist send failed: " << e.code()
-                                         << "', asio error '" << e.what()
-                                         << "'";
+        std::vector<gcache::GCache::Buffer> buf_vec;
+
+        if (stripe.num() > 1)
+        {
+            wsrep_seqno_t const block(stripe.block());
+            wsrep_seqno_t const step (block * stripe.num());
+
+            for (wsrep_seqno_t b(first + block * stripe.idx()); b <= last;
+                 b += step)
+            {
+                wsrep_seqno_t const lo(std::max(b, from));
+                wsrep_seqno_t const hi(std::min(b + block - 1, last));
+
+                if (lo > hi) continue;
+
+                if (!send_range(p, stream, sender, throttle, buf_vec,
+                                lo, hi)) return;
+            }
+        }
+        else
+        {
+            if (!send_range(p, stream, sender, throttle, buf_vec,
+                            std::max(first, from), last)) return;
+        }
+
+        p.send_ctrl(stream, galera::ist::Ctrl::C_EOF);
+
+        // wait until receiver closes the connection
+        try
+        {
+            gu::byte_t b;
+            size_t n;
+            n = asio::read(stream, asio::buffer(&b, 1));
+            if (n > 0)
+            {
+                log_warn << "received " << n << " bytes, expected none";
+            }
+        }
+        catch (asio::system_error& e)
+        { }
+    }
+
+    /* serves one connection to the receiver,
+     * fresh or reestablished after the previous one broke */
+    template <class S>
+    void serve(galera::ist::Proto& p,
+               S&                  stream,
+               galera::ist::Sender& sender,
+               Throttle&           throttle,
+               wsrep_seqno_t const first,
+               wsrep_seqno_t const last)
+    {
+        wsrep_seqno_t resume(0);
+        uint64_t stripe_packed(0);
+
+        p.recv_handshake(stream, &resume);
+        p.send_handshake_response(stream);
+        int32_t const ctrl(p.recv_ctrl(stream, &stripe_packed));
+
+        if (ctrl < 0)
+        {
+            gu_throw_error(EPROTO)
+                << "ist send failed, peer reported error: " << ctrl;
+        }
+
+        galera::ist::Stripe const stripe(stripe_packed);
+
+        if (stripe.num() > 1)
+        {
+            log_info << "IST sender serving stripe " << stripe.idx() << " of "
+                     << stripe.num();
+        }
+
+        wsrep_seqno_t from(first);
+
+        if (resume > 0)
+        {
+            if (resume < first || resume > last + 1)
+            {
+                gu_throw_error(EPROTO) << "IST resume position " << resume
+                                       << " outside of range " << first
+                                       << "-" << last;
+            }
+
+            log_info << "IST sender resuming from " << resume;
+            from = resume;
+        }
+
+        send_stripe(p, stream, sender, throttle, stripe, first, last, from);
+    }
+}
+
+void galera::ist::Sender::send(wsrep_seqno_t first, wsrep_seqno_t last)
+{
+    if (first > last)
+    {
+        gu_throw_error(EINVAL) << "sender send first greater than last: "
+                               << first << " > " << last ;
+    }
+
+    TrxHandle::SlavePool unused(1, 0, "");
+    Proto p(unused, version_,
+            conf_.get(CONF_KEEP_KEYS, CONF_KEEP_KEYS_DEFAULT));
+    Throttle throttle(conf_, *this);
+
+    while (true)
+    {
+        try
+        {
+            if (use_ssl_ == true)
+            {
+                serve(p, *ssl_stream_, *this, throttle, first, last);
+            }
+            else
+            {
+                serve(p, socket_, *this, throttle, first, last);
+            }
+
+            return;
+        }
+        catch (asio::system_error& e)
+        {
+            if (cancelled_)
+            {
+                gu_throw_error(e.code().value()) << "ist send cancelled: "
+                                                 << e.code();
+            }
+
+            // receiver keeps listening for ist.resume_timeout, reconnect
+            // and let it tell where to resume from
+            gu::datetime::Date const deadline(
+                gu::datetime::Date::monotonic() +
+                gu::datetime::Period(conf_.get(Receiver::RESUME_TIMEOUT,
+                                               std::string("PT30S"))));
+
+            log_warn << "IST connection to " << peer_ << " broken: "
+                     << e.what() << ", trying to resume";
+
+            if (!reconnect(deadline))
+            {
+                gu_throw_error(e.code().value())
+                    << "ist send failed: " << e.code()
+                    << "', asio error '" << e.what() << "'";
+            }
+        }
     }
 }
 
@@ -799,6 +1420,7 @@ void galera::ist::Sender::send(wsrep_seqno_t first, wsrep_seqno_t last)
 extern "C"
 void* run_async_sender(void* arg)
 {
+    gu::RegisteredThread const reg("ist_send");
     galera::ist::AsyncSender* as(reinterpret_cast<galera::ist::AsyncSender*>(arg));
     log_info << "async IST sender starting to serve " << as->peer().c_str()
              << " sending " << as->first() << "-" << as->last();
@@ -836,6 +1458,133 @@ void* run_async_sender(void* arg)
 }
 
 
+void galera::ist::SharedCursor::attach(const void* const   reader,
+                                       wsrep_seqno_t const seqno)
+{
+    gu::Lock lock(mtx_);
+
+    if (readers_.empty() || seqno < min_position())
+    {
+        // the new reader is the slowest, throws if history is gone already
+        gcache_.seqno_lock(seqno);
+    }
+
+    readers_[reader] = seqno;
+}
+
+
+void galera::ist::SharedCursor::detach(const void* const reader)
+{
+    gu::Lock lock(mtx_);
+
+    readers_.erase(reader);
+
+    if (readers_.empty())
+    {
+        log_info << "IST shared cursor: " << hits_ << " batches shared, "
+                 << misses_ << " read from gcache";
+        window_.clear();
+        hits_ = misses_ = 0;
+        gcache_.seqno_unlock();
+    }
+    else
+    {
+        relock();
+    }
+}
+
+
+ssize_t
+galera::ist::SharedCursor::get(const void* const                    reader,
+                               std::vector<gcache::GCache::Buffer>& bufs,
+                               wsrep_seqno_t const                  first)
+{
+    gu::Lock lock(mtx_);
+
+    readers_[reader] = first;
+
+    for (std::deque<Batch>::const_iterator b(window_.begin());
+         b != window_.end(); ++b)
+    {
+        wsrep_seqno_t const end(b->first_ + b->bufs_.size());
+
+        if (first >= b->first_ && first < end)
+        {
+            size_t const off(first - b->first_);
+            size_t const n(std::min(bufs.size(), b->bufs_.size() - off));
+
+            std::copy(b->bufs_.begin() + off, b->bufs_.begin() + off + n,
+                      bufs.begin());
+            ++hits_;
+            return n;
+        }
+    }
+
+    // readers missing the same batch at the same time wait here for the
+    // first one to read it. gcache lock must not move past slower readers
+    // even for a moment, they may still need what would be released.
+    ssize_t const n(gcache_.seqno_get_buffers(bufs, first, false));
+
+    if (n > 0)
+    {
+        ++misses_;
+
+        if (readers_.size() > 1)
+        {
+            window_.push_back(Batch(first, bufs, n));
+
+            while (window_.size() > SHARED_WINDOW) window_.pop_front();
+        }
+    }
+
+    // this reader has moved, the slowest one may have changed
+    relock();
+
+    return n;
+}
+
+
+bool galera::ist::SharedCursor::shared() const
+{
+    gu::Lock lock(mtx_);
+    return (readers_.size() > 1);
+}
+
+
+wsrep_seqno_t galera::ist::SharedCursor::min_position() const
+{
+    assert(!readers_.empty());
+
+    wsrep_seqno_t min(readers_.begin()->second);
+
+    for (std::map<const void*, wsrep_seqno_t>::const_iterator i(
+             readers_.begin()); i != readers_.end(); ++i)
+    {
+        min = std::min(min, i->second);
+    }
+
+    return min;
+}
+
+
+void galera::ist::SharedCursor::relock()
+{
+    if (readers_.empty()) return;
+
+    wsrep_seqno_t const min(min_position());
+
+    try
+    {
+        gcache_.seqno_lock(min);
+    }
+    catch (gu::NotFound&)
+    {
+        log_warn << "IST shared cursor: seqno " << min
+                 << " is not in gcache any more";
+    }
+}
+
+
 void galera::ist::AsyncSenderMap::run(const gu::Config&  conf,
                                       const std::string& peer,
                                       wsrep_seqno_t      first,
@@ -13,14 +13,15 @@
 #include "gu_lock.hpp"
 #include "gu_monitor.hpp"
 #include "gu_asio.hpp"
+#include "gu_datetime.hpp"
 
+#include "GCache.hpp"
+
+#include <deque>
+#include <map>
 #include <stack>
 #include <set>
-
-namespace gcache
-{
-    class GCache;
-}
+#include <vector>
 
 namespace galera
 {
@@ -30,23 +31,37 @@ namespace galera
     {
         void register_params(gu::Config& conf);
 
+        class Proto;
+
         class Receiver
         {
         public:
             static std::string const RECV_ADDR;
             static std::string const RECV_BIND;
+            static std::string const STRIPES;
+            static std::string const RESUME_TIMEOUT;
 
             Receiver(gu::Config& conf, TrxHandle::SlavePool&, const char* addr);
             ~Receiver();
 
             std::string   prepare(wsrep_seqno_t, wsrep_seqno_t, int);
-            void          ready();
+            /*! @param stripes number of senders to expect */
+            void          ready(int stripes = 1);
+            /*! @throws gu::Exception with ECONNABORTED if a sender
+             *          connection was lost and not resumed in time,
+             *          all write sets before that have been delivered */
             int           recv(TrxHandle** trx);
             wsrep_seqno_t finished();
             void          run();
 
         private:
 
+            template <class S> void run_stripes();
+            template <class S> void accept_stripe(std::vector<S*>&, Proto&);
+            template <class S> bool resume_stripe(std::vector<S*>&, Proto&,
+                                                  int idx);
+
+            void listen(const std::string& bind);
             void interrupt();
 
             std::string                                   recv_addr_;
@@ -86,9 +101,11 @@ namespace galera
             gu_thread_t           thread_;
             int                   error_code_;
             int                   version_;
+            int                   stripes_;
             bool                  use_ssl_;
             bool                  running_;
             bool                  ready_;
+            bool                  interrupted_;
 
             // GCC 4.8.5 on FreeBSD wants this
             Receiver(const Receiver&);
@@ -99,51 +116,147 @@ namespace galera
         {
         public:
 
+            static std::string const SEND_RATE;
+            static std::string const READAHEAD;
+            static std::string const ADAPTIVE;
+
             Sender(const gu::Config& conf,
                    gcache::GCache& gcache,
                    const std::string& peer,
                    int version);
             virtual ~Sender();
 
+            /*! sends first..last, if connection breaks, reconnects and
+             *  resumes from where receiver asks for ist.resume_timeout */
             void send(wsrep_seqno_t first, wsrep_seqno_t last);
 
-            void cancel()
+            void cancel();
+
+            const std::string& peer() const { return peer_; }
+
+            bool cancelled() const { return cancelled_; }
+
+            /*! @return true if donor's own replication falls behind and
+             *          sending should yield to it (ist.adaptive) */
+            virtual bool donor_busy() const { return false; }
+
+            /*! reads buffers starting from first, @return number of buffers
+             *  read, see GCache::seqno_get_buffers() */
+            virtual ssize_t get_buffers(
+                std::vector<gcache::GCache::Buffer>& bufs,
+                wsrep_seqno_t                        first)
             {
-                if (use_ssl_ == true)
-                {
-                    ssl_stream_->lowest_layer().close();
-                }
-                else
-                {
-                    socket_.close();
-                }
+                return gcache_.seqno_get_buffers(bufs, first);
             }
 
+            /*! @return true if buffers just sent may be still needed by
+             *          other senders */
+            virtual bool buffers_shared() const { return false; }
+
+        protected:
+
+            // whether destructor should release gcache seqno lock
+            bool release_lock_;
+
         private:
 
+            void connect();
+            void close();
+            bool reconnect(const gu::datetime::Date& deadline);
+
             asio::io_service                          io_service_;
             asio::ip::tcp::socket                     socket_;
             asio::ssl::context                        ssl_ctx_;
             asio::ssl::stream<asio::ip::tcp::socket>* ssl_stream_;
+            gu::Mutex                                 stream_mtx_;
             const gu::Config&                         conf_;
             gcache::GCache&                           gcache_;
+            const std::string                         peer_;
             int                                       version_;
             bool                                      use_ssl_;
+            bool volatile                             cancelled_;
 
             Sender(const Sender&);
             void operator=(const Sender&);
         };
 
 
+        /*! Recently read gcache batches shared by async senders, so that
+         *  concurrent IST requests with overlapping ranges read each buffer
+         *  from gcache once. Also keeps gcache seqno lock at the position
+         *  of the slowest sender, not the one which read last. */
+        class SharedCursor
+        {
+        public:
+
+            SharedCursor(gcache::GCache& gcache)
+                :
+                gcache_ (gcache),
+                mtx_    (),
+                window_ (),
+                readers_(),
+                hits_   (0),
+                misses_ (0)
+            { }
+
+            /*! registers reader positioned at seqno
+             *  @throws gu::NotFound if seqno is not in gcache */
+            void attach(const void* reader, wsrep_seqno_t seqno);
+
+            /*! unregisters reader, releases gcache lock after the last */
+            void detach(const void* reader);
+
+            /*! fills bufs with buffers starting from first, from a shared
+             *  batch if there is one, from gcache otherwise
+             *  @return number of buffers */
+            ssize_t get(const void*                          reader,
+                        std::vector<gcache::GCache::Buffer>& bufs,
+                        wsrep_seqno_t                        first);
+
+            /*! @return true if more than one reader is attached */
+            bool shared() const;
+
+        private:
+
+            struct Batch
+            {
+                Batch(wsrep_seqno_t const                        first,
+                      const std::vector<gcache::GCache::Buffer>& bufs,
+                      size_t const                               n)
+                    :
+                    first_(first), bufs_(bufs.begin(), bufs.begin() + n)
+                { }
+
+                wsrep_seqno_t                       first_;
+                std::vector<gcache::GCache::Buffer> bufs_;
+            };
+
+            wsrep_seqno_t min_position() const;
+            void relock();
+
+            gcache::GCache&                      gcache_;
+            mutable gu::Mutex                    mtx_;
+            std::deque<Batch>                    window_;
+            std::map<const void*, wsrep_seqno_t> readers_;
+            long long                            hits_;
+            long long                            misses_;
+
+            SharedCursor(const SharedCursor&);
+            SharedCursor& operator=(const SharedCursor&);
+        };
+
+
         class AsyncSender;
         class AsyncSenderMap
         {
         public:
-            AsyncSenderMap(GCS_IMPL& gcs, gcache::GCache& gcache)
+            AsyncSenderMap(GcsI& gcs, gcache::GCache& gcache)
                 :
                 senders_(),
                 monitor_(),
-                gcache_(gcache) { }
+                gcs_(gcs),
+                gcache_(gcache),
+                cursor_(gcache) { }
             void run(const gu::Config& conf,
                      const std::string& peer,
                      wsrep_seqno_t,
@@ -151,12 +264,16 @@ namespace galera
                      int);
             void remove(AsyncSender*, wsrep_seqno_t);
             void cancel();
+            GcsI&           gcs()    { return gcs_;    }
             gcache::GCache& gcache() { return gcache_; }
+            SharedCursor&   cursor() { return cursor_; }
         private:
             std::set<AsyncSender*> senders_;
             // use monitor instead of mutex, it provides cancellation point
             gu::Monitor            monitor_;
+            GcsI&                  gcs_;
             gcache::GCache&        gcache_;
+            SharedCursor           cursor_;
         };
 
 
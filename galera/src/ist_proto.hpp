@@ -1,5 +1,5 @@
 //
-// Copyright (C) 2011-2014 Codership Oy <info@codership.com>
+// Copyright (C) 2011-2017 Codership Oy <info@codership.com>
 //
 
 #ifndef GALERA_IST_PROTO_HPP
@@ -13,6 +13,10 @@
 #include "gu_serialize.hpp"
 #include "gu_vector.hpp"
 
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
 //
 // Message class must have non-virtual destructor until
 // support up to version 3 is removed as serialization/deserialization
@@ -36,6 +40,29 @@
 // send_ctrl(EOF)            ----->
 //                          <-----   close()
 // close()
+//
+// With striped IST several senders connect to the same receiver. Receiver
+// assigns stripes in the len field of OK control message (see Stripe below)
+// and each sender sends only the seqno blocks of its own stripe, followed
+// by EOF. Senders that don't know about stripes ignore the field, receivers
+// that don't know about stripes send zero which means the whole range.
+//
+// If a connection breaks in the middle of the transfer, sender reconnects
+// and receiver puts the seqno it needs next in the len field of handshake.
+// Sender then resumes from there instead of the beginning of the range.
+// Zero means no resume, so older peers don't notice the difference.
+//
+// Starting from version 8 (BATCH_VERSION) sender packs consecutive write
+// sets into T_BATCH messages:
+//
+//   header (12 bytes, len = size of the rest)
+//   first seqno_g (8 bytes), count (4 bytes)
+//   count x { seqno_d (8 bytes), payload size (4 bytes) }
+//   count payloads back to back
+//
+// and receiver reads the stream in large chunks into a reusable buffer
+// instead of doing several reads per write set. T_TRX messages are still
+// valid in version 8, they are used when keys are stripped.
 
 //
 // Note about protocol/message versioning:
@@ -58,7 +85,8 @@ namespace galera
                 T_HANDSHAKE = 1,
                 T_HANDSHAKE_RESPONSE = 2,
                 T_CTRL = 3,
-                T_TRX = 4
+                T_TRX = 4,
+                T_BATCH = 5
             } Type;
 
             Message(int       version = -1,
@@ -194,9 +222,9 @@ namespace galera
         class Handshake : public Message
         {
         public:
-            Handshake(int version = -1)
+            Handshake(int version = -1, uint64_t resume = 0)
                 :
-                Message(version, Message::T_HANDSHAKE, 0, 0, 0)
+                Message(version, Message::T_HANDSHAKE, 0, 0, resume)
             { }
         };
 
@@ -218,12 +246,56 @@ namespace galera
                 C_OK = 0,
                 C_EOF = 1
             };
-            Ctrl(int version = -1, int8_t code = 0)
+            Ctrl(int version = -1, int8_t code = 0, uint64_t len = 0)
                 :
-                Message(version, Message::T_CTRL, 0, code, 0)
+                Message(version, Message::T_CTRL, 0, code, len)
             { }
         };
 
+        //
+        // Stripe assignment: seqno range is split into blocks of block()
+        // seqnos, block i belongs to stripe i % num(). Packed into 64 bits
+        // as index (8 bits), number of stripes (8 bits), block length.
+        //
+        class Stripe
+        {
+        public:
+            Stripe(int idx, int num, uint32_t block)
+                :
+                idx_(idx), num_(num), block_(block)
+            { }
+
+            explicit Stripe(uint64_t packed)
+                :
+                idx_  (packed & 0xff),
+                num_  ((packed >> 8) & 0xff),
+                block_(packed >> 16)
+            {
+                if (num_ == 0) { idx_ = 0; num_ = 1; }
+            }
+
+            uint64_t packed() const
+            {
+                return (num_ > 1 ?
+                        (uint64_t(block_) << 16) | (num_ << 8) | idx_ : 0);
+            }
+
+            int      idx()   const { return idx_;   }
+            int      num()   const { return num_;   }
+            uint32_t block() const { return block_; }
+
+            /*! @return stripe which carries seqno, given first seqno */
+            int of(wsrep_seqno_t first, wsrep_seqno_t seqno) const
+            {
+                return (num_ > 1 ? ((seqno - first) / block_) % num_ : 0);
+            }
+
+        private:
+            int      idx_;
+            int      num_;
+            uint32_t block_;
+        };
+
         class Trx : public Message
         {
         public:
@@ -234,19 +306,52 @@ namespace galera
         };
 
 
+        class Batch : public Message
+        {
+        public:
+            Batch(int version = -1, uint64_t len = 0)
+                :
+                Message(version, Message::T_BATCH, 0, 0, len)
+            { }
+        };
+
+
         class Proto
         {
         public:
 
+            static int    const BATCH_VERSION   = 8;
+            // soft limit of batch payload, a batch has at least one write set
+            static size_t const BATCH_MAX_BYTES = 1 << 20;
+            // receive buffer size, larger payloads are read directly
+            static size_t const RECV_BUF_SIZE   = 1 << 20;
+
             Proto(TrxHandle::SlavePool& sp, int version, bool keep_keys)
                 :
                 trx_pool_ (sp),
                 raw_sent_ (0),
                 real_sent_(0),
                 version_  (version),
-                keep_keys_(keep_keys)
+                keep_keys_(keep_keys),
+                rbuf_     (),
+                rbegin_   (0),
+                rend_     (0),
+                batch_    (),
+                batch_pos_(0),
+                batch_seqno_(0)
             { }
 
+            int version() const { return version_; }
+
+            /*! drops buffered input and batch state, to be called when
+             *  the connection is replaced */
+            void reset_recv()
+            {
+                rbegin_ = rend_ = 0;
+                batch_.clear();
+                batch_pos_ = 0;
+            }
+
             ~Proto()
             {
                 if (raw_sent_ > 0)
@@ -262,9 +367,9 @@ namespace galera
             }
 
             template <class ST>
-            void send_handshake(ST& socket)
+            void send_handshake(ST& socket, wsrep_seqno_t resume = 0)
             {
-                Handshake  hs(version_);
+                Handshake  hs(version_, resume);
                 gu::Buffer buf(hs.serial_size());
                 size_t offset(hs.serialize(&buf[0], buf.size(), 0));
                 size_t n(asio::write(socket, asio::buffer(&buf[0],
@@ -276,7 +381,7 @@ namespace galera
             }
 
             template <class ST>
-            void recv_handshake(ST& socket)
+            void recv_handshake(ST& socket, wsrep_seqno_t* resume = 0)
             {
                 Message    msg(version_);
                 gu::Buffer buf(msg.serial_size());
@@ -317,6 +422,7 @@ namespace galera
                                            << " required: "
                                            << version_;
                 }
+                if (resume) *resume = msg.len();
                 // TODO: Figure out protocol versions to use
             }
 
@@ -372,9 +478,9 @@ namespace galera
             }
 
             template <class ST>
-            void send_ctrl(ST& socket, int8_t code)
+            void send_ctrl(ST& socket, int8_t code, uint64_t len = 0)
             {
-                Ctrl       ctrl(version_, code);
+                Ctrl       ctrl(version_, code, len);
                 gu::Buffer buf(ctrl.serial_size());
                 size_t offset(ctrl.serialize(&buf[0], buf.size(), 0));
                 size_t n(asio::write(socket, asio::buffer(&buf[0],buf.size())));
@@ -385,7 +491,7 @@ namespace galera
             }
 
             template <class ST>
-            int8_t recv_ctrl(ST& socket)
+            int8_t recv_ctrl(ST& socket, uint64_t* len = 0)
             {
                 Message    msg(version_);
                 gu::Buffer buf(msg.serial_size());
@@ -409,6 +515,7 @@ namespace galera
                     gu_throw_error(EPROTO) << "unexpected message type: "
                                            << msg.type();
                 }
+                if (len) *len = msg.len();
                 return msg.ctrl();
             }
 
@@ -479,23 +586,100 @@ namespace galera
             }
 
 
+            /*! sends n buffers of consecutive seqnos */
+            template <class ST>
+            void send_batch(ST&                                        socket,
+                            const std::vector<gcache::GCache::Buffer>& bufs,
+                            size_t const                               n)
+            {
+                // stripping keys needs a WriteSetIn per write set to stay
+                // alive until it is sent, don't bother batching then
+                if (version_ < BATCH_VERSION || !keep_keys_)
+                {
+                    for (size_t i(0); i < n; ++i) send_trx(socket, bufs[i]);
+                    return;
+                }
+
+                size_t const entry_size(8 + 4);
+                std::vector<asio::const_buffer> cbs;
+                gu::Buffer hdr;
+
+                for (size_t i(0); i < n; )
+                {
+                    size_t count(0);
+                    size_t payload(0);
+
+                    while (i + count < n && (0 == count ||
+                           (payload < BATCH_MAX_BYTES &&
+                            bufs[i + count].seqno_g() ==
+                            bufs[i].seqno_g() + wsrep_seqno_t(count))))
+                    {
+                        if (bufs[i + count].seqno_d() != -1)
+                            payload += bufs[i + count].size();
+                        ++count;
+                    }
+
+                    size_t const index_size(8 + 4 + count * entry_size);
+                    Batch const batch(version_, index_size + payload);
+
+                    hdr.resize(batch.serial_size() + index_size);
+                    size_t offset(batch.serialize(&hdr[0], hdr.size(), 0));
+                    offset = gu::serialize8(bufs[i].seqno_g(),
+                                            &hdr[0], hdr.size(), offset);
+                    offset = gu::serialize4(uint32_t(count),
+                                            &hdr[0], hdr.size(), offset);
+
+                    cbs.clear();
+                    cbs.push_back(asio::const_buffer(&hdr[0], hdr.size()));
+
+                    for (size_t k(i); k < i + count; ++k)
+                    {
+                        const gcache::GCache::Buffer& b(bufs[k]);
+                        uint32_t const size(b.seqno_d() == -1 ? 0 : b.size());
+
+                        offset = gu::serialize8(b.seqno_d(),
+                                                &hdr[0], hdr.size(), offset);
+                        offset = gu::serialize4(size,
+                                                &hdr[0], hdr.size(), offset);
+
+                        if (size > 0)
+                            cbs.push_back(asio::const_buffer(b.ptr(), size));
+                    }
+
+                    assert(offset == hdr.size());
+
+                    size_t const sent(asio::write(socket, cbs));
+
+                    log_debug << "sent batch of " << count << ": " << sent
+                              << " bytes";
+
+                    i += count;
+                }
+            }
+
+
             template <class ST>
             galera::TrxHandle*
             recv_trx(ST& socket)
             {
+                if (batch_pos_ < batch_.size())
+                {
+                    const BatchEntry& e(batch_[batch_pos_]);
+                    ++batch_pos_;
+                    return recv_ws(socket, batch_seqno_++, e.seqno_d_,
+                                   e.size_);
+                }
+
                 Message    msg(version_);
                 gu::Buffer buf(msg.serial_size());
-                size_t n(asio::read(socket, asio::buffer(&buf[0], buf.size())));
 
-                if (n != buf.size())
-                {
-                    gu_throw_error(EPROTO) << "error receiving trx header";
-                }
+                read(socket, &buf[0], buf.size());
 
                 (void)msg.unserialize(&buf[0], buf.size(), 0);
 
-                log_debug << "received header: " << n << " bytes, type "
-                          << msg.type() << " len " << msg.len();
+                log_debug << "received header: " << buf.size()
+                          << " bytes, type " << msg.type()
+                          << " len " << msg.len();
 
                 switch (msg.type())
                 {
@@ -509,62 +693,74 @@ namespace galera
 
                     buf.resize(sizeof(seqno_g) + sizeof(seqno_d));
 
-                    n = asio::read(socket, asio::buffer(&buf[0], buf.size()));
-                    if (n != buf.size())
-                    {
-                        gu_throw_error(EPROTO) << "error reading trx meta data";
-                    }
+                    read(socket, &buf[0], buf.size());
 
                     size_t offset(gu::unserialize8(&buf[0], buf.size(), 0,
                                                    seqno_g));
                     offset = gu::unserialize8(&buf[0], buf.size(), offset,
                                               seqno_d);
 
-                    galera::TrxHandle* trx(galera::TrxHandle::New(trx_pool_));
-
-                    if (seqno_d == WSREP_SEQNO_UNDEFINED)
+                    if (seqno_d == WSREP_SEQNO_UNDEFINED &&
+                        offset != msg.len())
                     {
-                        if (offset != msg.len())
-                        {
-                            gu_throw_error(EINVAL)
-                                << "message size " << msg.len()
-                                << " does not match expected size " << offset;
-                        }
+                        gu_throw_error(EINVAL)
+                            << "message size " << msg.len()
+                            << " does not match expected size " << offset;
                     }
-                    else
-                    {
-                        MappedBuffer& wbuf(trx->write_set_collection());
-                        size_t const wsize(msg.len() - offset);
-                        wbuf.resize(wsize);
 
-                        n = asio::read(socket,
-                                       asio::buffer(&wbuf[0], wbuf.size()));
+                    return recv_ws(socket, seqno_g, seqno_d,
+                                   msg.len() - offset);
+                }
+                case Message::T_BATCH:
+                {
+                    uint32_t count;
+
+                    buf.resize(8 + 4);
+                    read(socket, &buf[0], buf.size());
 
-                        if (gu_unlikely(n != wbuf.size()))
-                        {
-                            gu_throw_error(EPROTO)
-                                << "error reading write set data";
-                        }
+                    size_t offset(gu::unserialize8(&buf[0], buf.size(), 0,
+                                                   batch_seqno_));
+                    offset = gu::unserialize4(&buf[0], buf.size(), offset,
+                                              count);
 
-                        trx->unserialize(&wbuf[0], wbuf.size(), 0);
+                    if (0 == count)
+                    {
+                        gu_throw_error(EPROTO) << "empty IST batch";
                     }
 
-                    if (seqno_d == WSREP_SEQNO_UNDEFINED ||
-                        trx->version() < 3)
+                    // don't let a corrupt count size the index buffer
+                    if (12 + uint64_t(count) * (8 + 4) > msg.len())
                     {
-                        trx->set_received(0, -1, seqno_g);
-                        trx->set_depends_seqno(seqno_d);
+                        gu_throw_error(EPROTO)
+                            << "IST batch of " << count << " write sets "
+                            << "does not fit in message of " << msg.len();
                     }
-                    else
+
+                    buf.resize(count * (8 + 4));
+                    read(socket, &buf[0], buf.size());
+
+                    batch_.resize(count);
+                    uint64_t total(12 + buf.size());
+
+                    offset = 0;
+                    for (uint32_t i(0); i < count; ++i)
                     {
-                        trx->set_received_from_ws();
-                        assert(trx->global_seqno() == seqno_g);
-                        assert(trx->depends_seqno() >= seqno_d);
+                        offset = gu::unserialize8(&buf[0], buf.size(), offset,
+                                                  batch_[i].seqno_d_);
+                        offset = gu::unserialize4(&buf[0], buf.size(), offset,
+                                                  batch_[i].size_);
+                        total += batch_[i].size_;
                     }
-                    trx->mark_certified();
 
-                    log_debug << "received trx body: " << *trx;
-                    return trx;
+                    if (total != msg.len())
+                    {
+                        gu_throw_error(EPROTO)
+                            << "batch size " << msg.len()
+                            << " does not match index size " << total;
+                    }
+
+                    batch_pos_ = 0;
+                    return recv_trx(socket);
                 }
                 case Message::T_CTRL:
                     switch (msg.ctrl())
@@ -593,12 +789,124 @@ namespace galera
 
         private:
 
+            struct BatchEntry
+            {
+                wsrep_seqno_t seqno_d_;
+                uint32_t      size_;
+            };
+
+            /* reads write set payload of size bytes and makes a trx of it */
+            template <class ST>
+            galera::TrxHandle* recv_ws(ST&                 socket,
+                                       wsrep_seqno_t const seqno_g,
+                                       wsrep_seqno_t const seqno_d,
+                                       size_t const        size)
+            {
+                galera::TrxHandle* trx(galera::TrxHandle::New(trx_pool_));
+
+                if (seqno_d != WSREP_SEQNO_UNDEFINED)
+                {
+                    MappedBuffer& wbuf(trx->write_set_collection());
+                    wbuf.resize(size);
+
+                    try
+                    {
+                        read(socket, &wbuf[0], wbuf.size());
+                    }
+                    catch (...)
+                    {
+                        trx->unref();
+                        throw;
+                    }
+
+                    trx->unserialize(&wbuf[0], wbuf.size(), 0);
+                }
+
+                if (seqno_d == WSREP_SEQNO_UNDEFINED ||
+                    trx->version() < 3)
+                {
+                    trx->set_received(0, -1, seqno_g);
+                    trx->set_depends_seqno(seqno_d);
+                }
+                else
+                {
+                    trx->set_received_from_ws();
+                    assert(trx->global_seqno() == seqno_g);
+                    assert(trx->depends_seqno() >= seqno_d);
+                }
+                trx->mark_certified();
+
+                log_debug << "received trx body: " << *trx;
+                return trx;
+            }
+
+            /* Before BATCH_VERSION reads straight from socket. Since then
+             * reads what socket has available, up to RECV_BUF_SIZE, and
+             * serves small reads from the buffer. */
+            template <class ST>
+            void read(ST& socket, void* const ptr, size_t const len)
+            {
+                if (version_ < BATCH_VERSION)
+                {
+                    size_t const n(asio::read(socket, asio::buffer(ptr, len)));
+
+                    if (gu_unlikely(n != len))
+                    {
+                        gu_throw_error(EPROTO) << "short read: " << n
+                                               << " of " << len << " bytes";
+                    }
+                    return;
+                }
+
+                gu::byte_t* dst(static_cast<gu::byte_t*>(ptr));
+                size_t      left(len);
+                size_t const have(std::min(rend_ - rbegin_, left));
+
+                if (have > 0)
+                {
+                    ::memcpy(dst, &rbuf_[0] + rbegin_, have);
+                    rbegin_ += have;
+                    dst     += have;
+                    left    -= have;
+
+                    if (0 == left) return;
+                }
+
+                assert(rbegin_ == rend_);
+                rbegin_ = rend_ = 0;
+
+                if (left >= RECV_BUF_SIZE / 2)
+                {
+                    // no point in copying it twice
+                    asio::read(socket, asio::buffer(dst, left));
+                    return;
+                }
+
+                if (rbuf_.size() < RECV_BUF_SIZE) rbuf_.resize(RECV_BUF_SIZE);
+
+                while (rend_ < left)
+                {
+                    rend_ += socket.read_some(
+                        asio::buffer(&rbuf_[0] + rend_, rbuf_.size() - rend_));
+                }
+
+                ::memcpy(dst, &rbuf_[0], left);
+                rbegin_ = left;
+            }
+
             TrxHandle::SlavePool& trx_pool_;
 
             uint64_t raw_sent_;
             uint64_t real_sent_;
             int      version_;
             bool     keep_keys_;
+
+            gu::Buffer              rbuf_;
+            size_t                  rbegin_;
+            size_t                  rend_;
+            std::vector<BatchEntry> batch_;
+            size_t                  batch_pos_;
+            wsrep_seqno_t           batch_seqno_;
         };
     }
 }
@@ -8,6 +8,7 @@
 #include "trx_handle.hpp"
 #include <gu_lock.hpp> // for gu::Mutex and gu::Cond
 #include <gu_limits.h>
+#include <gu_event_trace.hpp>
 
 #include <vector>
 
@@ -46,9 +47,10 @@ namespace galera
 
     public:
 
-        Monitor()
+        /*! @param name lock site name for contention profiling */
+        explicit Monitor(const char* const name = NULL)
             :
-            mutex_(),
+            mutex_(name),
             cond_(),
             last_entered_(-1),
             last_left_(-1),
@@ -99,6 +101,7 @@ namespace galera
 
         void enter(C& obj)
         {
+            const long long     start(gu::EventTrace::start());
             const wsrep_seqno_t obj_seqno(obj.seqno());
             const size_t        idx(indexof(obj_seqno));
             gu::Lock            lock(mutex_);
@@ -135,6 +138,10 @@ namespace galera
                     ++entered_;
                     oooe_     += ((last_left_ + 1) < obj_seqno);
                     win_size_ += (last_entered_ - last_left_);
+
+                    gu::EventTrace::record(gu::EventTrace::EV_MONITOR_ENTER,
+                                           obj_seqno, trace_id(), start);
+                    C::probe_entered(obj_seqno);
                     return;
                 }
             }
@@ -147,17 +154,25 @@ namespace galera
 
         void leave(const C& obj)
         {
+            const long long start(gu::EventTrace::start());
+            {
 #ifndef NDEBUG
-            size_t   idx(indexof(obj.seqno()));
+                size_t   idx(indexof(obj.seqno()));
 #endif /* NDEBUG */
-            gu::Lock lock(mutex_);
+                gu::Lock lock(mutex_);
 
-            assert(process_[idx].state_ == Process::S_APPLYING ||
-                   process_[idx].state_ == Process::S_CANCELED);
+                assert(process_[idx].state_ == Process::S_APPLYING ||
+                       process_[idx].state_ == Process::S_CANCELED);
+
+                assert(process_[indexof(last_left_)].state_ ==
+                       Process::S_IDLE);
 
-            assert(process_[indexof(last_left_)].state_ == Process::S_IDLE);
+                post_leave(obj, lock);
+            }
 
-            post_leave(obj, lock);
+            gu::EventTrace::record(gu::EventTrace::EV_MONITOR_LEAVE,
+                                   obj.seqno(), trace_id(), start);
+            C::probe_left(obj.seqno());
         }
 
         void self_cancel(C& obj)
@@ -308,6 +323,12 @@ namespace galera
             return (seqno & process_mask_);
         }
 
+        // identifies monitor instance in event trace
+        int64_t trace_id() const
+        {
+            return reinterpret_cast<intptr_t>(this);
+        }
+
         bool may_enter(const C& obj) const
         {
             return obj.condition(last_entered_, last_left_);
@@ -8,6 +8,9 @@ namespace galera
 {
 
 std::string const Replicator::Param::debug_log = "debug";
+std::string const Replicator::Param::trace = "debug.trace";
+std::string const Replicator::Param::trace_dump = "debug.trace_dump";
+std::string const Replicator::Param::latency = "debug.latency";
 #ifdef GU_DBUG_ON
 std::string const Replicator::Param::dbug = "dbug";
 std::string const Replicator::Param::signal = "signal";
@@ -16,6 +19,9 @@ std::string const Replicator::Param::signal = "signal";
 void Replicator::register_params(gu::Config& conf)
 {
     conf.add(Param::debug_log, "no");
+    conf.add(Param::trace, "no");
+    conf.add(Param::trace_dump, "");
+    conf.add(Param::latency, "no");
 #ifdef GU_DBUG_ON
     conf.add(Param::dbug, "");
     conf.add(Param::signal, "");
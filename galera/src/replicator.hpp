@@ -28,6 +28,9 @@ namespace galera
         struct Param
         {
             static std::string const debug_log;
+            static std::string const trace;
+            static std::string const trace_dump;
+            static std::string const latency;
 #ifdef GU_DBUG_ON
             static std::string const dbug;
             static std::string const signal;
@@ -108,6 +111,8 @@ namespace galera
                                        size_t req_size,
                                        wsrep_seqno_t seqno_l,
                                        wsrep_seqno_t donor_seq) = 0;
+        virtual void process_ist_stripe_req(const void* req, size_t req_size,
+                                            wsrep_seqno_t seqno_l) = 0;
         virtual void process_join(wsrep_seqno_t seqno, wsrep_seqno_t seqno_l) = 0;
         virtual void process_sync(wsrep_seqno_t seqno_l) = 0;
 
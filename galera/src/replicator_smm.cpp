@@ -11,6 +11,8 @@
 
 #include <gu_debug_sync.hpp>
 #include <gu_abort.h>
+#include <gu_time.h>
+#include <gu_thread.hpp>
 
 #include <sstream>
 #include <iostream>
@@ -153,7 +155,9 @@ galera::ReplicatorSMM::ReplicatorSMM(const struct wsrep_init_args* args)
     sst_seqno_          (WSREP_SEQNO_UNDEFINED),
     sst_mutex_          (),
     sst_cond_           (),
+    ist_fail_mutex_     (),
     sst_retry_sec_      (1),
+    connect_ts_         (0),
     gcache_             (config_, config_.get(BASE_DIR)),
     gcs_                (config_, gcache_, proto_max_, args->proto_ver,
                          args->node_name, args->node_incoming),
@@ -165,10 +169,13 @@ galera::ReplicatorSMM::ReplicatorSMM(const struct wsrep_init_args* args)
     ist_senders_        (gcs_, gcache_),
     wsdb_               (),
     cert_               (config_, service_thd_),
-    local_monitor_      (),
-    apply_monitor_      (),
-    commit_monitor_     (),
+    local_monitor_      ("local_monitor"),
+    apply_monitor_      ("apply_monitor"),
+    commit_monitor_     ("commit_monitor"),
     causal_read_timeout_(config_.get(Param::causal_read_timeout)),
+    causal_read_lease_  (config_.get(Param::causal_read_lease)),
+    async_commit_       (*this),
+    stats_snapshot_     (*this),
     receivers_          (),
     replicated_         (),
     replicated_bytes_   (),
@@ -182,6 +189,11 @@ galera::ReplicatorSMM::ReplicatorSMM(const struct wsrep_init_args* args)
     local_replays_      (),
     causal_reads_       (),
     preordered_id_      (),
+    lat_local_monitor_  (),
+    lat_cert_           (),
+    lat_apply_monitor_  (),
+    lat_commit_monitor_ (),
+    lat_commit_cb_      (),
     incoming_list_      (""),
     incoming_mutex_     (),
     wsrep_stats_        ()
@@ -253,11 +265,24 @@ galera::ReplicatorSMM::ReplicatorSMM(const struct wsrep_init_args* args)
     cert_.assign_initial_position(seqno, trx_proto_ver());
 
     build_stats_vars(wsrep_stats_);
+
+    async_commit_.start(config_.get<int>(Param::async_commit_threads));
+
+    stats_snapshot_.set_interval(
+        gu::datetime::Period(config_.get(Param::stats_interval)));
+
+    gu_lock_prof_set_rate(config_.get<int>(Param::lock_profile));
+
+    gu::thread_configure(config_);
 }
 
 galera::ReplicatorSMM::~ReplicatorSMM()
 {
     log_info << "dtor state: " << state_();
+
+    // refresh thread reads all of the members
+    stats_snapshot_.stop();
+
     switch (state_())
     {
     case S_CONNECTED:
@@ -274,6 +299,10 @@ galera::ReplicatorSMM::~ReplicatorSMM()
     case S_DESTROYED:
         break;
     }
+
+    // must be stopped before this object is destroyed since pending jobs
+    // are cancelled through virtual calls
+    async_commit_.stop();
 }
 
 
@@ -285,6 +314,8 @@ wsrep_status_t galera::ReplicatorSMM::connect(const std::string& cluster_name,
     sst_donor_ = state_donor;
     service_thd_.reset();
 
+    connect_ts_ = gu_time_monotonic();
+
     ssize_t err;
     wsrep_status_t ret(WSREP_OK);
     wsrep_seqno_t const seqno(STATE_SEQNO());
@@ -320,6 +351,9 @@ wsrep_status_t galera::ReplicatorSMM::connect(const std::string& cluster_name,
     if (ret == WSREP_OK)
     {
         state_.shift_to(S_CONNECTED);
+
+        log_info << "Startup: gcs connect took "
+                 << (gu_time_monotonic() - connect_ts_)/1000000 << " ms";
     }
 
     return ret;
@@ -429,28 +463,41 @@ void galera::ReplicatorSMM::apply_trx(void* recv_ctx, TrxHandle* trx)
     ApplyOrder ao(*trx);
     CommitOrder co(*trx, co_mode_);
 
+    long long const am_start(gu::LatencyHistogram::start());
     gu_trace(apply_monitor_.enter(ao));
+    lat_apply_monitor_.record_since(am_start);
     trx->set_state(TrxHandle::S_APPLYING);
 
     wsrep_trx_meta_t meta = {{state_uuid_, trx->global_seqno() },
                              trx->depends_seqno()};
 
+    // see to_isolation_begin()
+    bool const keyed_toi(cert_.keyed_toi(trx));
+
     if (trx->is_toi())
     {
         log_debug << "Executing TO isolated action: " << *trx;
         st_.mark_unsafe();
+
+        if (keyed_toi && co_mode_ != CommitOrder::BYPASS)
+        {
+            commit_monitor_.self_cancel(co);
+        }
     }
 
     gu_trace(apply_trx_ws(recv_ctx, apply_cb_, commit_cb_, *trx, meta));
     /* at this point any exception in apply_trx_ws() is fatal, not
      * catching anything. */
 
-    if (gu_likely(co_mode_ != CommitOrder::BYPASS))
+    if (gu_likely(co_mode_ != CommitOrder::BYPASS && !keyed_toi))
     {
+        long long const cm_start(gu::LatencyHistogram::start());
         gu_trace(commit_monitor_.enter(co));
+        lat_commit_monitor_.record_since(cm_start);
     }
     trx->set_state(TrxHandle::S_COMMITTING);
 
+    long long const cb_start(gu::LatencyHistogram::start());
     wsrep_bool_t exit_loop(false);
     wsrep_cb_status_t const rcode(
         commit_cb_(
@@ -459,11 +506,12 @@ void galera::ReplicatorSMM::apply_trx(void* recv_ctx, TrxHandle* trx)
             &meta,
             &exit_loop,
             true));
+    lat_commit_cb_.record_since(cb_start);
 
     if (gu_unlikely (rcode != WSREP_CB_SUCCESS))
         gu_throw_fatal << "Commit failed. Trx: " << trx;
 
-    if (gu_likely(co_mode_ != CommitOrder::BYPASS))
+    if (gu_likely(co_mode_ != CommitOrder::BYPASS && !keyed_toi))
     {
         commit_monitor_.leave(co);
     }
@@ -617,6 +665,8 @@ wsrep_status_t galera::ReplicatorSMM::replicate(TrxHandle* trx,
     replicated_bytes_ += rcode;
     trx->set_gcs_handle(-1);
 
+    GU_PROBE3(galera, trx_replicated, trx->trx_id(), act.seqno_g, rcode);
+
     if (trx->new_version())
     {
         gu_trace(trx->unserialize(static_cast<const gu::byte_t*>(act.buf),
@@ -768,6 +818,7 @@ wsrep_status_t galera::ReplicatorSMM::pre_commit(TrxHandle*        trx,
     ApplyOrder ao(*trx);
     CommitOrder co(*trx, co_mode_);
     bool interrupted(false);
+    long long const am_start(gu::LatencyHistogram::start());
 
     try
     {
@@ -779,6 +830,8 @@ wsrep_status_t galera::ReplicatorSMM::pre_commit(TrxHandle*        trx,
         else throw;
     }
 
+    lat_apply_monitor_.record_since(am_start);
+
     if (gu_unlikely(interrupted) || trx->state() == TrxHandle::S_MUST_ABORT)
     {
         assert(trx->state() == TrxHandle::S_MUST_ABORT);
@@ -791,6 +844,8 @@ wsrep_status_t galera::ReplicatorSMM::pre_commit(TrxHandle*        trx,
         trx->set_state(TrxHandle::S_COMMITTING);
         if (co_mode_ != CommitOrder::BYPASS)
         {
+            long long const cm_start(gu::LatencyHistogram::start());
+
             try
             {
                 gu_trace(commit_monitor_.enter(co));
@@ -801,6 +856,8 @@ wsrep_status_t galera::ReplicatorSMM::pre_commit(TrxHandle*        trx,
                 else throw;
             }
 
+            lat_commit_monitor_.record_since(cm_start);
+
             if (gu_unlikely(interrupted) ||
                 trx->state() == TrxHandle::S_MUST_ABORT)
             {
@@ -965,9 +1022,93 @@ wsrep_status_t galera::ReplicatorSMM::post_rollback(TrxHandle* trx)
 }
 
 
+wsrep_status_t
+galera::ReplicatorSMM::pre_commit_async(TrxHandle*              const trx,
+                                        wsrep_conn_id_t         const conn_id,
+                                        uint32_t                const flags,
+                                        wsrep_async_commit_cb_t const cb,
+                                        void*                   const ctx)
+{
+    if (!async_commit_.enabled()) return WSREP_NOT_IMPLEMENTED;
+
+    // ownership of trx reference passes to the job
+    AsyncCommit::Job const job = { trx, conn_id, flags, cb, ctx };
+
+    return (async_commit_.submit(job) ? WSREP_OK : WSREP_CONN_FAIL);
+}
+
+
+void galera::ReplicatorSMM::process_async_commit(const AsyncCommit::Job& job)
+{
+    TrxHandle* const trx(job.trx_);
+    wsrep_trx_meta_t meta;
+    meta.gtid       = WSREP_GTID_UNDEFINED;
+    meta.depends_on = WSREP_SEQNO_UNDEFINED;
+
+    wsrep_status_t retval;
+
+    try
+    {
+        TrxHandleLock lock(*trx);
+        trx->set_conn_id(job.conn_id_);
+        trx->set_flags(TrxHandle::wsrep_flags_to_trx_flags(job.flags_));
+
+        retval = replicate(trx, &meta);
+
+        if (retval == WSREP_OK)
+        {
+            retval = pre_commit(trx, &meta);
+        }
+    }
+    catch (gu::Exception& e)
+    {
+        log_error << e.what();
+
+        if (e.get_errno() == EMSGSIZE)
+            retval = WSREP_SIZE_EXCEEDED;
+        else
+            retval = WSREP_NODE_FAIL;
+    }
+    catch (std::exception& e)
+    {
+        log_error << e.what();
+        retval = WSREP_NODE_FAIL;
+    }
+    catch (...)
+    {
+        // callback must be called whatever happens
+        log_error << "Async commit failed: unknown exception";
+        retval = WSREP_NODE_FAIL;
+    }
+
+    // release the reference taken by wsrep_pre_commit_async() before
+    // the callback: the application may discard trx from it
+    unref_local_trx(trx);
+
+    job.cb_(job.ctx_, retval, &meta);
+}
+
+
+void galera::ReplicatorSMM::cancel_async_commit(const AsyncCommit::Job& job)
+{
+    wsrep_trx_meta_t meta;
+    meta.gtid       = WSREP_GTID_UNDEFINED;
+    meta.depends_on = WSREP_SEQNO_UNDEFINED;
+
+    unref_local_trx(job.trx_);
+
+    // trx was not replicated, application is expected to roll it back
+    job.cb_(job.ctx_, WSREP_TRX_FAIL, &meta);
+}
+
+
 wsrep_status_t galera::ReplicatorSMM::causal_read(wsrep_gtid_t* gtid)
 {
-    wsrep_seqno_t cseq(static_cast<wsrep_seqno_t>(gcs_.caused()));
+    // With non-zero causal read lease the seqno may be one learned by this
+    // node up to causal_read_lease_ ago, so the read is guaranteed to see
+    // all changes committed in the cluster before that moment.
+    wsrep_seqno_t cseq(static_cast<wsrep_seqno_t>(
+                           gcs_.caused(causal_read_lease_.get_nsecs())));
 
     if (cseq < 0)
     {
@@ -987,7 +1128,9 @@ wsrep_status_t galera::ReplicatorSMM::causal_read(wsrep_gtid_t* gtid)
         // finished.
         gu::datetime::Date wait_until(gu::datetime::Date::calendar()
                                       + causal_read_timeout_);
-        if (gu_likely(co_mode_ != CommitOrder::BYPASS))
+        // keyed TO isolated actions leave commit monitor before they
+        // are executed, only apply monitor covers them
+        if (gu_likely(co_mode_ != CommitOrder::BYPASS && !cert_.keyed_toi()))
         {
             commit_monitor_.wait(cseq, wait_until);
         }
@@ -1031,7 +1174,7 @@ wsrep_status_t galera::ReplicatorSMM::to_isolation_begin(TrxHandle*        trx,
     {
     case WSREP_OK:
     {
-        ApplyOrder ao(*trx);
+        ApplyOrder ao(*trx, cert_.keyed_toi(trx));
         CommitOrder co(*trx, co_mode_);
 
         gu_trace(apply_monitor_.enter(ao));
@@ -1039,7 +1182,13 @@ wsrep_status_t galera::ReplicatorSMM::to_isolation_begin(TrxHandle*        trx,
         if (co_mode_ != CommitOrder::BYPASS)
             try
             {
-                commit_monitor_.enter(co);
+                // keyed action gives up its commit order slot right away:
+                // dependent write sets wait for it in apply monitor, the
+                // rest may commit while it executes
+                if (cert_.keyed_toi(trx))
+                    commit_monitor_.self_cancel(co);
+                else
+                    commit_monitor_.enter(co);
             }
             catch (...)
             {
@@ -1075,7 +1224,8 @@ wsrep_status_t galera::ReplicatorSMM::to_isolation_end(TrxHandle* trx)
     log_debug << "Done executing TO isolated action: " << *trx;
 
     CommitOrder co(*trx, co_mode_);
-    if (co_mode_ != CommitOrder::BYPASS) commit_monitor_.leave(co);
+    if (co_mode_ != CommitOrder::BYPASS && !cert_.keyed_toi(trx))
+        commit_monitor_.leave(co);
     ApplyOrder ao(*trx);
     report_last_committed(cert_.set_trx_committed(trx));
     apply_monitor_.leave(ao);
@@ -1314,6 +1464,11 @@ void galera::ReplicatorSMM::establish_protocol_versions (int proto_ver)
         trx_params_.version_ = 3;
         str_proto_ver_ = 2;
         break;
+    case 8:
+        // IST batched message framing, no effect to TRX or STR protocols.
+        trx_params_.version_ = 3;
+        str_proto_ver_ = 2;
+        break;
     default:
         log_fatal << "Configuration change resulted in an unsupported protocol "
             "version: " << proto_ver << ". Can't continue.";
@@ -1434,6 +1589,13 @@ galera::ReplicatorSMM::process_conf_change(void*                    recv_ctx,
 
     if (view_info.view >= 0) // Primary configuration
     {
+        if (connect_ts_ > 0)
+        {
+            /* includes state exchange which waits for GCache recovery */
+            log_info << "Startup: primary component reached in "
+                     << (gu_time_monotonic() - connect_ts_)/1000000 << " ms";
+        }
+
         establish_protocol_versions (repl_proto);
 
         // we have to reset cert initial position here, SST does not contain
@@ -1459,6 +1621,13 @@ galera::ReplicatorSMM::process_conf_change(void*                    recv_ctx,
             request_state_transfer (recv_ctx,
                                     group_uuid, group_seqno, app_req,
                                     app_req_len);
+
+            if (connect_ts_ > 0)
+            {
+                log_info << "Startup: state transfer completed "
+                         << (gu_time_monotonic() - connect_ts_)/1000000
+                         << " ms after connect";
+            }
         }
         else
         {
@@ -1515,6 +1684,8 @@ galera::ReplicatorSMM::process_conf_change(void*                    recv_ctx,
                 log_error << "Failed to JOIN the cluster after SST";
             }
         }
+
+        connect_ts_ = 0; // startup phases done
     }
     else
     {
@@ -1706,6 +1877,7 @@ wsrep_status_t galera::ReplicatorSMM::cert(TrxHandle* trx)
     CommitOrder co(*trx, co_mode_);
 
     bool interrupted(false);
+    long long const lm_start(gu::LatencyHistogram::start());
 
     try
     {
@@ -1717,12 +1889,19 @@ wsrep_status_t galera::ReplicatorSMM::cert(TrxHandle* trx)
         else throw;
     }
 
+    lat_local_monitor_.record_since(lm_start);
+    long long const cert_start(gu::LatencyHistogram::start());
+
     wsrep_status_t retval(WSREP_OK);
     bool const applicable(trx->global_seqno() > STATE_SEQNO());
 
     if (gu_likely (!interrupted))
     {
-        switch (cert_.append_trx(trx))
+        Certification::TestResult const res(cert_.append_trx(trx));
+        lat_cert_.record_since(cert_start);
+        GU_PROBE2(galera, trx_certified, trx->global_seqno(), res);
+
+        switch (res)
         {
         case Certification::TEST_OK:
             if (gu_likely(applicable))
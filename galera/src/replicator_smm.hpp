@@ -25,15 +25,22 @@
 #include "gcs_action_source.hpp"
 #include "ist.hpp"
 #include "gu_atomic.hpp"
+#include "gu_latency_histogram.hpp"
+#include "gu_probe.h"
 #include "saved_state.hpp"
+#include "state_request.hpp"
 #include "gu_debug_sync.hpp"
+#include "async_commit.hpp"
+#include "stats_snapshot.hpp"
 
 
 #include <map>
 
 namespace galera
 {
-    class ReplicatorSMM : public Replicator
+    class ReplicatorSMM : public Replicator,
+                          public AsyncCommit::Handler,
+                          public StatsSnapshot::Source
     {
     public:
 
@@ -98,6 +105,13 @@ namespace galera
         wsrep_status_t replicate(TrxHandle* trx, wsrep_trx_meta_t*);
         void abort_trx(TrxHandle* trx) ;
         wsrep_status_t pre_commit(TrxHandle*  trx, wsrep_trx_meta_t*);
+        wsrep_status_t pre_commit_async(TrxHandle*              trx,
+                                        wsrep_conn_id_t         conn_id,
+                                        uint32_t                flags,
+                                        wsrep_async_commit_cb_t cb,
+                                        void*                   ctx);
+        void process_async_commit(const AsyncCommit::Job& job);
+        void cancel_async_commit(const AsyncCommit::Job& job);
         wsrep_status_t replay_trx(TrxHandle* trx, void* replay_ctx);
 
         wsrep_status_t post_commit(TrxHandle* trx);
@@ -131,12 +145,15 @@ namespace galera
         void process_state_req(void* recv_ctx, const void* req,
                                size_t req_size, wsrep_seqno_t seqno_l,
                                wsrep_seqno_t donor_seq);
+        void process_ist_stripe_req(const void* req, size_t req_size,
+                                    wsrep_seqno_t seqno_l);
         void process_join(wsrep_seqno_t seqno, wsrep_seqno_t seqno_l);
         void process_sync(wsrep_seqno_t seqno_l);
 
         const struct wsrep_stats_var* stats_get()  const;
         void                          stats_reset();
         void                   stats_free(struct wsrep_stats_var*);
+        struct wsrep_stats_var* build_stats(size_t& size) const;
 
         /*! @throws NotFound */
         void           set_param (const std::string& key,
@@ -175,6 +192,10 @@ namespace galera
             static const std::string key_format;
             static const std::string commit_order;
             static const std::string causal_read_timeout;
+            static const std::string causal_read_lease;
+            static const std::string async_commit_threads;
+            static const std::string stats_interval;
+            static const std::string lock_profile;
             static const std::string max_write_set_size;
         };
 
@@ -189,9 +210,12 @@ namespace galera
         static const Defaults defaults;
         // both a list of parameters and a list of default values
 
+        // keyed TO isolated actions leave commit monitor before they are
+        // executed, so with keyed TOI only apply monitor tells what has
+        // really been committed
         wsrep_seqno_t last_committed()
         {
-            return co_mode_ != CommitOrder::BYPASS ?
+            return (co_mode_ != CommitOrder::BYPASS && !cert_.keyed_toi()) ?
                    commit_monitor_.last_left() : apply_monitor_.last_left();
         }
 
@@ -240,6 +264,11 @@ namespace galera
                 return (last_left + 1 == seqno_);
             }
 
+            static void probe_entered(wsrep_seqno_t s)
+            { GU_PROBE1(galera, local_monitor_enter, s); }
+            static void probe_left(wsrep_seqno_t s)
+            { GU_PROBE1(galera, local_monitor_leave, s); }
+
 #ifdef GU_DBUG_ON
             void debug_sync(gu::Mutex& mutex)
             {
@@ -263,7 +292,8 @@ namespace galera
         {
         public:
 
-            ApplyOrder(TrxHandle& trx) : trx_(trx) { }
+            ApplyOrder(TrxHandle& trx, bool keyed_toi = false)
+                : trx_(trx), keyed_toi_(keyed_toi) { }
 
             void lock()   { trx_.lock();   }
             void unlock() { trx_.unlock(); }
@@ -273,10 +303,17 @@ namespace galera
             bool condition(wsrep_seqno_t last_entered,
                            wsrep_seqno_t last_left) const
             {
-                return (trx_.is_local() == true ||
+                // local keyed TO isolated action has not been executed yet,
+                // so it must wait for its dependencies like a remote one
+                return ((trx_.is_local() == true && !keyed_toi_) ||
                         last_left >= trx_.depends_seqno());
             }
 
+            static void probe_entered(wsrep_seqno_t s)
+            { GU_PROBE1(galera, apply_monitor_enter, s); }
+            static void probe_left(wsrep_seqno_t s)
+            { GU_PROBE1(galera, apply_monitor_leave, s); }
+
 #ifdef GU_DBUG_ON
             void debug_sync(gu::Mutex& mutex)
             {
@@ -302,6 +339,7 @@ namespace galera
         private:
             ApplyOrder(const ApplyOrder&);
             TrxHandle& trx_;
+            bool const keyed_toi_;
         };
 
     public:
@@ -363,6 +401,11 @@ namespace galera
                 gu_throw_fatal << "invalid commit mode value " << mode_;
             }
 
+            static void probe_entered(wsrep_seqno_t s)
+            { GU_PROBE1(galera, commit_monitor_enter, s); }
+            static void probe_left(wsrep_seqno_t s)
+            { GU_PROBE1(galera, commit_monitor_leave, s); }
+
 #ifdef GU_DBUG_ON
             void debug_sync(gu::Mutex& mutex)
             {
@@ -383,17 +426,7 @@ namespace galera
             const Mode mode_;
         };
 
-        class StateRequest
-        {
-        public:
-            virtual const void* req     () const = 0;
-            virtual ssize_t     len     () const = 0;
-            virtual const void* sst_req () const = 0;
-            virtual ssize_t     sst_len () const = 0;
-            virtual const void* ist_req () const = 0;
-            virtual ssize_t     ist_len () const = 0;
-            virtual ~StateRequest() {}
-        };
+        typedef galera::StateRequest StateRequest;
 
     private:
         // state machine
@@ -442,6 +475,7 @@ namespace galera
                               wsrep_seqno_t       group_seqno);
 
         void recv_IST(void* recv_ctx);
+        void ist_recv_failed(const gu::Exception& e) GU_NORETURN;
 
         StateRequest* prepare_state_request (const void* sst_req,
                                              ssize_t     sst_req_len,
@@ -498,6 +532,7 @@ namespace galera
          * |                 5 |              3 |              1 |
          * |                 6 |              3 |              2 |
          * |                 7 |              3 |              2 |
+         * |                 8 |              3 |              2 |
          * -------------------------------------------------------
          */
 
@@ -544,7 +579,9 @@ namespace galera
         wsrep_seqno_t sst_seqno_;
         gu::Mutex     sst_mutex_;
         gu::Cond      sst_cond_;
+        gu::Mutex     ist_fail_mutex_;
         int           sst_retry_sec_;
+        long long     connect_ts_; // for startup phase timings, 0 when done
 
         // services
         gcache::GCache gcache_;
@@ -567,6 +604,9 @@ namespace galera
         Monitor<ApplyOrder>  apply_monitor_;
         Monitor<CommitOrder> commit_monitor_;
         gu::datetime::Period causal_read_timeout_;
+        gu::datetime::Period causal_read_lease_;
+        AsyncCommit          async_commit_;
+        StatsSnapshot        stats_snapshot_;
 
         // counters
         gu::Atomic<size_t>    receivers_;
@@ -584,6 +624,13 @@ namespace galera
 
         gu::Atomic<long long> preordered_id_; // temporary preordered ID
 
+        // per-stage latency distributions
+        gu::LatencyHistogram  lat_local_monitor_;
+        gu::LatencyHistogram  lat_cert_;
+        gu::LatencyHistogram  lat_apply_monitor_;
+        gu::LatencyHistogram  lat_commit_monitor_;
+        gu::LatencyHistogram  lat_commit_cb_;
+
         // non-atomic stats
         std::string           incoming_list_;
         mutable gu::Mutex     incoming_mutex_;
@@ -7,6 +7,9 @@
 #include "gu_uri.hpp"
 #include "write_set_ng.hpp"
 #include "gu_throw.hpp"
+#include "gu_thread.hpp"
+#include "gu_event_trace.hpp"
+#include "gu_latency_histogram.hpp"
 
 const std::string galera::ReplicatorSMM::Param::base_host = "base_host";
 const std::string galera::ReplicatorSMM::Param::base_port = "base_port";
@@ -18,6 +21,14 @@ const std::string galera::ReplicatorSMM::Param::commit_order =
     common_prefix + "commit_order";
 const std::string galera::ReplicatorSMM::Param::causal_read_timeout =
     common_prefix + "causal_read_timeout";
+const std::string galera::ReplicatorSMM::Param::causal_read_lease =
+    common_prefix + "causal_read_lease";
+const std::string galera::ReplicatorSMM::Param::async_commit_threads =
+    common_prefix + "async_commit_threads";
+const std::string galera::ReplicatorSMM::Param::stats_interval =
+    common_prefix + "stats_interval";
+const std::string galera::ReplicatorSMM::Param::lock_profile =
+    common_prefix + "lock_profile";
 const std::string galera::ReplicatorSMM::Param::proto_max =
     common_prefix + "proto_max";
 const std::string galera::ReplicatorSMM::Param::key_format =
@@ -25,7 +36,7 @@ const std::string galera::ReplicatorSMM::Param::key_format =
 const std::string galera::ReplicatorSMM::Param::max_write_set_size =
     common_prefix + "max_ws_size";
 
-int const galera::ReplicatorSMM::MAX_PROTO_VER(7);
+int const galera::ReplicatorSMM::MAX_PROTO_VER(8);
 
 galera::ReplicatorSMM::Defaults::Defaults() : map_()
 {
@@ -35,6 +46,10 @@ galera::ReplicatorSMM::Defaults::Defaults() : map_()
     map_.insert(Default(Param::key_format, "FLAT8"));
     map_.insert(Default(Param::commit_order, "3"));
     map_.insert(Default(Param::causal_read_timeout, "PT30S"));
+    map_.insert(Default(Param::causal_read_lease, "PT0S"));
+    map_.insert(Default(Param::async_commit_threads, "0"));
+    map_.insert(Default(Param::stats_interval, "PT0S"));
+    map_.insert(Default(Param::lock_profile, "0"));
     const int max_write_set_size(galera::WriteSetNG::MAX_SIZE);
     map_.insert(Default(Param::max_write_set_size,
                         gu::to_string(max_write_set_size)));
@@ -48,6 +63,7 @@ galera::ReplicatorSMM::InitConfig::InitConfig(gu::Config&       conf,
                                               const char* const base_dir)
 {
     gu::ssl_register_params(conf);
+    gu::thread_register_params(conf);
     Replicator::register_params(conf);
 
     std::map<std::string, std::string>::const_iterator i;
@@ -134,6 +150,9 @@ galera::ReplicatorSMM::ParseOptions::ParseOptions(Replicator&       repl,
     {
         gu_conf_debug_off();
     }
+
+    gu::EventTrace::enable(conf.get<bool>(Replicator::Param::trace));
+    gu::LatencyHistogram::enable(conf.get<bool>(Replicator::Param::latency));
 #ifdef GU_DBUG_ON
     if (conf.is_set(galera::Replicator::Param::dbug))
     {
@@ -157,7 +176,7 @@ void
 galera::ReplicatorSMM::set_param (const std::string& key,
                                   const std::string& value)
 {
-    if (key == Param::commit_order)
+    if (key == Param::commit_order || key == Param::async_commit_threads)
     {
         log_error << "setting '" << key << "' during runtime not allowed";
         gu_throw_error(EPERM)
@@ -167,6 +186,18 @@ galera::ReplicatorSMM::set_param (const std::string& key,
     {
         causal_read_timeout_ = gu::datetime::Period(value);
     }
+    else if (key == Param::causal_read_lease)
+    {
+        causal_read_lease_ = gu::datetime::Period(value);
+    }
+    else if (key == Param::stats_interval)
+    {
+        stats_snapshot_.set_interval(gu::datetime::Period(value));
+    }
+    else if (key == Param::lock_profile)
+    {
+        gu_lock_prof_set_rate(gu::from_string<int>(value));
+    }
     else if (key == Param::base_host ||
              key == Param::base_port ||
              key == Param::base_dir ||
@@ -218,6 +249,11 @@ galera::ReplicatorSMM::param_set (const std::string& key,
         cert_.set_log_conflicts(value);
         return;
     }
+    else if (key == Certification::PARAM_KEYED_TOI)
+    {
+        gu_throw_error(EPERM)
+            << "setting '" << key << "' during runtime not allowed";
+    }
     // this key might be for another module
     else if (0 != key.find(common_prefix))
     {
@@ -234,6 +270,14 @@ galera::ReplicatorSMM::param_set (const std::string& key,
             found = true;
         }
         catch (gu::NotFound&) {}
+
+        try
+        {
+            gu::thread_param_set (key, value);
+            config_.set (key, value);
+            found = true;
+        }
+        catch (gu::NotFound&) {}
     }
 
     if (!found) throw gu::NotFound();
@@ -4,6 +4,10 @@
 #include "uuid.hpp"
 #include <gu_debug_sync.hpp>
 #include <gu_mem.h>
+#include <gu_lock_prof.h>
+#include <gu_thread.hpp>
+
+#include <sstream>
 
 // @todo: should be protected static member of the parent class
 static const size_t GALERA_STAGE_MAX(11);
@@ -23,6 +27,21 @@ static const char* state_str[GALERA_STAGE_MAX] =
     "Destroyed"
 };
 
+// calls/sampled/contended/wait_ns/hold_ns of every lock site
+static void
+lock_prof_status(const gu_lock_site_t* const site, void* const arg)
+{
+    if (0 == site->sampled) return;
+
+    gu::Status& status(*static_cast<gu::Status*>(arg));
+    std::ostringstream os;
+
+    os << site->calls     << "/" << site->sampled << "/"
+       << site->contended << "/" << site->wait_ns << "/" << site->hold_ns;
+
+    status.insert(std::string("lock_prof_") + site->name, os.str());
+}
+
 // @todo: should be protected static member of the parent class
 static wsrep_member_status_t state2stats(galera::ReplicatorSMM::State state)
 {
@@ -114,6 +133,8 @@ typedef enum status_vars
     STATS_CERT_INDEX_SIZE,
     STATS_CAUSAL_READS,
     STATS_CERT_INTERVAL,
+    STATS_CAUSAL_COALESCING,
+    STATS_CAUSAL_LEASED,
     STATS_INCOMING_LIST,
     STATS_MAX
 } StatusVars;
@@ -160,6 +181,8 @@ static const struct wsrep_stats_var wsrep_stats[STATS_MAX + 1] =
     { "cert_index_size",          WSREP_VAR_INT64,  { 0 }  },
     { "causal_reads",             WSREP_VAR_INT64,  { 0 }  },
     { "cert_interval",            WSREP_VAR_DOUBLE, { 0 }  },
+    { "causal_coalescing",        WSREP_VAR_DOUBLE, { 0 }  },
+    { "causal_reads_leased",      WSREP_VAR_INT64,  { 0 }  },
     { "incoming_addresses",       WSREP_VAR_STRING, { 0 }  },
     { 0,                          WSREP_VAR_STRING, { 0 }  }
 };
@@ -184,6 +207,19 @@ galera::ReplicatorSMM::stats_get() const
 {
     if (S_DESTROYED == state_()) return 0;
 
+    struct wsrep_stats_var* const ret(stats_snapshot_.get());
+
+    if (ret) return ret;
+
+    size_t size;
+    return build_stats(size);
+}
+
+struct wsrep_stats_var*
+galera::ReplicatorSMM::build_stats(size_t& size) const
+{
+    size = 0;
+
     std::vector<struct wsrep_stats_var> sv(wsrep_stats_);
 
     sv[STATS_PROTOCOL_VERSION   ].value._int64  = protocol_version_;
@@ -217,6 +253,10 @@ galera::ReplicatorSMM::stats_get() const
     sv[STATS_FC_SSENT            ].value._int64  = stats.fc_ssent;
 //    sv[STATS_FC_CSENT            ].value._int64  = stats.fc_csent;
     sv[STATS_FC_RECEIVED         ].value._int64  = stats.fc_received;
+    sv[STATS_CAUSAL_COALESCING   ].value._double =
+        stats.causal_msgs > 0 ?
+        double(stats.causal_reqs)/stats.causal_msgs : 0.0;
+    sv[STATS_CAUSAL_LEASED       ].value._int64  = stats.causal_leased;
 
 
     double avg_cert_interval(0);
@@ -254,6 +294,18 @@ galera::ReplicatorSMM::stats_get() const
     // Get gcs backend status
     gu::Status status;
     gcs_.get_status(status);
+    status.insert("local_monitor_latency",  lat_local_monitor_.to_string());
+    status.insert("cert_latency",           lat_cert_.to_string());
+    status.insert("apply_monitor_latency",  lat_apply_monitor_.to_string());
+    status.insert("commit_monitor_latency", lat_commit_monitor_.to_string());
+    status.insert("commit_cb_latency",      lat_commit_cb_.to_string());
+
+    long st_marks, st_locks, st_writes, st_syncs;
+    st_.stats(st_marks, st_locks, st_writes, st_syncs);
+    status.insert("state_file_writes", gu::to_string(st_writes));
+    status.insert("state_file_syncs",  gu::to_string(st_syncs));
+    gu_lock_prof_foreach(lock_prof_status, &status);
+    gu::thread_get_status(status);
 #ifdef GU_DBUG_ON
     status.insert("debug_sync_waiters", gu_debug_sync_waiters());
 #endif // GU_DBUG_ON
@@ -320,6 +372,8 @@ galera::ReplicatorSMM::stats_get() const
         assert(reinterpret_cast<const char*>(buf)[vec_size + tail_size - 1] == '\0');
         // Finally copy sv vector to buf
         memcpy(buf, &sv[0], vec_size);
+
+        size = vec_size + tail_size;
     }
     else
     {
@@ -344,6 +398,14 @@ galera::ReplicatorSMM::stats_reset()
     commit_monitor_.flush_stats();
 
     cert_.stats_reset();
+
+    lat_local_monitor_.clear();
+    lat_cert_.clear();
+    lat_apply_monitor_.clear();
+    lat_commit_monitor_.clear();
+    lat_commit_cb_.clear();
+
+    stats_snapshot_.refresh();
 }
 
 void
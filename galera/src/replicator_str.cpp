@@ -76,225 +76,6 @@ ReplicatorSMM::sst_received(const wsrep_gtid_t& state_id,
 }
 
 
-class StateRequest_v0 : public ReplicatorSMM::StateRequest
-{
-public:
-    StateRequest_v0 (const void* const sst_req, ssize_t const sst_req_len)
-        : req_(sst_req), len_(sst_req_len)
-    {}
-    ~StateRequest_v0 () {}
-    virtual const void* req     () const { return req_; }
-    virtual ssize_t     len     () const { return len_; }
-    virtual const void* sst_req () const { return req_; }
-    virtual ssize_t     sst_len () const { return len_; }
-    virtual const void* ist_req () const { return 0;    }
-    virtual ssize_t     ist_len () const { return 0;    }
-private:
-    StateRequest_v0 (const StateRequest_v0&);
-    StateRequest_v0& operator = (const StateRequest_v0&);
-    const void* const req_;
-    ssize_t     const len_;
-};
-
-
-class StateRequest_v1 : public ReplicatorSMM::StateRequest
-{
-public:
-    static std::string const MAGIC;
-    StateRequest_v1 (const void* sst_req, ssize_t sst_req_len,
-                     const void* ist_req, ssize_t ist_req_len);
-    StateRequest_v1 (const void* str, ssize_t str_len);
-    ~StateRequest_v1 () { if (own_ && req_) free (req_); }
-    virtual const void* req     () const { return req_; }
-    virtual ssize_t     len     () const { return len_; }
-    virtual const void* sst_req () const { return req(sst_offset()); }
-    virtual ssize_t     sst_len () const { return len(sst_offset()); }
-    virtual const void* ist_req () const { return req(ist_offset()); }
-    virtual ssize_t     ist_len () const { return len(ist_offset()); }
-private:
-    StateRequest_v1 (const StateRequest_v1&);
-    StateRequest_v1& operator = (const StateRequest_v1&);
-
-    ssize_t sst_offset() const { return MAGIC.length() + 1; }
-    ssize_t ist_offset() const
-    {
-        return sst_offset() + sizeof(uint32_t) + sst_len();
-    }
-
-    ssize_t len (ssize_t offset) const
-    {
-        return gtohl(*(reinterpret_cast<uint32_t*>(req_ + offset)));
-    }
-
-    void*   req (ssize_t offset) const
-    {
-        if (len(offset) > 0)
-            return req_ + offset + sizeof(uint32_t);
-        else
-            return 0;
-    }
-
-    ssize_t const len_;
-    char*   const req_;
-    bool    const own_;
-};
-
-std::string const
-StateRequest_v1::MAGIC("STRv1");
-
-#ifndef INT32_MAX
-#define INT32_MAX 0x7fffffff
-#endif
-
-StateRequest_v1::StateRequest_v1 (
-    const void* const sst_req, ssize_t const sst_req_len,
-    const void* const ist_req, ssize_t const ist_req_len)
-    :
-    len_(MAGIC.length() + 1 +
-         sizeof(uint32_t) + sst_req_len +
-         sizeof(uint32_t) + ist_req_len),
-    req_(reinterpret_cast<char*>(malloc(len_))),
-    own_(true)
-{
-    if (!req_)
-        gu_throw_error (ENOMEM) << "Could not allocate state request v1";
-
-    if (sst_req_len > INT32_MAX || sst_req_len < 0)
-        gu_throw_error (EMSGSIZE) << "SST request length (" << sst_req_len
-                               << ") unrepresentable";
-
-    if (ist_req_len > INT32_MAX || ist_req_len < 0)
-        gu_throw_error (EMSGSIZE) << "IST request length (" << sst_req_len
-                               << ") unrepresentable";
-
-    char* ptr(req_);
-
-    strcpy (ptr, MAGIC.c_str());
-    ptr += MAGIC.length() + 1;
-
-    uint32_t* tmp(reinterpret_cast<uint32_t*>(ptr));
-    *tmp = htogl(sst_req_len);
-    ptr += sizeof(uint32_t);
-
-    memcpy (ptr, sst_req, sst_req_len);
-    ptr += sst_req_len;
-
-    tmp = reinterpret_cast<uint32_t*>(ptr);
-    *tmp = htogl(ist_req_len);
-    ptr += sizeof(uint32_t);
-
-    memcpy (ptr, ist_req, ist_req_len);
-
-    assert ((ptr - req_) == (len_ - ist_req_len));
-}
-
-// takes ownership over str buffer
-StateRequest_v1::StateRequest_v1 (const void* str, ssize_t str_len)
-:
-    len_(str_len),
-    req_(reinterpret_cast<char*>(const_cast<void*>(str))),
-    own_(false)
-{
-    if (sst_offset() + 2*sizeof(uint32_t) > size_t(len_))
-    {
-        assert(0);
-        gu_throw_error (EINVAL) << "State transfer request is too short: "
-                                << len_ << ", must be at least: "
-                                << (sst_offset() + 2*sizeof(uint32_t));
-    }
-
-    if (strncmp (req_, MAGIC.c_str(), MAGIC.length()))
-    {
-        assert(0);
-        gu_throw_error (EINVAL) << "Wrong magic signature in state request v1.";
-    }
-
-    if (sst_offset() + sst_len() + 2*sizeof(uint32_t) > size_t(len_))
-    {
-        gu_throw_error (EINVAL) << "Malformed state request v1: sst length: "
-                                << sst_len() << ", total length: " << len_;
-    }
-
-    if (ist_offset() + ist_len() + sizeof(uint32_t) != size_t(len_))
-    {
-        gu_throw_error (EINVAL) << "Malformed state request v1: parsed field "
-            "length " << sst_len() << " is not equal to total request length "
-                                << len_;
-    }
-}
-
-
-static ReplicatorSMM::StateRequest*
-read_state_request (const void* const req, size_t const req_len)
-{
-    const char* const str(reinterpret_cast<const char*>(req));
-
-    if (req_len > StateRequest_v1::MAGIC.length() &&
-        !strncmp(str, StateRequest_v1::MAGIC.c_str(),
-                 StateRequest_v1::MAGIC.length()))
-    {
-        return (new StateRequest_v1(req, req_len));
-    }
-    else
-    {
-        return (new StateRequest_v0(req, req_len));
-    }
-}
-
-
-class IST_request
-{
-public:
-    IST_request() : peer_(), uuid_(), last_applied_(), group_seqno_() { }
-    IST_request(const std::string& peer,
-                const wsrep_uuid_t& uuid,
-                wsrep_seqno_t last_applied,
-                wsrep_seqno_t group_seqno)
-        :
-        peer_(peer),
-        uuid_(uuid),
-        last_applied_(last_applied),
-        group_seqno_(group_seqno)
-    { }
-    const std::string&  peer()  const { return peer_ ; }
-    const wsrep_uuid_t& uuid()  const { return uuid_ ; }
-    wsrep_seqno_t       last_applied() const { return last_applied_; }
-    wsrep_seqno_t       group_seqno()  const { return group_seqno_; }
-private:
-    friend std::ostream& operator<<(std::ostream&, const IST_request&);
-    friend std::istream& operator>>(std::istream&, IST_request&);
-    std::string peer_;
-    wsrep_uuid_t uuid_;
-    wsrep_seqno_t last_applied_;
-    wsrep_seqno_t group_seqno_;
-};
-
-std::ostream& operator<<(std::ostream& os, const IST_request& istr)
-{
-    return (os
-            << istr.uuid_         << ":"
-            << istr.last_applied_ << "-"
-            << istr.group_seqno_  << "|"
-            << istr.peer_);
-}
-
-std::istream& operator>>(std::istream& is, IST_request& istr)
-{
-    char c;
-    return (is >> istr.uuid_ >> c >> istr.last_applied_
-            >> c >> istr.group_seqno_ >> c >> istr.peer_);
-}
-
-static void
-get_ist_request(const ReplicatorSMM::StateRequest* str, IST_request* istr)
-{
-  assert(str->ist_len());
-  std::string ist_str(reinterpret_cast<const char*>(str->ist_req()),
-                      str->ist_len());
-  std::istringstream is(ist_str);
-  is >> *istr;
-}
-
 static bool
 sst_is_trivial (const void* const req, size_t const len)
 {
@@ -386,9 +167,12 @@ void ReplicatorSMM::process_state_req(void*       recv_ctx,
             {
                 log_info << "IST request: " << istr;
 
+                // gcache lock is shared with other async IST senders, hold
+                // history through their cursor until the sender attaches
                 try
                 {
-                    gcache_.seqno_lock(istr.last_applied() + 1);
+                    ist_senders_.cursor().attach(streq,
+                                                 istr.last_applied() + 1);
                 }
                 catch(gu::NotFound& nf)
                 {
@@ -436,6 +220,8 @@ void ReplicatorSMM::process_state_req(void*       recv_ctx,
                     log_error << "Failed to bypass SST";
                 }
 
+                ist_senders_.cursor().detach(streq);
+
                 goto out;
             }
         }
@@ -472,6 +258,64 @@ out:
 }
 
 
+void
+ReplicatorSMM::process_ist_stripe_req(const void*         req,
+                                      size_t        const req_size,
+                                      wsrep_seqno_t const seqno_l)
+{
+    assert(req != 0);
+    assert(seqno_l > -1);
+
+    LocalOrder lo(seqno_l);
+
+    gu_trace(local_monitor_.enter(lo));
+
+    StateRequest* const streq (read_state_request (req, req_size));
+
+    if (streq->ist_len())
+    {
+        IST_request istr;
+        get_ist_request(streq, &istr);
+
+        wsrep_seqno_t const first(istr.last_applied() + 1);
+
+        if (istr.uuid() == state_uuid_)
+        {
+            log_info << "Serving IST stripe for request: " << istr;
+
+            try
+            {
+                // same range as the donor sends, see process_state_req(),
+                // gcache lock is held by the sender's shared cursor
+                ist_senders_.run(config_,
+                                 istr.peer(),
+                                 first,
+                                 cc_seqno_,
+                                 protocol_version_);
+            }
+            catch (gu::NotFound& nf)
+            {
+                log_warn << "IST stripe first seqno " << first
+                         << " not found from cache, joiner IST will fail";
+            }
+            catch (gu::Exception& e)
+            {
+                log_error << "IST stripe sender failed: " << e.what();
+            }
+        }
+        else
+        {
+            log_warn << "IST stripe request for " << istr.uuid()
+                     << " does not match local state " << state_uuid_;
+        }
+    }
+
+    delete streq;
+
+    local_monitor_.leave(lo);
+}
+
+
 void
 ReplicatorSMM::prepare_for_IST (void*& ptr, ssize_t& len,
                                 const wsrep_uuid_t& group_uuid,
@@ -575,6 +419,7 @@ ReplicatorSMM::send_state_request (const StateRequest* const req)
 
     gu_uuid_t ist_uuid = {{0, }};
     gcs_seqno_t ist_seqno = GCS_SEQNO_ILL;
+    int str_version(str_proto_ver_);
 
     if (req->ist_len())
     {
@@ -582,6 +427,14 @@ ReplicatorSMM::send_state_request (const StateRequest* const req)
       get_ist_request(req, &istr);
       ist_uuid = to_gu_uuid(istr.uuid());
       ist_seqno = istr.last_applied();
+
+      if (str_proto_ver_ >= 2)
+      {
+          // ask group for helpers to serve IST in parallel with donor
+          int stripes(config_.get(ist::Receiver::STRIPES, 1));
+          stripes = std::max(1, std::min(stripes, GCS_STR_STRIPES_MAX));
+          str_version |= (stripes - 1) << GCS_STR_STRIPES_SHIFT;
+      }
     }
 
     do
@@ -590,7 +443,7 @@ ReplicatorSMM::send_state_request (const StateRequest* const req)
 
         gcs_seqno_t seqno_l;
 
-        ret = gcs_.request_state_transfer(str_proto_ver_,
+        ret = gcs_.request_state_transfer(str_version,
                                           req->req(), req->len(), sst_donor_,
                                           ist_uuid, ist_seqno, &seqno_l);
         if (ret < 0)
@@ -746,7 +599,7 @@ ReplicatorSMM::request_state_transfer (void* recv_ctx,
             log_info << "Receiving IST: " << (group_seqno - STATE_SEQNO())
                      << " writesets, seqnos " << STATE_SEQNO()
                      << "-" << group_seqno;
-            ist_receiver_.ready();
+            ist_receiver_.ready(gcs_.ist_stripes());
             recv_IST(recv_ctx);
             sst_seqno_ = ist_receiver_.finished();
 
@@ -772,9 +625,19 @@ void ReplicatorSMM::recv_IST(void* recv_ctx)
     {
         TrxHandle* trx(0);
         int err;
+
+        try
+        {
+            err = ist_receiver_.recv(&trx);
+        }
+        catch (gu::Exception& e)
+        {
+            ist_recv_failed(e);
+        }
+
         try
         {
-            if ((err = ist_receiver_.recv(&trx)) == 0)
+            if (err == 0)
             {
                 assert(trx != 0);
                 TrxHandleLock lock(*trx);
@@ -820,4 +683,38 @@ void ReplicatorSMM::recv_IST(void* recv_ctx)
         }
     }
 }
+
+
+/* Connection loss which could not be resumed (ECONNABORTED) leaves
+ * a consistent state: write sets come in order and everything received has
+ * been handed to appliers. Wait for them and save the position, so that
+ * the restarted node asks any donor for the rest via IST instead of SST.
+ * Any other failure may leave the state inconsistent. */
+void ReplicatorSMM::ist_recv_failed(const gu::Exception& e)
+{
+    // every IST applier ends up here, the first one does the job and the
+    // rest stay blocked until abort()
+    gu::Lock lock(ist_fail_mutex_);
+
+    if (e.get_errno() != ECONNABORTED)
+    {
+        log_fatal << "receiving IST failed, node restart required: "
+                  << e.what();
+        st_.mark_corrupt();
+        abort();
+    }
+
+    log_error << "receiving IST failed: " << e.what();
+
+    wsrep_seqno_t const last(ist_receiver_.finished());
+
+    apply_monitor_.drain(last);
+
+    st_.set(state_uuid_, last, safe_to_bootstrap_);
+
+    log_fatal << "IST interrupted, saved position " << state_uuid_ << ':'
+              << last << ", node restart required";
+
+    abort();
+}
 } /* namespace galera */
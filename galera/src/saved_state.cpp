@@ -4,9 +4,13 @@
 
 #include "saved_state.hpp"
 #include "gu_dbug.h"
+#include "gu_datetime.hpp"
+#include "gu_thread.hpp"
 #include "uuid.hpp"
 
 #include <fstream>
+#include <cerrno>
+#include <unistd.h>
 
 #define __STDC_FORMAT_MACROS
 #include <inttypes.h>
@@ -19,6 +23,9 @@ namespace galera
 #define VERSION "2.1"
 #define MAX_SIZE 256
 
+/* how long safe state write waits for the next mark_unsafe() to cancel it */
+static gu::datetime::Period const WRITE_DELAY(10 * gu::datetime::MSec);
+
 SavedState::SavedState  (const std::string& file) :
     fs_           (0),
     uuid_         (WSREP_UUID_UNDEFINED),
@@ -31,7 +38,13 @@ SavedState::SavedState  (const std::string& file) :
     current_len_  (0),
     total_marks_  (0),
     total_locks_  (0),
-    total_writes_ (0)
+    total_writes_ (0),
+    total_syncs_  (0),
+    cond_         (),
+    writer_       (),
+    writer_running_(false),
+    writer_exit_  (false),
+    pending_      (false)
 {
 
     GU_DBUG_EXECUTE("galera_init_invalidate_state",
@@ -142,6 +155,18 @@ SavedState::SavedState  (const std::string& file) :
 
 SavedState::~SavedState ()
 {
+    {
+        gu::Lock lock(mtx_);
+
+        writer_exit_ = true;
+        cond_.signal();
+    }
+
+    if (writer_running_) gu_thread_join(writer_, NULL);
+
+    /* don't lose safe state if shutting down right after mark_safe() */
+    write_pending();
+
     if (fs_)
     {
         // Closing file descriptor should release the lock, but still...
@@ -182,7 +207,10 @@ SavedState::set (const wsrep_uuid_t& u, wsrep_seqno_t s, bool safe_to_bootstrap)
     safe_to_bootstrap_ = safe_to_bootstrap;
 
     if (0 == unsafe_())
+    {
+        pending_ = false;
         write_and_flush (u, s, safe_to_bootstrap);
+    }
     else
         log_debug << "Not writing state: unsafe counter is " << unsafe_();
 }
@@ -190,7 +218,15 @@ SavedState::set (const wsrep_uuid_t& u, wsrep_seqno_t s, bool safe_to_bootstrap)
 /* the goal of unsafe_, written_uuid_, current_len_ below is
  * 1. avoid unnecessary mutex locks
  * 2. if locked - avoid unnecessary file writes
- * 3. if writing - avoid metadata operations, write over existing space */
+ * 3. if writing - avoid metadata operations, write over existing space
+ *
+ * Only the unsafe mark must hit the disk before the caller proceeds: crash
+ * with valid state in the file would allow IST onto modified data. Safe state
+ * can be written later - crash before that just costs SST. So mark_safe()
+ * leaves the write to the background thread which waits WRITE_DELAY first,
+ * and if mark_unsafe() comes in between, there is nothing to write at all:
+ * the file still holds the unsafe mark. This way a burst of TOI actions costs
+ * two writes instead of two per action. */
 
 void
 SavedState::mark_unsafe()
@@ -203,6 +239,8 @@ SavedState::mark_unsafe()
 
         assert (unsafe_() > 0);
 
+        pending_ = false;
+
         if (written_uuid_ != WSREP_UUID_UNDEFINED)
         {
             write_and_flush (WSREP_UUID_UNDEFINED, WSREP_SEQNO_UNDEFINED,
@@ -228,7 +266,20 @@ SavedState::mark_safe()
             assert(false == corrupt_);
             /* this will write down proper seqno if set() was called too early
              * (in unsafe state) */
-            write_and_flush (uuid_, seqno_, safe_to_bootstrap_);
+            if (!writer_running_) start_writer();
+
+            if (writer_running_)
+            {
+                if (!pending_)
+                {
+                    pending_ = true;
+                    cond_.signal();
+                }
+            }
+            else
+            {
+                write_and_flush (uuid_, seqno_, safe_to_bootstrap_);
+            }
         }
     }
 }
@@ -247,6 +298,7 @@ SavedState::mark_corrupt()
     uuid_  = WSREP_UUID_UNDEFINED;
     seqno_ = WSREP_SEQNO_UNDEFINED;
     corrupt_ = true;
+    pending_ = false;
 
     write_and_flush (WSREP_UUID_UNDEFINED, WSREP_SEQNO_UNDEFINED,
                      safe_to_bootstrap_);
@@ -280,6 +332,15 @@ SavedState::write_and_flush(const wsrep_uuid_t& u, const wsrep_seqno_t s,
         fwrite(buf, write_size, 1, fs_);
         fflush(fs_);
 
+        if (fsync(fileno(fs_)))
+        {
+            log_warn << "Failed to sync state file: " << ::strerror(errno);
+        }
+        else
+        {
+            ++total_syncs_;
+        }
+
         current_len_ = state_len;
         written_uuid_ = u;
         ++total_writes_;
@@ -290,5 +351,75 @@ SavedState::write_and_flush(const wsrep_uuid_t& u, const wsrep_seqno_t s,
     }
 }
 
+/* must be called under mtx_ */
+void
+SavedState::start_writer()
+{
+    if (writer_exit_) return;
+
+    int const err(gu_thread_create(&writer_, NULL, writer_thd, this));
+
+    if (err)
+    {
+        log_warn << "Failed to start state file writer thread: " << err
+                 << " (" << ::strerror(err) << "), writing synchronously";
+        return;
+    }
+
+    writer_running_ = true;
+}
+
+void
+SavedState::write_pending()
+{
+    gu::Lock lock(mtx_);
+
+    if (pending_ && 0 == unsafe_() && !corrupt_)
+    {
+        write_and_flush (uuid_, seqno_, safe_to_bootstrap_);
+    }
+
+    pending_ = false;
+}
+
+void*
+SavedState::writer_thd(void* arg)
+{
+    gu::RegisteredThread const reg("state_writer");
+    SavedState* const st(static_cast<SavedState*>(arg));
+
+    gu::Lock lock(st->mtx_);
+
+    while (!st->writer_exit_)
+    {
+        if (!st->pending_)
+        {
+            lock.wait(st->cond_);
+            continue;
+        }
+
+        try
+        {
+            lock.wait(st->cond_,
+                      gu::datetime::Date::calendar() + WRITE_DELAY);
+            continue; // exit or new mark_safe(), start over
+        }
+        catch (gu::Exception& e)
+        {
+            if (e.get_errno() != ETIMEDOUT) throw;
+        }
+
+        if (st->pending_ && 0 == st->unsafe_() && !st->corrupt_)
+        {
+            st->write_and_flush (st->uuid_, st->seqno_,
+                                 st->safe_to_bootstrap_);
+        }
+
+        st->pending_ = false;
+    }
+
+    return 0;
+}
+
 } /* namespace galera */
 
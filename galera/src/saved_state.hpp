@@ -8,6 +8,7 @@
 #include "gu_atomic.hpp"
 #include "gu_mutex.hpp"
 #include "gu_lock.hpp"
+#include "gu_threads.h"
 
 #include "wsrep_api.h"
 
@@ -31,11 +32,12 @@ public:
     void mark_safe();
     void mark_corrupt();
 
-    void stats(long& marks, long& locks, long& writes)
+    void stats(long& marks, long& locks, long& writes, long& syncs) const
     {
         marks  = total_marks_();
         locks  = total_locks_;
         writes = total_writes_;
+        syncs  = total_syncs_;
     }
 
 private:
@@ -55,10 +57,24 @@ private:
     gu::Atomic<long> total_marks_;
     long             total_locks_;
     long             total_writes_;
+    long             total_syncs_;
+
+    /* safe state is written by background thread, so that the next
+     * mark_unsafe() can cancel it, see mark_safe() */
+    gu::Cond         cond_;
+    gu_thread_t      writer_;
+    bool             writer_running_;
+    bool             writer_exit_;
+    bool             pending_;
 
     void write_and_flush (const wsrep_uuid_t& u, const wsrep_seqno_t s,
                           bool safe_to_bootstrap);
 
+    void start_writer();
+    void write_pending();
+
+    static void* writer_thd (void*);
+
     SavedState (const SavedState&);
     SavedState& operator=(const SavedState&);
 
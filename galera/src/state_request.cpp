@@ -0,0 +1,154 @@
+//
+// Copyright (C) 2010-2017 Codership Oy <info@codership.com>
+//
+
+#include "state_request.hpp"
+#include "uuid.hpp"
+
+#include <gu_byteswap.h>
+#include <gu_throw.hpp>
+
+#include <sstream>
+#include <cstring>
+#include <cstdlib>
+#include <cassert>
+
+namespace galera
+{
+
+std::string const
+StateRequest_v1::MAGIC("STRv1");
+
+#ifndef INT32_MAX
+#define INT32_MAX 0x7fffffff
+#endif
+
+StateRequest_v1::StateRequest_v1 (
+    const void* const sst_req, ssize_t const sst_req_len,
+    const void* const ist_req, ssize_t const ist_req_len)
+    :
+    len_(MAGIC.length() + 1 +
+         sizeof(uint32_t) + sst_req_len +
+         sizeof(uint32_t) + ist_req_len),
+    req_(reinterpret_cast<char*>(malloc(len_))),
+    own_(true)
+{
+    if (!req_)
+        gu_throw_error (ENOMEM) << "Could not allocate state request v1";
+
+    if (sst_req_len > INT32_MAX || sst_req_len < 0)
+        gu_throw_error (EMSGSIZE) << "SST request length (" << sst_req_len
+                               << ") unrepresentable";
+
+    if (ist_req_len > INT32_MAX || ist_req_len < 0)
+        gu_throw_error (EMSGSIZE) << "IST request length (" << sst_req_len
+                               << ") unrepresentable";
+
+    char* ptr(req_);
+
+    strcpy (ptr, MAGIC.c_str());
+    ptr += MAGIC.length() + 1;
+
+    uint32_t* tmp(reinterpret_cast<uint32_t*>(ptr));
+    *tmp = htogl(sst_req_len);
+    ptr += sizeof(uint32_t);
+
+    memcpy (ptr, sst_req, sst_req_len);
+    ptr += sst_req_len;
+
+    tmp = reinterpret_cast<uint32_t*>(ptr);
+    *tmp = htogl(ist_req_len);
+    ptr += sizeof(uint32_t);
+
+    memcpy (ptr, ist_req, ist_req_len);
+
+    assert ((ptr - req_) == (len_ - ist_req_len));
+}
+
+// takes ownership over str buffer
+StateRequest_v1::StateRequest_v1 (const void* str, ssize_t str_len)
+:
+    len_(str_len),
+    req_(reinterpret_cast<char*>(const_cast<void*>(str))),
+    own_(false)
+{
+    if (sst_offset() + 2*sizeof(uint32_t) > size_t(len_))
+    {
+        assert(0);
+        gu_throw_error (EINVAL) << "State transfer request is too short: "
+                                << len_ << ", must be at least: "
+                                << (sst_offset() + 2*sizeof(uint32_t));
+    }
+
+    if (strncmp (req_, MAGIC.c_str(), MAGIC.length()))
+    {
+        assert(0);
+        gu_throw_error (EINVAL) << "Wrong magic signature in state request v1.";
+    }
+
+    if (sst_offset() + sst_len() + 2*sizeof(uint32_t) > size_t(len_))
+    {
+        gu_throw_error (EINVAL) << "Malformed state request v1: sst length: "
+                                << sst_len() << ", total length: " << len_;
+    }
+
+    if (ist_offset() + ist_len() + sizeof(uint32_t) != size_t(len_))
+    {
+        gu_throw_error (EINVAL) << "Malformed state request v1: parsed field "
+            "length " << sst_len() << " is not equal to total request length "
+                                << len_;
+    }
+}
+
+ssize_t
+StateRequest_v1::len (ssize_t const offset) const
+{
+    return gtohl(*(reinterpret_cast<uint32_t*>(req_ + offset)));
+}
+
+
+StateRequest*
+read_state_request (const void* const req, size_t const req_len)
+{
+    const char* const str(reinterpret_cast<const char*>(req));
+
+    if (req_len > StateRequest_v1::MAGIC.length() &&
+        !strncmp(str, StateRequest_v1::MAGIC.c_str(),
+                 StateRequest_v1::MAGIC.length()))
+    {
+        return (new StateRequest_v1(req, req_len));
+    }
+    else
+    {
+        return (new StateRequest_v0(req, req_len));
+    }
+}
+
+
+std::ostream& operator<<(std::ostream& os, const IST_request& istr)
+{
+    return (os
+            << istr.uuid_         << ":"
+            << istr.last_applied_ << "-"
+            << istr.group_seqno_  << "|"
+            << istr.peer_);
+}
+
+std::istream& operator>>(std::istream& is, IST_request& istr)
+{
+    char c;
+    return (is >> istr.uuid_ >> c >> istr.last_applied_
+            >> c >> istr.group_seqno_ >> c >> istr.peer_);
+}
+
+void
+get_ist_request(const StateRequest* str, IST_request* istr)
+{
+  assert(str->ist_len());
+  std::string ist_str(reinterpret_cast<const char*>(str->ist_req()),
+                      str->ist_len());
+  std::istringstream is(ist_str);
+  is >> *istr;
+}
+
+} /* namespace galera */
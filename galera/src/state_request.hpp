@@ -0,0 +1,133 @@
+//
+// Copyright (C) 2010-2017 Codership Oy <info@codership.com>
+//
+
+//! @file state_request.hpp
+//
+// @brief State transfer request formats
+//
+// Shared between ReplicatorSMM and garbd, which parses IST requests
+// when it serves IST stripes from its cache.
+//
+
+#ifndef GALERA_STATE_REQUEST_HPP
+#define GALERA_STATE_REQUEST_HPP
+
+#include "wsrep_api.h"
+
+#include <string>
+#include <iostream>
+#include <sys/types.h>
+
+namespace galera
+{
+    class StateRequest
+    {
+    public:
+        virtual const void* req     () const = 0;
+        virtual ssize_t     len     () const = 0;
+        virtual const void* sst_req () const = 0;
+        virtual ssize_t     sst_len () const = 0;
+        virtual const void* ist_req () const = 0;
+        virtual ssize_t     ist_len () const = 0;
+        virtual ~StateRequest() {}
+    };
+
+    class StateRequest_v0 : public StateRequest
+    {
+    public:
+        StateRequest_v0 (const void* const sst_req, ssize_t const sst_req_len)
+            : req_(sst_req), len_(sst_req_len)
+        {}
+        ~StateRequest_v0 () {}
+        virtual const void* req     () const { return req_; }
+        virtual ssize_t     len     () const { return len_; }
+        virtual const void* sst_req () const { return req_; }
+        virtual ssize_t     sst_len () const { return len_; }
+        virtual const void* ist_req () const { return 0;    }
+        virtual ssize_t     ist_len () const { return 0;    }
+    private:
+        StateRequest_v0 (const StateRequest_v0&);
+        StateRequest_v0& operator = (const StateRequest_v0&);
+        const void* const req_;
+        ssize_t     const len_;
+    };
+
+    class StateRequest_v1 : public StateRequest
+    {
+    public:
+        static std::string const MAGIC;
+        StateRequest_v1 (const void* sst_req, ssize_t sst_req_len,
+                         const void* ist_req, ssize_t ist_req_len);
+        StateRequest_v1 (const void* str, ssize_t str_len);
+        ~StateRequest_v1 () { if (own_ && req_) free (req_); }
+        virtual const void* req     () const { return req_; }
+        virtual ssize_t     len     () const { return len_; }
+        virtual const void* sst_req () const { return req(sst_offset()); }
+        virtual ssize_t     sst_len () const { return len(sst_offset()); }
+        virtual const void* ist_req () const { return req(ist_offset()); }
+        virtual ssize_t     ist_len () const { return len(ist_offset()); }
+    private:
+        StateRequest_v1 (const StateRequest_v1&);
+        StateRequest_v1& operator = (const StateRequest_v1&);
+
+        ssize_t sst_offset() const { return MAGIC.length() + 1; }
+        ssize_t ist_offset() const
+        {
+            return sst_offset() + sizeof(uint32_t) + sst_len();
+        }
+
+        ssize_t len (ssize_t offset) const;
+
+        void*   req (ssize_t offset) const
+        {
+            if (len(offset) > 0)
+                return req_ + offset + sizeof(uint32_t);
+            else
+                return 0;
+        }
+
+        ssize_t const len_;
+        char*   const req_;
+        bool    const own_;
+    };
+
+    /*! @return new state request object of the version req is in,
+     *          req buffer is not copied */
+    StateRequest* read_state_request (const void* req, size_t req_len);
+
+    class IST_request
+    {
+    public:
+        IST_request() : peer_(), uuid_(), last_applied_(), group_seqno_() { }
+        IST_request(const std::string& peer,
+                    const wsrep_uuid_t& uuid,
+                    wsrep_seqno_t last_applied,
+                    wsrep_seqno_t group_seqno)
+            :
+            peer_(peer),
+            uuid_(uuid),
+            last_applied_(last_applied),
+            group_seqno_(group_seqno)
+        { }
+        const std::string&  peer()  const { return peer_ ; }
+        const wsrep_uuid_t& uuid()  const { return uuid_ ; }
+        wsrep_seqno_t       last_applied() const { return last_applied_; }
+        wsrep_seqno_t       group_seqno()  const { return group_seqno_; }
+    private:
+        friend std::ostream& operator<<(std::ostream&, const IST_request&);
+        friend std::istream& operator>>(std::istream&, IST_request&);
+        std::string peer_;
+        wsrep_uuid_t uuid_;
+        wsrep_seqno_t last_applied_;
+        wsrep_seqno_t group_seqno_;
+    };
+
+    std::ostream& operator<<(std::ostream& os, const IST_request& istr);
+    std::istream& operator>>(std::istream& is, IST_request& istr);
+
+    /*! parses IST part of the state request, str->ist_len() must be > 0 */
+    void get_ist_request(const StateRequest* str, IST_request* istr);
+}
+
+#endif /* GALERA_STATE_REQUEST_HPP */
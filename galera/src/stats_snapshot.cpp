@@ -0,0 +1,226 @@
+//
+// Copyright (C) 2017 Codership Oy <info@codership.com>
+//
+
+#include "stats_snapshot.hpp"
+
+#include "gu_logger.hpp"
+#include "gu_throw.hpp"
+#include "gu_mem.h"
+#include "gu_thread.hpp"
+
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+
+void*
+galera::StatsSnapshot::thd_func(void* arg)
+{
+    gu::RegisteredThread const reg("stats");
+    StatsSnapshot* const ss(static_cast<StatsSnapshot*>(arg));
+
+    while (true)
+    {
+        size_t size(0);
+        struct wsrep_stats_var* const vars(ss->source_.build_stats(size));
+
+        if (vars)
+        {
+            Buf* const buf(new Buf);
+            buf->vars_ = vars;
+            buf->size_ = size;
+            buf->refs_ = 1; // reference held by cur_
+            ss->publish(buf);
+        }
+
+        gu::Lock lock(ss->thd_mtx_);
+
+        if (!ss->exit_ && !ss->refresh_)
+        {
+            try
+            {
+                lock.wait(ss->thd_cond_,
+                          gu::datetime::Date::calendar() + ss->interval_);
+            }
+            catch (gu::Exception& e)
+            {
+                if (e.get_errno() != ETIMEDOUT) throw;
+            }
+        }
+
+        ss->refresh_ = false;
+
+        if (ss->exit_) break;
+    }
+
+    return 0;
+}
+
+galera::StatsSnapshot::StatsSnapshot(const Source& source)
+    :
+    source_   (source),
+    buf_mtx_  (),
+    cur_      (0),
+    thd_mtx_  (),
+    thd_cond_ (),
+    interval_ (0),
+    thd_      (),
+    running_  (false),
+    refresh_  (false),
+    exit_     (false)
+{ }
+
+galera::StatsSnapshot::~StatsSnapshot()
+{
+    stop();
+}
+
+void
+galera::StatsSnapshot::set_interval(const gu::datetime::Period& interval)
+{
+    if (interval.get_nsecs() <= 0)
+    {
+        stop();
+        return;
+    }
+
+    gu::Lock lock(thd_mtx_);
+
+    interval_ = interval;
+
+    if (running_)
+    {
+        thd_cond_.signal(); // pick up new interval
+        return;
+    }
+
+    exit_ = false;
+
+    int const err(gu_thread_create(&thd_, NULL, thd_func, this));
+
+    if (err)
+    {
+        log_warn << "Failed to start stats snapshot thread: " << err
+                 << " (" << strerror(err) << "), stats will be collected "
+                 << "on every call";
+        return;
+    }
+
+    running_ = true;
+}
+
+void
+galera::StatsSnapshot::stop()
+{
+    {
+        gu::Lock lock(thd_mtx_);
+
+        if (!running_) return;
+
+        exit_ = true;
+        thd_cond_.signal();
+    }
+
+    gu_thread_join(thd_, NULL);
+
+    {
+        gu::Lock lock(thd_mtx_);
+        running_ = false;
+    }
+
+    // readers fall back to collecting stats themselves
+    publish(0);
+}
+
+void
+galera::StatsSnapshot::refresh()
+{
+    gu::Lock lock(thd_mtx_);
+
+    if (running_)
+    {
+        refresh_ = true;
+        thd_cond_.signal();
+    }
+}
+
+void
+galera::StatsSnapshot::publish(Buf* const buf)
+{
+    Buf* old;
+
+    {
+        gu::Lock lock(buf_mtx_);
+        old  = cur_;
+        cur_ = buf;
+    }
+
+    if (old) release(old);
+}
+
+void
+galera::StatsSnapshot::release(Buf* const buf) const
+{
+    bool last;
+
+    {
+        gu::Lock lock(buf_mtx_);
+        assert(buf->refs_ > 0);
+        last = (--buf->refs_ == 0);
+    }
+
+    if (last)
+    {
+        gu_free(buf->vars_);
+        delete buf;
+    }
+}
+
+/* Names and string values either point to static storage or into the buffer
+ * itself, the latter have to be relocated into the copy. */
+static inline const char*
+relocate(const char* const ptr, const char* const from, size_t const size,
+         char* const to)
+{
+    return (ptr >= from && ptr < from + size) ? to + (ptr - from) : ptr;
+}
+
+struct wsrep_stats_var*
+galera::StatsSnapshot::get() const
+{
+    Buf* buf;
+
+    {
+        gu::Lock lock(buf_mtx_);
+        buf = cur_;
+        if (buf) ++buf->refs_;
+    }
+
+    if (!buf) return 0;
+
+    struct wsrep_stats_var* const ret(
+        static_cast<struct wsrep_stats_var*>(gu_malloc(buf->size_)));
+
+    if (ret)
+    {
+        const char* const from(reinterpret_cast<const char*>(buf->vars_));
+        char* const       to  (reinterpret_cast<char*>(ret));
+
+        ::memcpy(ret, buf->vars_, buf->size_);
+
+        for (struct wsrep_stats_var* v(ret); v->name != 0; ++v)
+        {
+            v->name = relocate(v->name, from, buf->size_, to);
+
+            if (WSREP_VAR_STRING == v->type && v->value._string != 0)
+            {
+                v->value._string =
+                    relocate(v->value._string, from, buf->size_, to);
+            }
+        }
+    }
+
+    release(buf);
+
+    return ret;
+}
@@ -0,0 +1,92 @@
+//
+// Copyright (C) 2017 Codership Oy <info@codership.com>
+//
+
+//! @file stats_snapshot.hpp
+//
+// @brief Periodically refreshed snapshot of wsrep status variables
+//
+// Collecting status variables touches monitors, certification, gcs and
+// gcache locks. With the snapshot enabled a background thread does it at
+// a fixed interval and stats_get() callers only copy the last published
+// snapshot, taking nothing but the snapshot's own mutex for a pointer swap.
+//
+
+#ifndef GALERA_STATS_SNAPSHOT_HPP
+#define GALERA_STATS_SNAPSHOT_HPP
+
+#include "wsrep_api.h"
+
+#include "gu_lock.hpp"
+#include "gu_datetime.hpp"
+#include "gu_threads.h"
+
+namespace galera
+{
+    class StatsSnapshot
+    {
+    public:
+
+        class Source
+        {
+        public:
+            /*! @return self-contained gu_malloc()'ed array of status
+             *          variables, its total size in bytes in size */
+            virtual struct wsrep_stats_var* build_stats(size_t& size) const
+                = 0;
+        protected:
+            virtual ~Source() {}
+        };
+
+        StatsSnapshot(const Source& source);
+
+        ~StatsSnapshot();
+
+        /*! sets refresh interval, zero interval stops refreshing */
+        void set_interval(const gu::datetime::Period& interval);
+
+        /*! stops refresh thread and releases the snapshot */
+        void stop();
+
+        /*! requests refresh without waiting for the interval to expire */
+        void refresh();
+
+        /*! @return gu_malloc()'ed copy of the last snapshot or 0 if
+         *          snapshot is disabled or not built yet */
+        struct wsrep_stats_var* get() const;
+
+    private:
+
+        struct Buf
+        {
+            struct wsrep_stats_var* vars_;
+            size_t                  size_;
+            int                     refs_;
+        };
+
+        const Source&        source_;
+
+        // protects cur_ and reference counts only
+        mutable gu::Mutex    buf_mtx_;
+        Buf*                 cur_;
+
+        // refresh thread control
+        gu::Mutex            thd_mtx_;
+        gu::Cond             thd_cond_;
+        gu::datetime::Period interval_;
+        gu_thread_t          thd_;
+        bool                 running_;
+        bool                 refresh_;
+        bool                 exit_;
+
+        void publish(Buf* buf);
+        void release(Buf* buf) const;
+
+        static void* thd_func(void*);
+
+        StatsSnapshot(const StatsSnapshot&);
+        StatsSnapshot& operator=(const StatsSnapshot&);
+    };
+}
+
+#endif /* GALERA_STATS_SNAPSHOT_HPP */
@@ -26,6 +26,7 @@
 #include <iomanip>
 
 #include <gu_threads.h>
+#include <gu_thread.hpp>
 
 namespace galera
 {
@@ -816,6 +817,9 @@ namespace galera
 
         static void* checksum_thread (void* arg)
         {
+            // one thread per large write set, don't pay for registration
+            // unless thread.ws_check.* is set
+            gu::RegisteredThread const reg("ws_check", true);
             WriteSetIn* ws(reinterpret_cast<WriteSetIn*>(arg));
             ws->checksum();
             return NULL;
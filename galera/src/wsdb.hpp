@@ -1,5 +1,5 @@
 //
-// Copyright (C) 2010-2014 Codership Oy <info@codership.com>
+// Copyright (C) 2010-2017 Codership Oy <info@codership.com>
 //
 #ifndef GALERA_WSDB_HPP
 #define GALERA_WSDB_HPP
@@ -82,6 +82,36 @@ namespace galera
 
         typedef gu::UnorderedMap<wsrep_conn_id_t, Conn, ConnHash> ConnMap;
 
+        /* Maps are split into lock-striped shards so that client threads
+         * working with different transactions and connections don't
+         * serialize on a single mutex. */
+        static const size_t SHARDS_SHIFT = 6;
+        static const size_t SHARDS       = 1 << SHARDS_SHIFT;
+
+        static size_t shard(uint64_t const key)
+        {
+            // Fibonacci hashing, keys are often sequential or aligned
+            return (key * GU_ULONG_LONG(0x9e3779b97f4a7c15))
+                >> (64 - SHARDS_SHIFT);
+        }
+
+        struct TrxShard
+        {
+            TrxShard() : trx_map_(), conn_trx_map_(), mutex_("wsdb_trx") {}
+
+            TrxMap     trx_map_;
+            ConnTrxMap conn_trx_map_;
+            gu::Mutex  mutex_;
+        };
+
+        struct ConnShard
+        {
+            ConnShard() : conn_map_(), mutex_("wsdb_conn") {}
+
+            ConnMap    conn_map_;
+            gu::Mutex  mutex_;
+        };
+
     public:
         TrxHandle* get_trx(const TrxHandle::Params& params,
                            const wsrep_uuid_t&      source_id,
@@ -104,13 +134,26 @@ namespace galera
         void print(std::ostream& os) const;
 
     private:
-        // Find existing trx handle in the map
-        TrxHandle* find_trx(wsrep_trx_id_t trx_id);
+        TrxShard& trx_shard(wsrep_trx_id_t trx_id, gu_thread_t thd)
+        {
+            return trx_shards_[trx_id != wsrep_trx_id_t(-1) ?
+                               shard(trx_id) : shard(uint64_t(thd))];
+        }
+
+        ConnShard& conn_shard(wsrep_conn_id_t conn_id)
+        {
+            return conn_shards_[shard(conn_id)];
+        }
+
+        // Find existing trx handle in the map and take a reference to it
+        TrxHandle* find_trx(TrxShard&, wsrep_trx_id_t trx_id, gu_thread_t);
 
         // Create new trx handle
-        TrxHandle* create_trx(const TrxHandle::Params& params,
+        TrxHandle* create_trx(TrxShard&,
+                              const TrxHandle::Params& params,
                               const wsrep_uuid_t&      source_id,
-                              wsrep_trx_id_t           trx_id);
+                              wsrep_trx_id_t           trx_id,
+                              gu_thread_t              thd);
 
         Conn*      get_conn(wsrep_conn_id_t conn_id, bool create);
 
@@ -118,11 +161,8 @@ namespace galera
 
         TrxHandle::LocalPool trx_pool_;
 
-        TrxMap       trx_map_;
-        ConnTrxMap   conn_trx_map_;
-        gu::Mutex    trx_mutex_;
-        ConnMap      conn_map_;
-        gu::Mutex    conn_mutex_;
+        TrxShard     trx_shards_[SHARDS];
+        ConnShard    conn_shards_[SHARDS];
     };
 
     inline std::ostream& operator<<(std::ostream& os, const Wsdb& w)
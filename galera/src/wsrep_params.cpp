@@ -5,6 +5,8 @@
 #include "wsrep_params.hpp"
 #include "gu_dbug.h"
 #include "gu_debug_sync.hpp"
+#include "gu_event_trace.hpp"
+#include "gu_latency_histogram.hpp"
 
 void
 wsrep_set_params (galera::Replicator& repl, const char* params)
@@ -33,6 +35,19 @@ wsrep_set_params (galera::Replicator& repl, const char* params)
                     gu_conf_debug_off();
                 }
             }
+            else if (key == galera::Replicator::Param::trace)
+            {
+                gu::EventTrace::enable(gu::from_string<bool>(value));
+            }
+            else if (key == galera::Replicator::Param::latency)
+            {
+                gu::LatencyHistogram::enable(gu::from_string<bool>(value));
+            }
+            else if (key == galera::Replicator::Param::trace_dump)
+            {
+                // one-shot action, the value is not stored
+                gu::EventTrace::dump(value);
+            }
 #ifdef GU_DBUG_ON
             else if (key == galera::Replicator::Param::dbug)
             {
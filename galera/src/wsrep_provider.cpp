@@ -547,6 +547,42 @@ wsrep_status_t galera_pre_commit(wsrep_t*           const gh,
 }
 
 
+/* Optional extension, looked up by WSREP_PRE_COMMIT_ASYNC_SYMBOL */
+extern "C"
+wsrep_status_t wsrep_pre_commit_async(wsrep_t*                const gh,
+                                      wsrep_conn_id_t         const conn_id,
+                                      wsrep_ws_handle_t*      const trx_handle,
+                                      uint32_t                const flags,
+                                      wsrep_async_commit_cb_t const cb,
+                                      void*                   const ctx)
+{
+    assert(gh != 0);
+    assert(gh->ctx != 0);
+    assert(cb != 0);
+
+    REPL_CLASS * repl(reinterpret_cast< REPL_CLASS * >(gh->ctx));
+
+    TrxHandle* trx(get_local_trx(repl, trx_handle, false));
+
+    if (trx == 0)
+    {
+        // no data to replicate, complete synchronously
+        wsrep_trx_meta_t meta;
+        meta.gtid       = WSREP_GTID_UNDEFINED;
+        meta.depends_on = WSREP_SEQNO_UNDEFINED;
+        cb(ctx, WSREP_OK, &meta);
+        return WSREP_OK;
+    }
+
+    wsrep_status_t const retval(repl->pre_commit_async(trx, conn_id, flags,
+                                                       cb, ctx));
+
+    if (retval != WSREP_OK) repl->unref_local_trx(trx);
+
+    return retval;
+}
+
+
 extern "C"
 wsrep_status_t galera_append_key(wsrep_t*           const gh,
                                  wsrep_ws_handle_t* const trx_handle,
@@ -0,0 +1,275 @@
+/*
+ * Copyright (C) 2017 Codership Oy <info@codership.com>
+ */
+
+#include "../src/async_commit.hpp"
+
+#include "gu_thread.hpp"
+
+#include <check.h>
+
+#include <map>
+#include <set>
+#include <vector>
+
+#include <unistd.h>
+
+using galera::AsyncCommit;
+
+namespace
+{
+    // records callback results, in order of arrival
+    struct Results
+    {
+        Results() : mtx(), cond(), status() {}
+
+        gu::Mutex                   mtx;
+        gu::Cond                    cond;
+        std::vector<wsrep_status_t> status;
+
+        void wait(size_t const n)
+        {
+            gu::Lock lock(mtx);
+            while (status.size() < n) lock.wait(cond);
+        }
+    };
+
+    void callback(void* const ctx, wsrep_status_t const status,
+                  const wsrep_trx_meta_t* const meta)
+    {
+        fail_if(meta == NULL);
+
+        Results* const res(static_cast<Results*>(ctx));
+        gu::Lock lock(res->mtx);
+        res->status.push_back(status);
+        res->cond.broadcast();
+    }
+
+    // completes jobs like ReplicatorSMM does, can hold up the first one
+    class Handler : public AsyncCommit::Handler
+    {
+    public:
+
+        Handler(bool const hold)
+            : mtx_(), cond_(), hold_(hold), held_(false), processed_(0),
+              cancelled_(0), active_(), last_(), misordered_(0)
+        {}
+
+        void process_async_commit(const AsyncCommit::Job& job)
+        {
+            {
+                gu::Lock lock(mtx_);
+                if (hold_)
+                {
+                    held_ = true;
+                    cond_.broadcast();
+                    while (hold_) lock.wait(cond_);
+                }
+                ++processed_;
+
+                // jobs of a connection must come one by one, in order
+                if (!active_.insert(job.conn_id_).second ||
+                    job.flags_ < last_[job.conn_id_])
+                {
+                    ++misordered_;
+                }
+                last_[job.conn_id_] = job.flags_;
+            }
+
+            usleep(100); // give other workers a chance to overlap
+
+            {
+                gu::Lock lock(mtx_);
+                active_.erase(job.conn_id_);
+            }
+
+            wsrep_trx_meta_t meta;
+            meta.gtid.uuid  = WSREP_UUID_UNDEFINED;
+            meta.gtid.seqno = processed_;
+            meta.depends_on = WSREP_SEQNO_UNDEFINED;
+
+            job.cb_(job.ctx_, job.flags_ ? WSREP_OK : WSREP_TRX_FAIL,
+                    &meta);
+        }
+
+        void cancel_async_commit(const AsyncCommit::Job& job)
+        {
+            ++cancelled_;
+
+            wsrep_trx_meta_t meta;
+            meta.gtid       = WSREP_GTID_UNDEFINED;
+            meta.depends_on = WSREP_SEQNO_UNDEFINED;
+
+            job.cb_(job.ctx_, WSREP_TRX_FAIL, &meta);
+        }
+
+        void wait_held()
+        {
+            gu::Lock lock(mtx_);
+            while (!held_) lock.wait(cond_);
+        }
+
+        void release()
+        {
+            gu::Lock lock(mtx_);
+            hold_ = false;
+            cond_.broadcast();
+        }
+
+        int processed()  const { return processed_;  }
+        int cancelled()  const { return cancelled_;  }
+        int misordered() const { return misordered_; }
+
+    private:
+
+        gu::Mutex mtx_;
+        gu::Cond  cond_;
+        bool      hold_;
+        bool      held_;
+        int       processed_;
+        int       cancelled_;
+        std::set<wsrep_conn_id_t>           active_;
+        std::map<wsrep_conn_id_t, uint32_t> last_;
+        int       misordered_;
+    };
+
+    AsyncCommit::Job make_job(uint32_t const flags, Results& res,
+                              wsrep_conn_id_t const conn_id = 1)
+    {
+        AsyncCommit::Job const job = { NULL, conn_id, flags, callback, &res };
+        return job;
+    }
+
+    void* stop_thd(void* arg)
+    {
+        static_cast<AsyncCommit*>(arg)->stop();
+        return NULL;
+    }
+}
+
+START_TEST(test_async_commit_disabled)
+{
+    Handler     handler(false);
+    AsyncCommit ac(handler);
+    Results     res;
+
+    fail_if(ac.enabled());
+    fail_if(ac.submit(make_job(1, res)));
+
+    ac.start(2);
+    fail_unless(ac.enabled());
+    ac.stop();
+
+    fail_if(ac.enabled());
+    fail_if(ac.submit(make_job(1, res)));
+    fail_if(res.status.size() != 0);
+}
+END_TEST
+
+START_TEST(test_async_commit_complete)
+{
+    Handler     handler(false);
+    AsyncCommit ac(handler);
+    Results     res;
+
+    ac.start(4);
+
+    // odd jobs succeed, even ones fail certification
+    for (int i(0); i < 100; ++i)
+    {
+        fail_unless(ac.submit(make_job(i % 2, res)));
+    }
+
+    res.wait(100);
+    ac.stop();
+
+    fail_if(handler.processed() != 100);
+    fail_if(handler.cancelled() != 0);
+
+    int ok(0), failed(0);
+    for (size_t i(0); i < res.status.size(); ++i)
+    {
+        if      (res.status[i] == WSREP_OK)       ++ok;
+        else if (res.status[i] == WSREP_TRX_FAIL) ++failed;
+    }
+    fail_if(ok != 50, "ok: %d", ok);
+    fail_if(failed != 50, "failed: %d", failed);
+}
+END_TEST
+
+START_TEST(test_async_commit_conn_order)
+{
+    Handler     handler(false);
+    AsyncCommit ac(handler);
+    Results     res;
+
+    ac.start(4);
+
+    // flags grow with submission order within each of 3 connections
+    for (int i(0); i < 300; ++i)
+    {
+        fail_unless(ac.submit(make_job(i / 3 + 1, res, i % 3)));
+    }
+
+    res.wait(300);
+    ac.stop();
+
+    fail_if(handler.processed() != 300);
+    fail_if(handler.misordered() != 0, "misordered: %d", handler.misordered());
+}
+END_TEST
+
+START_TEST(test_async_commit_cancel)
+{
+    Handler     handler(true);
+    AsyncCommit ac(handler);
+    Results     res;
+
+    ac.start(1);
+
+    for (int i(0); i < 3; ++i) fail_unless(ac.submit(make_job(1, res)));
+
+    // first job is held by the only worker, the other two stay queued
+    handler.wait_held();
+
+    gu_thread_t thd;
+    fail_if(gu_thread_create(&thd, NULL, stop_thd, &ac));
+
+    while (ac.queue_len() > 0) usleep(1000);
+    fail_if(ac.submit(make_job(1, res)));
+
+    handler.release();
+    gu_thread_join(thd, NULL);
+
+    fail_if(handler.processed() != 1);
+    fail_if(handler.cancelled() != 2);
+    fail_if(res.status.size() != 3);
+    fail_if(res.status[0] != WSREP_OK);
+    fail_if(res.status[1] != WSREP_TRX_FAIL);
+    fail_if(res.status[2] != WSREP_TRX_FAIL);
+}
+END_TEST
+
+Suite* async_commit_suite()
+{
+    Suite* s = suite_create("async_commit");
+    TCase* tc;
+
+    tc = tcase_create("test_async_commit_disabled");
+    tcase_add_test(tc, test_async_commit_disabled);
+    suite_add_tcase(s, tc);
+
+    tc = tcase_create("test_async_commit_complete");
+    tcase_add_test(tc, test_async_commit_complete);
+    suite_add_tcase(s, tc);
+
+    tc = tcase_create("test_async_commit_conn_order");
+    tcase_add_test(tc, test_async_commit_conn_order);
+    suite_add_tcase(s, tc);
+
+    tc = tcase_create("test_async_commit_cancel");
+    tcase_add_test(tc, test_async_commit_cancel);
+    suite_add_tcase(s, tc);
+
+    return s;
+}
@@ -20,6 +20,9 @@ extern Suite* trx_handle_suite();
 extern Suite* service_thd_suite();
 extern Suite* ist_suite();
 extern Suite* saved_state_suite();
+extern Suite* wsdb_suite();
+extern Suite* async_commit_suite();
+extern Suite* stats_snapshot_suite();
 
 static suite_creator_t suites[] =
 {
@@ -31,6 +34,9 @@ static suite_creator_t suites[] =
     service_thd_suite,
     ist_suite,
     saved_state_suite,
+    wsdb_suite,
+    async_commit_suite,
+    stats_snapshot_suite,
     0
 };
 
@@ -10,6 +10,7 @@
 #include "monitor.hpp"
 #include "GCache.hpp"
 #include "gu_arch.h"
+#include "gu_time.h"
 #include "replicator_smm.hpp"
 #include <check.h>
 
@@ -78,6 +79,8 @@ public:
     {
         return (last_left >= trx_.depends_seqno());
     }
+    static void probe_entered(wsrep_seqno_t) { }
+    static void probe_left(wsrep_seqno_t) { }
 #ifdef GU_DBUG_ON
     void debug_sync(gu::Mutex&) { }
 #endif // GU_DBUG_ON
@@ -92,16 +95,23 @@ struct sender_args
     wsrep_seqno_t first_;
     wsrep_seqno_t last_;
     int version_;
+    long long send_rate_;
+    wsrep_seqno_t break_at_; // seqno to break the connection at, 0 - never
+    bool resume_;            // whether to reconnect after the break
     sender_args(gcache::GCache& gcache,
                 const std::string& peer,
                 wsrep_seqno_t first, wsrep_seqno_t last,
-                int version)
+                int version, long long send_rate,
+                wsrep_seqno_t break_at, bool resume)
         :
         gcache_(gcache),
         peer_  (peer),
         first_ (first),
         last_  (last),
-        version_(version)
+        version_(version),
+        send_rate_(send_rate),
+        break_at_(break_at),
+        resume_(resume)
     { }
 };
 
@@ -114,17 +124,26 @@ struct receiver_args
     size_t        n_receivers_;
     TrxHandle::SlavePool& trx_pool_;
     int           version_;
+    int           stripes_;
+    std::string   resume_timeout_;
+    int           error_;    // errno of the exception thrown by recv()
+    wsrep_seqno_t finished_; // returned by Receiver::finished()
 
     receiver_args(const std::string listen_addr,
                   wsrep_seqno_t first, wsrep_seqno_t last,
-                  size_t n_receivers, TrxHandle::SlavePool& sp, int version)
+                  size_t n_receivers, TrxHandle::SlavePool& sp, int version,
+                  int stripes, const std::string& resume_timeout)
         :
         listen_addr_(listen_addr),
         first_      (first),
         last_       (last),
         n_receivers_(n_receivers),
         trx_pool_   (sp),
-        version_    (version)
+        version_    (version),
+        stripes_    (stripes),
+        resume_timeout_(resume_timeout),
+        error_      (0),
+        finished_   (WSREP_SEQNO_UNDEFINED)
     { }
 };
 
@@ -132,13 +151,63 @@ struct trx_thread_args
 {
     galera::ist::Receiver& receiver_;
     galera::Monitor<TestOrder> monitor_;
-    trx_thread_args(galera::ist::Receiver& receiver)
+    int stripes_;
+    gu::Mutex mutex_;
+    int error_;
+    trx_thread_args(galera::ist::Receiver& receiver, int stripes)
         :
         receiver_(receiver),
-        monitor_()
+        monitor_(),
+        stripes_(stripes),
+        mutex_(),
+        error_(0)
     { }
 };
 
+/* breaks the connection once when it comes to sending break_at */
+class BreakingSender : public galera::ist::Sender
+{
+public:
+    BreakingSender(const gu::Config& conf, const sender_args& sargs)
+        :
+        galera::ist::Sender(conf, sargs.gcache_, sargs.peer_, sargs.version_),
+        break_at_(sargs.break_at_),
+        resume_  (sargs.resume_),
+        broken_  (false)
+    { }
+
+    ssize_t get_buffers(std::vector<gcache::GCache::Buffer>& bufs,
+                        wsrep_seqno_t                        first)
+    {
+        if (!broken_ && first == break_at_)
+        {
+            broken_ = true;
+
+            if (resume_)
+            {
+                throw asio::system_error(asio::error::connection_reset);
+            }
+
+            gu_throw_error(EIO) << "breaking IST at " << first;
+        }
+
+        // stop the batch right before break_at
+        if (!broken_ && first < break_at_ &&
+            bufs.size() > size_t(break_at_ - first))
+        {
+            bufs.resize(break_at_ - first);
+        }
+
+        return galera::ist::Sender::get_buffers(bufs, first);
+    }
+
+private:
+
+    wsrep_seqno_t const break_at_;
+    bool const          resume_;
+    bool                broken_;
+};
+
 extern "C" void* sender_thd(void* arg)
 {
     mark_point();
@@ -147,11 +216,25 @@ extern "C" void* sender_thd(void* arg)
 
     gu::Config conf;
     galera::ReplicatorSMM::InitConfig(conf, NULL, NULL);
+    if (sargs->send_rate_ > 0)
+    {
+        conf.set(galera::ist::Sender::SEND_RATE,
+                 gu::to_string(sargs->send_rate_));
+    }
     gu_barrier_wait(&start_barrier);
-    galera::ist::Sender sender(conf, sargs->gcache_, sargs->peer_,
-                               sargs->version_);
+    BreakingSender sender(conf, *sargs);
     mark_point();
-    sender.send(sargs->first_, sargs->last_);
+    try
+    {
+        sender.send(sargs->first_, sargs->last_);
+    }
+    catch (gu::Exception& e)
+    {
+        // the receiver sees the connection closed by sender destructor
+        fail_if(sargs->resume_ || sargs->break_at_ == 0,
+                "unexpected sender failure: %s", e.what());
+        log_info << "sender failed: " << e.what();
+    }
     return 0;
 }
 
@@ -159,13 +242,24 @@ extern "C" void* trx_thread(void* arg)
 {
     trx_thread_args* targs(reinterpret_cast<trx_thread_args*>(arg));
     gu_barrier_wait(&start_barrier);
-    targs->receiver_.ready();
+    targs->receiver_.ready(targs->stripes_);
 
     while (true)
     {
         galera::TrxHandle* trx(0);
         int err;
-        if ((err = targs->receiver_.recv(&trx)) != 0)
+        try
+        {
+            err = targs->receiver_.recv(&trx);
+        }
+        catch (gu::Exception& e)
+        {
+            log_info << "recv failed: " << e.what();
+            gu::Lock lock(targs->mutex_);
+            targs->error_ = e.get_errno();
+            return 0;
+        }
+        if (err != 0)
         {
             assert(trx == 0);
             log_info << "terminated with " << err;
@@ -191,6 +285,7 @@ extern "C" void* receiver_thd(void* arg)
     mark_point();
 
     conf.set(galera::ist::Receiver::RECV_ADDR, rargs->listen_addr_);
+    conf.set(galera::ist::Receiver::RESUME_TIMEOUT, rargs->resume_timeout_);
     galera::ist::Receiver receiver(conf, rargs->trx_pool_, 0);
     rargs->listen_addr_ = receiver.prepare(rargs->first_, rargs->last_,
                                            rargs->version_);
@@ -198,7 +293,7 @@ extern "C" void* receiver_thd(void* arg)
     mark_point();
 
     std::vector<gu_thread_t> threads(rargs->n_receivers_);
-    trx_thread_args trx_thd_args(receiver);
+    trx_thread_args trx_thd_args(receiver, rargs->stripes_);
     for (size_t i(0); i < threads.size(); ++i)
     {
         log_info << "starting trx thread " << i;
@@ -207,15 +302,35 @@ extern "C" void* receiver_thd(void* arg)
 
     trx_thd_args.monitor_.set_initial_position(rargs->first_ - 1);
     gu_barrier_wait(&start_barrier);
-    trx_thd_args.monitor_.wait(rargs->last_);
 
+    // trx threads exit on EOF or on error
     for (size_t i(0); i < threads.size(); ++i)
     {
         log_info << "joining trx thread " << i;
         gu_thread_join(threads[i], 0);
     }
 
-    receiver.finished();
+    rargs->error_ = trx_thd_args.error_;
+
+    // this is what ReplicatorSMM::ist_recv_failed() saves on ECONNABORTED
+    rargs->finished_ = receiver.finished();
+
+    if (rargs->error_ == 0)
+    {
+        fail_if(trx_thd_args.monitor_.last_left() != rargs->last_,
+                "last left %lld, expected %lld",
+                (long long)trx_thd_args.monitor_.last_left(),
+                (long long)rargs->last_);
+    }
+    else
+    {
+        // everything up to finished position must have been applied
+        fail_if(trx_thd_args.monitor_.last_left() != rargs->finished_,
+                "last left %lld, finished at %lld",
+                (long long)trx_thd_args.monitor_.last_left(),
+                (long long)rargs->finished_);
+    }
+
     return 0;
 }
 
@@ -232,6 +347,9 @@ static int select_trx_version(int protocol_version)
     case 4:
         return 2;
     case 5:
+    case 6:
+    case 7:
+    case 8:
         return 3;
     }
     fail("unknown protocol version %i", protocol_version);
@@ -239,7 +357,12 @@ static int select_trx_version(int protocol_version)
 }
 
 
-static void test_ist_common(int const version)
+/* @param break_at seqno at which sender connection breaks, 0 - never
+ * @param resume   whether sender comes back to resume the transfer */
+static void test_ist_common(int const version, int const stripes = 1,
+                            long long const send_rate = 0,
+                            wsrep_seqno_t const break_at = 0,
+                            bool const resume = true)
 {
     using galera::KeyData;
     using galera::TrxHandle;
@@ -263,10 +386,14 @@ static void test_ist_common(int const version)
 
     gcache::GCache* gcache = new gcache::GCache(conf, dir);
 
+    // striped IST needs more than one seqno block to interleave
+    size_t const last(stripes > 1 ? 1000 : 10);
+    long long total_size(0);
+
     mark_point();
 
     // populate gcache
-    for (size_t i(1); i <= 10; ++i)
+    for (size_t i(1); i <= last; ++i)
     {
         TrxHandle* trx(TrxHandle::New(lp, trx_params, uuid, 1234+i, 5678+i));
 
@@ -288,6 +415,7 @@ static void test_ist_common(int const version)
             trx->set_last_seen_seqno(last_seen);
             size_t trx_size(trx->serial_size());
             ptr = static_cast<gu::byte_t*>(gcache->malloc(trx_size));
+            total_size += trx_size;
             trx->serialize(ptr, trx_size, 0);
         }
         else
@@ -299,6 +427,7 @@ static void test_ist_common(int const version)
                                                          bufs));
             trx->set_last_seen_seqno(last_seen);
             ptr = static_cast<gu::byte_t*>(gcache->malloc(trx_size));
+            total_size += trx_size;
 
             /* concatenate buffer vector */
             gu::byte_t* p(ptr);
@@ -323,24 +452,60 @@ static void test_ist_common(int const version)
 
     mark_point();
 
-    receiver_args rargs(receiver_addr, 1, 10, 1, sp, version);
-    sender_args sargs(*gcache, rargs.listen_addr_, 1, 10, version);
+    receiver_args rargs(receiver_addr, 1, last, 1, sp, version, stripes,
+                        resume ? "PT30S" : "PT1S");
+    sender_args sargs(*gcache, rargs.listen_addr_, 1, last, version,
+                      send_rate, break_at, resume);
 
-    gu_barrier_init(&start_barrier, 0, 1 + 1 + rargs.n_receivers_);
+    gu_barrier_init(&start_barrier, 0, stripes + 1 + rargs.n_receivers_);
 
-    gu_thread_t sender_thread, receiver_thread;
+    std::vector<gu_thread_t> sender_threads(stripes);
+    gu_thread_t receiver_thread;
 
-    gu_thread_create(&sender_thread, 0, &sender_thd, &sargs);
+    for (int i(0); i < stripes; ++i)
+    {
+        gu_thread_create(&sender_threads[i], 0, &sender_thd, &sargs);
+    }
     mark_point();
     usleep(100000);
     gu_thread_create(&receiver_thread, 0, &receiver_thd, &rargs);
     mark_point();
 
-    gu_thread_join(sender_thread, 0);
+    long long const start(gu_time_monotonic());
+
+    for (int i(0); i < stripes; ++i)
+    {
+        gu_thread_join(sender_threads[i], 0);
+    }
     gu_thread_join(receiver_thread, 0);
 
     mark_point();
 
+    if (break_at > 0 && !resume)
+    {
+        fail_if(rargs.error_ != ECONNABORTED, "expected ECONNABORTED, got %d",
+                rargs.error_);
+        fail_if(rargs.finished_ != break_at - 1,
+                "IST finished at %lld, expected %lld",
+                (long long)rargs.finished_, (long long)break_at - 1);
+    }
+    else
+    {
+        fail_if(rargs.error_ != 0, "IST failed with %d", rargs.error_);
+        fail_if(rargs.finished_ != wsrep_seqno_t(last),
+                "IST finished at %lld, expected %zu",
+                (long long)rargs.finished_, last);
+    }
+
+    if (send_rate > 0)
+    {
+        long long const min_duration(total_size * gu::datetime::Sec /
+                                     send_rate / 2);
+        long long const duration(gu_time_monotonic() - start);
+        fail_if(duration < min_duration, "IST of %lld bytes at %lld bytes/s "
+                "took only %lld ns", total_size, send_rate, duration);
+    }
+
     delete gcache;
 
     mark_point();
@@ -381,6 +546,228 @@ START_TEST(test_ist_v5)
 }
 END_TEST
 
+START_TEST(test_ist_v8)
+{
+    test_ist_common(8);
+}
+END_TEST
+
+START_TEST(test_ist_striped)
+{
+    test_ist_common(5, 3);
+}
+END_TEST
+
+START_TEST(test_ist_striped_v8)
+{
+    test_ist_common(8, 3);
+}
+END_TEST
+
+START_TEST(test_ist_throttled)
+{
+    // around a kilobyte in total, should take a couple of seconds
+    test_ist_common(5, 1, 512);
+}
+END_TEST
+
+START_TEST(test_ist_resume)
+{
+    test_ist_common(8, 1, 0, 5);
+}
+END_TEST
+
+START_TEST(test_ist_striped_resume)
+{
+    // in the middle of the second stripe's first block
+    test_ist_common(8, 3, 0, 300);
+}
+END_TEST
+
+START_TEST(test_ist_resume_timeout)
+{
+    test_ist_common(8, 3, 0, 300, false);
+}
+END_TEST
+
+struct cursor_reader_args
+{
+    galera::ist::SharedCursor& cursor_;
+    wsrep_seqno_t const        first_;
+    wsrep_seqno_t const        last_;
+    useconds_t const           pause_;
+    bool const                 repeat_; // until the other reader is done
+    wsrep_seqno_t              bad_; // first seqno read wrong, 0 if none
+    gu::Mutex&                 mtx_;
+    int&                       running_;
+
+    cursor_reader_args(galera::ist::SharedCursor& cursor,
+                       wsrep_seqno_t first, wsrep_seqno_t last,
+                       useconds_t pause, bool repeat, gu::Mutex& mtx,
+                       int& running)
+        :
+        cursor_(cursor), first_(first), last_(last), pause_(pause),
+        repeat_(repeat), bad_(0), mtx_(mtx), running_(running)
+    { }
+};
+
+/* reads first..last one by one checking that buffers hold their seqnos */
+static bool
+cursor_read_range(cursor_reader_args* const args)
+{
+    std::vector<gcache::GCache::Buffer> bufs(1);
+
+    for (wsrep_seqno_t i(args->first_); i <= args->last_; ++i)
+    {
+        wsrep_seqno_t payload(0);
+
+        if (args->cursor_.get(args, bufs, i) == 1)
+        {
+            ::memcpy(&payload, bufs[0].ptr(), sizeof(payload));
+        }
+
+        if (payload != i || bufs[0].seqno_g() != i)
+        {
+            args->bad_ = i;
+            return false;
+        }
+
+        usleep(args->pause_);
+    }
+
+    return true;
+}
+
+extern "C" void* cursor_reader_thd(void* arg)
+{
+    cursor_reader_args* const args(static_cast<cursor_reader_args*>(arg));
+
+    while (cursor_read_range(args) && args->repeat_)
+    {
+        gu::Lock lock(args->mtx_);
+        if (args->running_ < 2) break;
+    }
+
+    gu::Lock lock(args->mtx_);
+    --args->running_;
+    return 0;
+}
+
+static void
+cursor_test_append(gcache::GCache& gcache, wsrep_seqno_t const seqno,
+                   size_t const size)
+{
+    void* const ptr(gcache.malloc(size));
+    ::memset(ptr, 0, size);
+    ::memcpy(ptr, &seqno, sizeof(seqno));
+    gcache.seqno_assign(ptr, seqno, seqno - 1);
+}
+
+START_TEST(test_shared_cursor)
+{
+    gu::Config conf;
+    galera::ReplicatorSMM::InitConfig(conf, NULL, NULL);
+    std::string gcache_file("ist_check.cache");
+    conf.set("gcache.name", gcache_file);
+    conf.set("gcache.size", "1M");
+    std::string dir(".");
+    gcache::GCache* gcache = new gcache::GCache(conf, dir);
+
+    for (wsrep_seqno_t i(1); i <= 100; ++i)
+    {
+        cursor_test_append(*gcache, i, 16);
+    }
+
+    galera::ist::SharedCursor cursor(*gcache);
+    int s1, s2; // sender identities
+    std::vector<gcache::GCache::Buffer> bufs(10);
+
+    cursor.attach(&s1, 50);
+    fail_if(cursor.shared());
+    fail_if(gcache->seqno_lock_position() != 50);
+
+    // second sender further behind takes the lock back
+    cursor.attach(&s2, 20);
+    fail_unless(cursor.shared());
+    fail_if(gcache->seqno_lock_position() != 20);
+
+    // reading ahead must not move the lock past the slower sender
+    fail_if(cursor.get(&s1, bufs, 50) != 10);
+    fail_if(bufs[0].seqno_g() != 50);
+    fail_if(gcache->seqno_lock_position() != 20);
+
+    fail_if(cursor.get(&s2, bufs, 30) != 10);
+    fail_if(bufs[0].seqno_g() != 30);
+    fail_if(gcache->seqno_lock_position() != 30);
+
+    // the rest of the batch read by s2 is shared
+    fail_if(cursor.get(&s1, bufs, 35) != 5);
+    fail_if(bufs[0].seqno_g() != 35);
+    fail_if(gcache->seqno_lock_position() != 30);
+
+    // lock moves to the remaining sender
+    cursor.detach(&s2);
+    fail_if(cursor.shared());
+    fail_if(gcache->seqno_lock_position() != 35);
+
+    // and is released after the last one
+    cursor.detach(&s1);
+    fail_if(gcache->seqno_lock_position() != 0);
+
+    // concurrent release must never free history a slower reader still
+    // needs, not even while a faster one reads from gcache
+    wsrep_seqno_t const last(1000);
+
+    for (wsrep_seqno_t i(101); i <= last; ++i)
+    {
+        cursor_test_append(*gcache, i, 512);
+    }
+
+    gu::Mutex mtx;
+    int running(2);
+    // slow reader stays behind everything the fast one reads, which keeps
+    // missing the shared window and reading from gcache
+    cursor_reader_args slow(cursor, 20, last / 2 - 1, 1000, false, mtx,
+                            running);
+    cursor_reader_args fast(cursor, last / 2, last, 0, true, mtx, running);
+
+    cursor.attach(&slow, slow.first_);
+    cursor.attach(&fast, fast.first_);
+
+    gu_thread_t slow_thd, fast_thd;
+    gu_thread_create(&slow_thd, 0, &cursor_reader_thd, &slow);
+    gu_thread_create(&fast_thd, 0, &cursor_reader_thd, &fast);
+
+    // keep releasing everything and appending to make gcache discard
+    // released buffers
+    for (wsrep_seqno_t i(last + 1); ; ++i)
+    {
+        {
+            gu::Lock lock(mtx);
+            if (0 == running) break;
+        }
+
+        for (int k(0); k < 50; ++k) gcache->seqno_release(i - 1);
+
+        cursor_test_append(*gcache, i, 512);
+    }
+
+    gu_thread_join(slow_thd, 0);
+    gu_thread_join(fast_thd, 0);
+
+    fail_if(slow.bad_ != 0, "slow reader got wrong buffer for %lld",
+            (long long)slow.bad_);
+    fail_if(fast.bad_ != 0, "fast reader got wrong buffer for %lld",
+            (long long)fast.bad_);
+
+    cursor.detach(&slow);
+    cursor.detach(&fast);
+
+    delete gcache;
+    unlink(gcache_file.c_str());
+}
+END_TEST
+
 Suite* ist_suite()
 {
     Suite* s  = suite_create("ist");
@@ -415,5 +802,45 @@ Suite* ist_suite()
     tcase_add_test(tc, test_ist_v5);
     suite_add_tcase(s, tc);
 
+    tc = tcase_create("test_ist_v8");
+    tcase_set_timeout(tc, 60);
+    tcase_add_test(tc, test_ist_v8);
+    suite_add_tcase(s, tc);
+
+    tc = tcase_create("test_ist_striped");
+    tcase_set_timeout(tc, 60);
+    tcase_add_test(tc, test_ist_striped);
+    suite_add_tcase(s, tc);
+
+    tc = tcase_create("test_ist_striped_v8");
+    tcase_set_timeout(tc, 60);
+    tcase_add_test(tc, test_ist_striped_v8);
+    suite_add_tcase(s, tc);
+
+    tc = tcase_create("test_ist_throttled");
+    tcase_set_timeout(tc, 60);
+    tcase_add_test(tc, test_ist_throttled);
+    suite_add_tcase(s, tc);
+
+    tc = tcase_create("test_ist_resume");
+    tcase_set_timeout(tc, 60);
+    tcase_add_test(tc, test_ist_resume);
+    suite_add_tcase(s, tc);
+
+    tc = tcase_create("test_ist_striped_resume");
+    tcase_set_timeout(tc, 60);
+    tcase_add_test(tc, test_ist_striped_resume);
+    suite_add_tcase(s, tc);
+
+    tc = tcase_create("test_ist_resume_timeout");
+    tcase_set_timeout(tc, 60);
+    tcase_add_test(tc, test_ist_resume_timeout);
+    suite_add_tcase(s, tc);
+
+    tc = tcase_create("test_shared_cursor");
+    tcase_set_timeout(tc, 60);
+    tcase_add_test(tc, test_shared_cursor);
+    suite_add_tcase(s, tc);
+
     return s;
 }
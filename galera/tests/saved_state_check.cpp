@@ -138,12 +138,12 @@ START_TEST(test_unsafe)
         fail_if (safe_to_bootstrap != false);
     }
 
-    long marks, locks, writes;
+    long marks, locks, writes, syncs;
 
-    st.stats(marks, locks, writes);
+    st.stats(marks, locks, writes, syncs);
 
     log_info << "Total marks: " << marks << ", total writes: " << writes
-             << ", total locks: " << locks
+             << ", total syncs: " << syncs << ", total locks: " << locks
              << "\nlocks ratio:  " << (double(locks)/marks)
              << "\nwrites ratio: " << (double(writes)/locks);
 }
@@ -167,7 +167,7 @@ START_TEST(test_corrupt)
         st.set(uuid, WSREP_SEQNO_UNDEFINED, false);
     }
 
-    long marks(0), locks(0), writes(0);
+    long marks(0), locks(0), writes(0), syncs(0);
 
     for (int i = 0; i < 100; ++i)
     {
@@ -195,17 +195,18 @@ START_TEST(test_corrupt)
         fail_if (s != WSREP_SEQNO_UNDEFINED);
         fail_if (stb != false);
 
-        long m, l, w;
+        long m, l, w, y;
 
-        st.stats(m, l, w);
+        st.stats(m, l, w, y);
 
         marks += m;
         locks += l;
         writes += w;
+        syncs += y;
     }
 
     log_info << "Total marks: " << marks << ", total locks: " << locks
-             << ", total writes: " << writes
+             << ", total writes: " << writes << ", total syncs: " << syncs
              << "\nlocks ratio:  " << (double(locks)/marks)
              << "\nwrites ratio: " << (double(writes)/locks);
 
@@ -213,6 +214,54 @@ START_TEST(test_corrupt)
 }
 END_TEST
 
+START_TEST(test_coalesce)
+{
+    unlink (fname);
+
+    wsrep_uuid_t  uuid;
+    wsrep_seqno_t seqno;
+    bool safe_to_bootstrap;
+
+    gu_uuid_from_string("b2c01654-8dfe-11e1-0800-a834d641cfb5",
+                        to_gu_uuid(uuid));
+
+    static int const cycles(1000);
+
+    {
+        SavedState st(fname);
+
+        st.set(uuid, 1234, false);
+
+        long m, l, w0, y0;
+        st.stats(m, l, w0, y0);
+
+        for (int i = 0; i < cycles; ++i)
+        {
+            st.mark_unsafe();
+            st.mark_safe();
+        }
+
+        long w, y;
+        st.stats(m, l, w, y);
+
+        /* back-to-back safe writes get cancelled by the next unsafe mark */
+        fail_if (w - w0 >= cycles / 10, "too many writes: %ld", w - w0);
+        fail_if (y > w);
+    }
+
+    /* pending safe state must be written on destruction */
+    SavedState st(fname);
+
+    st.get(uuid, seqno, safe_to_bootstrap);
+
+    fail_if (uuid  == WSREP_UUID_UNDEFINED);
+    fail_if (seqno != 1234);
+    fail_if (safe_to_bootstrap != false);
+
+    unlink (fname);
+}
+END_TEST
+
 #define WAIT_FOR(cond)                                                  \
     { int count = 1000; while (--count && !(cond)) { usleep (TEST_USLEEP); }}
 
@@ -225,6 +274,7 @@ Suite* saved_state_suite()
     tcase_add_test  (tc, test_basic);
     tcase_add_test  (tc, test_unsafe);
     tcase_add_test  (tc, test_corrupt);
+    tcase_add_test  (tc, test_coalesce);
     tcase_set_timeout(tc, 120);
     suite_add_tcase (s, tc);
 
@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2017 Codership Oy <info@codership.com>
+ */
+
+#include "../src/stats_snapshot.hpp"
+
+#include "gu_mem.h"
+
+#include <check.h>
+
+#include <cstring>
+#include <unistd.h>
+
+using galera::StatsSnapshot;
+
+namespace
+{
+    // builds two variables: a counter of build_stats() calls and a string
+    // stored in the buffer itself
+    class Source : public StatsSnapshot::Source
+    {
+    public:
+
+        Source() : mtx_(), builds_(0) {}
+
+        struct wsrep_stats_var* build_stats(size_t& size) const
+        {
+            long long builds;
+            {
+                gu::Lock lock(mtx_);
+                builds = ++builds_;
+            }
+
+            static const char str[] = "in buffer";
+            size_t const vars_size(3 * sizeof(struct wsrep_stats_var));
+            size = vars_size + sizeof(str);
+
+            struct wsrep_stats_var* const vars(
+                static_cast<struct wsrep_stats_var*>(gu_malloc(size)));
+            if (!vars) return 0;
+
+            char* const str_ptr(reinterpret_cast<char*>(vars) + vars_size);
+            ::memcpy(str_ptr, str, sizeof(str));
+
+            vars[0].name          = "builds";
+            vars[0].type          = WSREP_VAR_INT64;
+            vars[0].value._int64  = builds;
+            vars[1].name          = "string";
+            vars[1].type          = WSREP_VAR_STRING;
+            vars[1].value._string = str_ptr;
+            vars[2].name          = 0;
+
+            return vars;
+        }
+
+        long long builds() const
+        {
+            gu::Lock lock(mtx_);
+            return builds_;
+        }
+
+    private:
+
+        mutable gu::Mutex mtx_;
+        mutable long long builds_;
+    };
+
+    // waits for snapshot with at least min builds
+    struct wsrep_stats_var* wait_snapshot(const StatsSnapshot& ss,
+                                          long long const min)
+    {
+        for (int i(0); i < 1000; ++i)
+        {
+            struct wsrep_stats_var* const vars(ss.get());
+
+            if (vars && vars[0].value._int64 >= min) return vars;
+
+            gu_free(vars);
+            usleep(1000);
+        }
+
+        return 0;
+    }
+}
+
+START_TEST(test_stats_snapshot)
+{
+    Source        src;
+    StatsSnapshot ss(src);
+
+    // disabled
+    fail_if(ss.get() != 0);
+    ss.refresh();
+    fail_if(src.builds() != 0);
+
+    ss.set_interval(gu::datetime::Period("PT1H"));
+
+    struct wsrep_stats_var* vars(wait_snapshot(ss, 1));
+    fail_if(vars == 0);
+
+    fail_if(strcmp(vars[0].name, "builds"));
+    fail_if(strcmp(vars[1].name, "string"));
+    fail_if(strcmp(vars[1].value._string, "in buffer"));
+    fail_if(vars[2].name != 0);
+
+    // string is relocated into the copy, which outlives the snapshot
+    const char* const begin(reinterpret_cast<const char*>(vars));
+    fail_unless(vars[1].value._string > begin);
+    fail_unless(vars[1].value._string < begin + 3*sizeof(*vars) + 10);
+
+    long long const first(vars[0].value._int64);
+
+    // refresh does not wait for the interval
+    ss.refresh();
+    struct wsrep_stats_var* const vars2(wait_snapshot(ss, first + 1));
+    fail_if(vars2 == 0);
+    fail_if(strcmp(vars2[1].value._string, "in buffer"));
+
+    ss.stop();
+    fail_if(ss.get() != 0);
+
+    // copies stay valid after the snapshot is released
+    fail_if(strcmp(vars[1].value._string, "in buffer"));
+
+    gu_free(vars2);
+    gu_free(vars);
+}
+END_TEST
+
+Suite* stats_snapshot_suite()
+{
+    Suite* s = suite_create("stats_snapshot");
+    TCase* tc;
+
+    tc = tcase_create("test_stats_snapshot");
+    tcase_add_test(tc, test_stats_snapshot);
+    suite_add_tcase(s, tc);
+
+    return s;
+}
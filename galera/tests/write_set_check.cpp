@@ -12,6 +12,8 @@
 #include "galera_service_thd.hpp"
 
 #include <cstdlib>
+#include <cstring>
+#include <list>
 #include <check.h>
 
 namespace
@@ -643,6 +645,158 @@ START_TEST(test_trac_726)
 END_TEST
 
 
+/* replicates and certifies a version 3 write set with a single exclusive key
+ * (none if key is 0), local write sets are certified on the originating node.
+ * Write set buffers must outlive the certification index, so they are kept
+ * in bufs. */
+static Certification::TestResult
+cert_v3(Certification&         cert,
+        std::list<gu::Buffer>& bufs,
+        const wsrep_uuid_t&    source,
+        bool                   local,
+        const char*            key,
+        int                    flags,
+        wsrep_seqno_t          last_seen,
+        wsrep_seqno_t          seqno,
+        wsrep_seqno_t&         depends)
+{
+    const int version(3);
+    galera::TrxHandle::Params const trx_params("", version,KeySet::MAX_VERSION);
+
+    TrxHandle* trx(TrxHandle::New(lp, trx_params, source, 1, seqno));
+
+    if (key)
+    {
+        wsrep_buf_t const kb = { key, strlen(key) };
+        trx->append_key(KeyData(version, &kb, 1, WSREP_KEY_EXCLUSIVE, true));
+    }
+    trx->set_flags(trx->flags() | flags);
+
+    WriteSetNG::GatherVector out;
+    size_t const size(trx->write_set_out().gather(trx->source_id(),
+                                                  trx->conn_id(),
+                                                  trx->trx_id(),
+                                                  out));
+    trx->set_last_seen_seqno(last_seen);
+
+    bufs.push_back(gu::Buffer(size));
+    gu::byte_t* const ptr(&bufs.back()[0]);
+    gu::byte_t* p(ptr);
+    for (size_t i(0); i < out->size(); ++i)
+    {
+        ::memcpy(p, out[i].ptr, out[i].size); p += out[i].size;
+    }
+
+    if (!local)
+    {
+        trx->unref();
+        trx = TrxHandle::New(sp);
+    }
+
+    trx->unserialize(ptr, size, 0);
+    trx->set_received(ptr, seqno, seqno);
+
+    Certification::TestResult const result(cert.append_trx(trx));
+    depends = trx->depends_seqno();
+
+    cert.set_trx_committed(trx);
+    trx->unref();
+
+    return result;
+}
+
+START_TEST(test_cert_keyed_toi)
+{
+    log_info << "test_cert_keyed_toi";
+
+    std::list<gu::Buffer> bufs;
+    TestEnv env;
+    env.conf().set(Certification::PARAM_KEYED_TOI, "yes");
+    galera::Certification cert(env.conf(), env.thd());
+    cert.assign_initial_position(0, 3);
+
+    wsrep_uuid_t const uuid1 = {{1, }};
+    wsrep_uuid_t const uuid2 = {{2, }};
+    int const toi(TrxHandle::F_COMMIT | TrxHandle::F_ISOLATION);
+    wsrep_seqno_t d;
+
+    mark_point();
+
+    // 1: remote trx
+    fail_unless(cert_v3(cert, bufs, uuid2, false, "a", TrxHandle::F_COMMIT,
+                        0, 1, d) == Certification::TEST_OK);
+    fail_unless(d == 0, "d: %lld", d);
+
+    // 2: keyed TOI has not seen 1 but does not fail, it depends on it
+    fail_unless(cert_v3(cert, bufs, uuid1, true, "a", toi, 0, 2, d) ==
+                Certification::TEST_OK);
+    fail_unless(d == 1, "d: %lld", d);
+
+    // 3: local trx conflicting with keyed TOI it has not seen
+    fail_unless(cert_v3(cert, bufs, uuid1, true, "a", TrxHandle::F_COMMIT,
+                        1, 3, d) == Certification::TEST_FAILED);
+
+    // 4: same, but TOI has been seen
+    fail_unless(cert_v3(cert, bufs, uuid1, true, "a", TrxHandle::F_COMMIT,
+                        2, 4, d) == Certification::TEST_OK);
+    fail_unless(d == 2, "d: %lld", d);
+
+    // 5: non-conflicting trx does not depend on keyed TOI
+    fail_unless(cert_v3(cert, bufs, uuid2, false, "b", TrxHandle::F_COMMIT,
+                        1, 5, d) == Certification::TEST_OK);
+    fail_unless(d == 0, "d: %lld", d);
+
+    // 6: keyed TOI conflicting with unseen remote trx still passes
+    fail_unless(cert_v3(cert, bufs, uuid2, false, "b", toi, 1, 6, d) ==
+                Certification::TEST_OK);
+    fail_unless(d == 5, "d: %lld", d);
+
+    // 7: TOI without keys stays fully serialized
+    fail_unless(cert_v3(cert, bufs, uuid1, true, 0, toi, 1, 7, d) ==
+                Certification::TEST_OK);
+    fail_unless(d == 6, "d: %lld", d);
+}
+END_TEST
+
+START_TEST(test_cert_classic_toi)
+{
+    log_info << "test_cert_classic_toi";
+
+    std::list<gu::Buffer> bufs;
+    TestEnv env;
+    galera::Certification cert(env.conf(), env.thd());
+    cert.assign_initial_position(0, 3);
+    fail_if(cert.keyed_toi());
+
+    wsrep_uuid_t const uuid1 = {{1, }};
+    wsrep_uuid_t const uuid2 = {{2, }};
+    int const toi(TrxHandle::F_COMMIT | TrxHandle::F_ISOLATION);
+    wsrep_seqno_t d;
+
+    mark_point();
+
+    // 1: remote trx
+    fail_unless(cert_v3(cert, bufs, uuid2, false, "a", TrxHandle::F_COMMIT,
+                        0, 1, d) == Certification::TEST_OK);
+    fail_unless(d == 0, "d: %lld", d);
+
+    // 2: TOI depends on everything before it regardless of keys
+    fail_unless(cert_v3(cert, bufs, uuid1, true, "b", toi, 0, 2, d) ==
+                Certification::TEST_OK);
+    fail_unless(d == 1, "d: %lld", d);
+
+    // 3: local trx conflicting with TOI it has not seen
+    fail_unless(cert_v3(cert, bufs, uuid1, true, "b", TrxHandle::F_COMMIT,
+                        1, 3, d) == Certification::TEST_FAILED);
+
+    // 4: remote TOI conflicting with unseen remote trx
+    fail_unless(cert_v3(cert, bufs, uuid2, false, "b", toi, 0, 4, d) ==
+                Certification::TEST_OK);
+    fail_unless(d == 3, "d: %lld", d);
+}
+END_TEST
+
+
 Suite* write_set_suite()
 {
     Suite* s = suite_create("write_set");
@@ -683,5 +837,15 @@ Suite* write_set_suite()
     tcase_set_timeout(tc, 20);
     suite_add_tcase(s, tc);
 
+    tc = tcase_create("test_cert_keyed_toi");
+    tcase_add_test(tc, test_cert_keyed_toi);
+    tcase_set_timeout(tc, 20);
+    suite_add_tcase(s, tc);
+
+    tc = tcase_create("test_cert_classic_toi");
+    tcase_add_test(tc, test_cert_classic_toi);
+    tcase_set_timeout(tc, 20);
+    suite_add_tcase(s, tc);
+
     return s;
 }
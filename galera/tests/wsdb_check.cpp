@@ -0,0 +1,121 @@
+//
+// Copyright (C) 2017 Codership Oy <info@codership.com>
+//
+
+#include "wsdb.hpp"
+#include "uuid.hpp"
+
+#include <check.h>
+
+#include <vector>
+
+using namespace galera;
+
+static TrxHandle::Params const trx_params("", 3, KeySet::MAX_VERSION);
+
+struct ThdArg
+{
+    Wsdb*        wsdb;
+    wsrep_uuid_t uuid;
+    TrxHandle*   trx;
+};
+
+static void*
+default_trx_thd(void* arg)
+{
+    ThdArg* const a(static_cast<ThdArg*>(arg));
+
+    a->trx = a->wsdb->get_trx(trx_params, a->uuid, wsrep_trx_id_t(-1), true);
+    a->trx->unref();
+    // same thread must find the same default trx
+    TrxHandle* const trx(a->wsdb->get_trx(trx_params, a->uuid,
+                                          wsrep_trx_id_t(-1)));
+    if (trx != a->trx) a->trx = 0;
+    if (trx) trx->unref();
+
+    a->wsdb->discard_trx(wsrep_trx_id_t(-1));
+
+    return 0;
+}
+
+START_TEST(test_trx_map)
+{
+    Wsdb wsdb;
+    wsrep_uuid_t uuid;
+    gu_uuid_generate(reinterpret_cast<gu_uuid_t*>(&uuid), 0, 0);
+
+    size_t const n(1000);
+    std::vector<TrxHandle*> trxs(n + 1);
+
+    for (size_t i(1); i <= n; ++i)
+    {
+        fail_if(wsdb.get_trx(trx_params, uuid, i) != 0);
+        trxs[i] = wsdb.get_trx(trx_params, uuid, i, true);
+        fail_if(trxs[i] == 0);
+        fail_if(trxs[i]->trx_id() != i);
+        trxs[i]->unref();
+    }
+
+    for (size_t i(1); i <= n; ++i)
+    {
+        TrxHandle* const trx(wsdb.get_trx(trx_params, uuid, i));
+        fail_if(trx != trxs[i], "trx %zu: %p != %p", i, trx, trxs[i]);
+        trx->unref();
+        wsdb.discard_trx(i);
+        fail_if(wsdb.get_trx(trx_params, uuid, i) != 0);
+    }
+
+    // default trx ids are kept per thread
+    ThdArg a1 = { &wsdb, uuid, 0 };
+    ThdArg a2 = { &wsdb, uuid, 0 };
+    gu_thread_t t1, t2;
+    gu_thread_create(&t1, 0, default_trx_thd, &a1);
+    gu_thread_join(t1, 0);
+    gu_thread_create(&t2, 0, default_trx_thd, &a2);
+    gu_thread_join(t2, 0);
+    fail_if(a1.trx == 0);
+    fail_if(a2.trx == 0);
+}
+END_TEST
+
+START_TEST(test_conn_map)
+{
+    Wsdb wsdb;
+    wsrep_uuid_t uuid;
+    gu_uuid_generate(reinterpret_cast<gu_uuid_t*>(&uuid), 0, 0);
+
+    size_t const n(1000);
+
+    for (wsrep_conn_id_t c(0); c < n; ++c)
+    {
+        fail_if(wsdb.get_conn_query(trx_params, uuid, c) != 0);
+        TrxHandle* const trx(wsdb.get_conn_query(trx_params, uuid, c, true));
+        fail_if(trx == 0);
+        fail_if(trx->conn_id() != c);
+        fail_if(wsdb.get_conn_query(trx_params, uuid, c) != trx);
+    }
+
+    for (wsrep_conn_id_t c(0); c < n; ++c)
+    {
+        wsdb.discard_conn_query(c);
+        fail_if(wsdb.get_conn_query(trx_params, uuid, c) != 0);
+        wsdb.discard_conn(c);
+    }
+}
+END_TEST
+
+Suite* wsdb_suite()
+{
+    Suite* s = suite_create("wsdb");
+    TCase* tc;
+
+    tc = tcase_create("test_trx_map");
+    tcase_add_test(tc, test_trx_map);
+    suite_add_tcase(s, tc);
+
+    tc = tcase_create("test_conn_map");
+    tcase_add_test(tc, test_conn_map);
+    suite_add_tcase(s, tc);
+
+    return s;
+}
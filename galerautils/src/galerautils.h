@@ -28,6 +28,7 @@ extern "C"
 #include "gu_uuid.h"
 #include "gu_to.h"
 #include "gu_lock_step.h"
+#include "gu_lock_prof.h"
 #include "gu_utils.h"
 #include "gu_config.h"
 #include "gu_abort.h"
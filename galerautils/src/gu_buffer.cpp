@@ -1,6 +1,162 @@
 //
-// Copyright (C) 2010 Codership Oy <info@codership.com>
+// Copyright (C) 2010-2017 Codership Oy <info@codership.com>
 //
 
 #include "gu_buffer.hpp"
+#include "gu_threads.h"
 
+#include <algorithm>
+
+namespace
+{
+    /* size classes are powers of 2 from 256 bytes */
+    size_t const MIN_SHIFT   = 8;
+    size_t const NUM_CLASSES = 24;
+    /* how many bytes of spare buffers each class may hold */
+    size_t const CLASS_BYTES = 4 << 20;
+
+    struct Pool
+    {
+        gu_mutex_t mtx;
+        size_t     max_size;
+        void*      free[NUM_CLASSES];
+        size_t     count[NUM_CLASSES];
+        long long  allocs;
+        long long  reuses;
+    };
+
+    /* statically initialized, so that buffers can be released from
+     * static destructors */
+    Pool pool = { GU_MUTEX_INITIALIZER, 1 << 17, { 0, }, { 0, }, 0, 0 };
+
+    /* smallest class that fits size */
+    inline size_t class_fitting(size_t const size)
+    {
+        size_t c(0);
+        while ((size_t(1) << (c + MIN_SHIFT)) < size) ++c;
+        return c;
+    }
+
+    /* largest class that size fills */
+    inline size_t class_filled(size_t const size)
+    {
+        size_t c(0);
+        while ((size_t(2) << (c + MIN_SHIFT)) <= size) ++c;
+        return c;
+    }
+
+    inline size_t class_limit(size_t const c)
+    {
+        return std::max<size_t>(4, CLASS_BYTES >> (c + MIN_SHIFT));
+    }
+}
+
+gu::SharedBuffer::Ref*
+gu::SharedBuffer::acquire(size_t const size)
+{
+    size_t const c(class_fitting(size));
+    Ref* ret(0);
+
+    gu_mutex_lock(&pool.mtx);
+
+    if (size <= pool.max_size && c < NUM_CLASSES && pool.free[c])
+    {
+        ret = static_cast<Ref*>(pool.free[c]);
+        pool.free[c] = ret->next_;
+        --pool.count[c];
+        ++pool.reuses;
+    }
+    else
+    {
+        ++pool.allocs;
+    }
+
+    bool const pooled(size <= pool.max_size && c < NUM_CLASSES);
+
+    gu_mutex_unlock(&pool.mtx);
+
+    if (!ret)
+    {
+        ret = new Ref();
+        ret->buf_.reserve(pooled ? (size_t(1) << (c + MIN_SHIFT)) : size);
+    }
+    else
+    {
+        ret->refs_ = 1;
+        ret->next_ = 0;
+    }
+
+    return ret;
+}
+
+void
+gu::SharedBuffer::release(Ref* const ref)
+{
+    size_t const cap(ref->buf_.capacity());
+
+    if (cap >= (size_t(1) << MIN_SHIFT))
+    {
+        size_t const c(class_filled(cap));
+
+        ref->buf_.clear();
+
+        gu_mutex_lock(&pool.mtx);
+
+        if (cap <= 2 * pool.max_size && c < NUM_CLASSES &&
+            pool.count[c] < class_limit(c))
+        {
+            ref->next_ = static_cast<Ref*>(pool.free[c]);
+            pool.free[c] = ref;
+            ++pool.count[c];
+
+            gu_mutex_unlock(&pool.mtx);
+            return;
+        }
+
+        gu_mutex_unlock(&pool.mtx);
+    }
+
+    delete ref;
+}
+
+void
+gu::SharedBuffer::pool_configure(size_t const max_size)
+{
+    Ref* trash(0);
+
+    gu_mutex_lock(&pool.mtx);
+
+    pool.max_size = max_size;
+
+    for (size_t c(0); c < NUM_CLASSES; ++c)
+    {
+        if ((size_t(1) << (c + MIN_SHIFT)) <= 2 * max_size) continue;
+
+        while (pool.free[c])
+        {
+            Ref* const ref(static_cast<Ref*>(pool.free[c]));
+            pool.free[c] = ref->next_;
+            ref->next_ = trash;
+            trash = ref;
+        }
+        pool.count[c] = 0;
+    }
+
+    gu_mutex_unlock(&pool.mtx);
+
+    while (trash)
+    {
+        Ref* const ref(trash);
+        trash = ref->next_;
+        delete ref;
+    }
+}
+
+void
+gu::SharedBuffer::pool_stats(long long& allocs, long long& reuses)
+{
+    gu_mutex_lock(&pool.mtx);
+    allocs = pool.allocs;
+    reuses = pool.reuses;
+    gu_mutex_unlock(&pool.mtx);
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2009 Codership Oy <info@codership.com>
+ * Copyright (C) 2009-2017 Codership Oy <info@codership.com>
  */
 
 /*!
@@ -10,14 +10,97 @@
 #define GU_BUFFER_HPP
 
 #include "gu_types.hpp" // for gu::byte_t
+#include "gu_atomic.hpp"
 
-#include <boost/shared_ptr.hpp>
 #include <vector>
+#include <iterator>
+#include <cstddef>
 
 namespace gu
 {
     typedef std::vector<byte_t> Buffer;
-    typedef boost::shared_ptr<Buffer> SharedBuffer;
+
+    /*!
+     * Intrusively reference counted Buffer. Buffers are taken from a pool
+     * of power of 2 size classes and returned there with their storage
+     * when the last reference goes, so in steady state creating one does
+     * not touch the heap at all.
+     */
+    class SharedBuffer
+    {
+    public:
+
+        SharedBuffer() : ref_(0) { }
+
+        /*! empty buffer with at least reserve bytes of capacity */
+        explicit SharedBuffer(size_t const reserve) : ref_(acquire(reserve))
+        { }
+
+        /*! buffer holding a copy of [begin, end) */
+        template <class I>
+        SharedBuffer(I const begin, I const end)
+            :
+            ref_(acquire(std::distance(begin, end)))
+        {
+            ref_->buf_.assign(begin, end);
+        }
+
+        SharedBuffer(const SharedBuffer& other) : ref_(other.ref_)
+        {
+            if (ref_) ref_->refs_.add_and_fetch(1);
+        }
+
+        ~SharedBuffer() { if (ref_) unref(ref_); }
+
+        SharedBuffer& operator=(const SharedBuffer& other)
+        {
+            if (other.ref_) other.ref_->refs_.add_and_fetch(1);
+            if (ref_) unref(ref_);
+            ref_ = other.ref_;
+            return *this;
+        }
+
+        Buffer* get()        const { return ref_ ? &ref_->buf_ : 0; }
+        Buffer& operator*()  const { return ref_->buf_; }
+        Buffer* operator->() const { return &ref_->buf_; }
+
+        bool operator==(const Buffer* const ptr) const { return get() == ptr; }
+        bool operator!=(const Buffer* const ptr) const { return get() != ptr; }
+
+        /*! Sets the largest capacity to be pooled, should be set to cover
+         *  the maximum message size. 0 disables pooling. */
+        static void pool_configure(size_t max_size);
+
+        /*! @param allocs number of buffers allocated from heap
+         *  @param reuses number of buffers taken from the pool */
+        static void pool_stats(long long& allocs, long long& reuses);
+
+    private:
+
+        struct Ref
+        {
+            Ref() : buf_(), refs_(1), next_(0) { }
+
+            Buffer       buf_;
+            Atomic<long> refs_;
+            Ref*         next_; // free list link
+
+        private:
+
+            Ref(const Ref&);
+            Ref& operator=(const Ref&);
+        };
+
+        static Ref* acquire(size_t size);
+        static void release(Ref* ref);
+
+        static void unref(Ref* const ref)
+        {
+            if (0 == ref->refs_.sub_and_fetch(1)) release(ref);
+        }
+
+        Ref* ref_;
+    };
 }
 
 #endif // GU_BUFFER_HPP
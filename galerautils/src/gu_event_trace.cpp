@@ -0,0 +1,208 @@
+/*
+ * Copyright (C) 2017 Codership Oy <info@codership.com>
+ */
+
+#include "gu_event_trace.hpp"
+#include "gu_atomic.h"
+#include "gu_macros.h"
+#include "gu_throw.hpp"
+#include "gu_logger.hpp"
+
+#include <pthread.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <new>
+
+char const     gu::EventTrace::MAGIC[8] = { 'G','U','T','R','A','C','E','\0' };
+uint32_t const gu::EventTrace::VERSION;
+size_t const   gu::EventTrace::RING_LEN;
+bool           gu::EventTrace::enabled_(false);
+
+namespace
+{
+    struct Ring
+    {
+        gu::EventTrace::Record rec_[gu::EventTrace::RING_LEN];
+        uint64_t pos_;    // number of records ever written
+        uint32_t thread_;
+        bool     in_use_;
+        Ring*    next_;
+    };
+
+    pthread_once_t  ring_once  = PTHREAD_ONCE_INIT;
+    pthread_key_t   ring_key;
+    pthread_mutex_t ring_mtx   = PTHREAD_MUTEX_INITIALIZER;
+    Ring*           ring_list  = 0;
+    uint32_t        ring_thds  = 0;
+
+    /* ring is not freed on thread exit, it is handed over to the next new
+     * thread, so that the trace of exited threads is still available and
+     * the number of rings does not grow with thread churn */
+    void ring_release(void* const arg)
+    {
+        Ring* const r(static_cast<Ring*>(arg));
+        pthread_mutex_lock(&ring_mtx);
+        r->in_use_ = false;
+        pthread_mutex_unlock(&ring_mtx);
+    }
+
+    bool ring_key_created(false);
+
+    void ring_key_create()
+    {
+        ring_key_created = (0 == pthread_key_create(&ring_key, ring_release));
+    }
+
+    /* tracing shuts down with the library: the key is deleted on unload so
+     * that threads which outlive it don't call ring_release() from unmapped
+     * code on exit. Rings are left alone, some threads may still hold them */
+    struct RingKeyGuard
+    {
+        ~RingKeyGuard()
+        {
+            gu::EventTrace::enable(false);
+            if (ring_key_created) pthread_key_delete(ring_key);
+        }
+    }
+        ring_key_guard;
+
+    Ring* ring_acquire()
+    {
+        Ring* r;
+
+        pthread_mutex_lock(&ring_mtx);
+
+        for (r = ring_list; r != 0 && r->in_use_; r = r->next_) {}
+
+        if (0 == r)
+        {
+            r = new (std::nothrow) Ring();
+
+            if (r)
+            {
+                r->next_  = ring_list;
+                ring_list = r;
+            }
+        }
+
+        if (r)
+        {
+            r->in_use_ = true;
+            r->thread_ = ++ring_thds;
+        }
+
+        pthread_mutex_unlock(&ring_mtx);
+
+        if (r) pthread_setspecific(ring_key, r);
+
+        return r;
+    }
+
+    inline Ring* ring_get()
+    {
+        pthread_once(&ring_once, ring_key_create);
+
+        if (gu_unlikely(!ring_key_created)) return 0;
+
+        Ring* const r(static_cast<Ring*>(pthread_getspecific(ring_key)));
+
+        return (gu_likely(r != 0) ? r : ring_acquire());
+    }
+}
+
+void
+gu::EventTrace::write(Event const     ev,
+                      int64_t const   seqno,
+                      int64_t const   id,
+                      long long const duration,
+                      long long const tstamp)
+{
+    Ring* const r(ring_get());
+
+    if (gu_unlikely(0 == r)) return;
+
+    uint64_t const pos(r->pos_); // only this thread modifies it
+    Record& rec(r->rec_[pos & (RING_LEN - 1)]);
+
+    rec.tstamp_   = tstamp;
+    rec.seqno_    = seqno;
+    rec.id_       = id;
+    rec.duration_ = duration;
+    rec.event_    = ev;
+    rec.thread_   = r->thread_;
+
+    // plain store: full barrier would double the cost of the record and
+    // the dumper tolerates stale position anyway
+    r->pos_ = pos + 1;
+}
+
+void
+gu::EventTrace::dump(const std::string& file)
+{
+    FILE* const f(fopen(file.c_str(), "w"));
+
+    if (!f)
+    {
+        gu_throw_error(errno) << "Failed to open trace dump file '"
+                              << file << "'";
+    }
+
+    FileHeader hdr;
+    std::copy(MAGIC, MAGIC + sizeof(MAGIC), hdr.magic_);
+    hdr.version_  = VERSION;
+    hdr.rec_size_ = sizeof(Record);
+
+    bool   ok(fwrite(&hdr, sizeof(hdr), 1, f) == 1);
+    size_t total(0);
+
+    pthread_mutex_lock(&ring_mtx);
+
+    for (Ring* r(ring_list); ok && r != 0; r = r->next_)
+    {
+        uint64_t pos;
+        gu_atomic_get(&r->pos_, &pos);
+
+        // the oldest records may be overwritten while being copied, this is
+        // harmless since the decoder orders records by timestamp
+        uint64_t const n(pos < RING_LEN ? pos : RING_LEN);
+
+        for (uint64_t i(pos - n); ok && i < pos; ++i)
+        {
+            ok = (fwrite(&r->rec_[i & (RING_LEN - 1)], sizeof(Record), 1, f)
+                  == 1);
+        }
+
+        total += n;
+    }
+
+    pthread_mutex_unlock(&ring_mtx);
+
+    int const err(ok ? 0 : errno);
+
+    if (fclose(f) || !ok)
+    {
+        gu_throw_error(err ? err : errno) << "Failed to write trace dump '"
+                                          << file << "'";
+    }
+
+    log_info << "Dumped " << total << " trace records to '" << file << "'";
+}
+
+const char*
+gu::EventTrace::event_name(uint32_t const ev)
+{
+    static const char* const names[EV_MAX] =
+    {
+        "MONITOR_ENTER",
+        "MONITOR_LEAVE",
+        "CERT_TEST",
+        "CORE_SEND",
+        "CORE_RECV",
+        "EVS_DELIVER",
+        "GCACHE_MALLOC"
+    };
+
+    return (ev < EV_MAX ? names[ev] : "UNKNOWN");
+}
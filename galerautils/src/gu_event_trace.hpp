@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2017 Codership Oy <info@codership.com>
+ */
+
+/*!
+ * @file gu_event_trace.hpp
+ *
+ * Always compiled in binary event trace (flight recorder).
+ *
+ * Every thread writes fixed size records into its own ring buffer, so
+ * recording takes no locks and costs one timestamp plus a few stores.
+ * Tracing is off by default, then start() and record() cost one load and
+ * one branch.
+ * Rings of all threads can be dumped into a file at any moment with
+ * EventTrace::dump() and decoded offline with gu_trace_decode.
+ */
+
+#ifndef _gu_event_trace_hpp_
+#define _gu_event_trace_hpp_
+
+#include "gu_time.h"
+#include "gu_macros.h"
+
+#include <stdint.h>
+#include <string>
+
+namespace gu
+{
+    class EventTrace
+    {
+    public:
+
+        /* values are stored in dump files, append new ones at the end */
+        enum Event
+        {
+            EV_MONITOR_ENTER = 0, // seqno, monitor address, wait time
+            EV_MONITOR_LEAVE,     // seqno, monitor address, time in leave()
+            EV_CERT_TEST,         // seqno, trx id, test time
+            EV_CORE_SEND,         // -1, action size, send time
+            EV_CORE_RECV,         // seqno, action type, 0
+            EV_EVS_DELIVER,       // message seqno, source index, deliver time
+            EV_GCACHE_MALLOC,     // -1, buffer size, allocation time
+            EV_MAX
+        };
+
+        struct Record
+        {
+            int64_t  tstamp_;   // monotonic time of record, ns
+            int64_t  seqno_;
+            int64_t  id_;
+            int64_t  duration_; // ns
+            uint32_t event_;
+            uint32_t thread_;   // thread number in this trace
+        };
+
+        struct FileHeader
+        {
+            char     magic_[8];
+            uint32_t version_;
+            uint32_t rec_size_;
+        };
+
+        static char const     MAGIC[8];
+        static uint32_t const VERSION  = 1;
+        static size_t const   RING_LEN = 1 << 10; // records per thread
+
+        /*! turns recording on or off, rings are kept */
+        static void enable(bool const on) { enabled_ = on; }
+
+        static bool enabled() { return enabled_; }
+
+        /*! @return start time for record(), 0 if tracing is disabled */
+        static long long start()
+        {
+            return gu_likely(!enabled_) ? 0 : gu_time_monotonic();
+        }
+
+        /*! records event with duration since start (EventTrace::start()) */
+        static void record(Event const   ev,
+                           int64_t const seqno,
+                           int64_t const id,
+                           long long const start)
+        {
+            if (gu_likely(!enabled_)) return;
+            long long const now(gu_time_monotonic());
+            // start is 0 if tracing got enabled in between
+            write(ev, seqno, id, start ? now - start : 0, now);
+        }
+
+        /*! records event without duration */
+        static void record(Event const ev, int64_t const seqno,
+                           int64_t const id)
+        {
+            if (gu_likely(!enabled_)) return;
+            write(ev, seqno, id, 0, gu_time_monotonic());
+        }
+
+        /*! writes contents of all rings to file
+         *  @throws gu::Exception if file can't be written */
+        static void dump(const std::string& file);
+
+        static const char* event_name(uint32_t ev);
+
+    private:
+
+        // read without synchronization on the fast path
+        static bool enabled_;
+
+        static void write(Event ev, int64_t seqno, int64_t id,
+                          long long duration, long long tstamp);
+    };
+}
+
+#endif // _gu_event_trace_hpp_
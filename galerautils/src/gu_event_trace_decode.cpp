@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2017 Codership Oy <info@codership.com>
+ */
+
+/*!
+ * @file gu_event_trace_decode.cpp
+ *
+ * Offline decoder for dumps produced by gu::EventTrace::dump()
+ * (debug.trace_dump provider parameter).
+ *
+ * Usage: gu_trace_decode <dump file>
+ *
+ * Prints one record per line ordered by time:
+ * <time, ns> <thread> <event> <seqno> <id> <duration, ns>
+ * Time is relative to the first record in the dump.
+ */
+
+#include "gu_event_trace.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+typedef gu::EventTrace::Record Record;
+
+static bool rec_less(const Record& a, const Record& b)
+{
+    return a.tstamp_ < b.tstamp_;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s <dump file>\n", argv[0]);
+        return 1;
+    }
+
+    FILE* const f(fopen(argv[1], "r"));
+
+    if (!f)
+    {
+        fprintf(stderr, "Failed to open '%s': %s\n", argv[1], strerror(errno));
+        return 1;
+    }
+
+    gu::EventTrace::FileHeader hdr;
+
+    if (fread(&hdr, sizeof(hdr), 1, f) != 1 ||
+        memcmp(hdr.magic_, gu::EventTrace::MAGIC, sizeof(hdr.magic_)))
+    {
+        fprintf(stderr, "'%s' is not a trace dump\n", argv[1]);
+        fclose(f);
+        return 1;
+    }
+
+    if (hdr.version_ != gu::EventTrace::VERSION ||
+        hdr.rec_size_ != sizeof(Record))
+    {
+        fprintf(stderr, "Unsupported trace dump version %u (record size %u), "
+                "expected %u (%lu)\n", hdr.version_, hdr.rec_size_,
+                gu::EventTrace::VERSION,
+                static_cast<unsigned long>(sizeof(Record)));
+        fclose(f);
+        return 1;
+    }
+
+    std::vector<Record> recs;
+    Record rec;
+
+    while (fread(&rec, sizeof(rec), 1, f) == 1)
+    {
+        // skip records torn by concurrent writes during dump
+        if (rec.tstamp_ > 0 && rec.event_ < gu::EventTrace::EV_MAX)
+        {
+            recs.push_back(rec);
+        }
+    }
+
+    fclose(f);
+
+    std::sort(recs.begin(), recs.end(), rec_less);
+
+    int64_t const base(recs.empty() ? 0 : recs.front().tstamp_);
+
+    for (std::vector<Record>::const_iterator i(recs.begin());
+         i != recs.end(); ++i)
+    {
+        printf("%12lld %4u %-14s %12lld %16lld %10lld\n",
+               static_cast<long long>(i->tstamp_ - base),
+               i->thread_,
+               gu::EventTrace::event_name(i->event_),
+               static_cast<long long>(i->seqno_),
+               static_cast<long long>(i->id_),
+               static_cast<long long>(i->duration_));
+    }
+
+    return 0;
+}
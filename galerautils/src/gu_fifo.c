@@ -54,6 +54,7 @@ struct gu_fifo
 #endif
 
     gu_mutex_t   lock;
+    gu_lock_prof_t prof;
     gu_cond_t    get_cond;
     gu_cond_t    put_cond;
 
@@ -138,6 +139,7 @@ gu_fifo_t *gu_fifo_create (size_t length, size_t item_size)
             ret->row_size    = row_size;
             ret->alloc       = alloc_size;
             gu_mutex_init (&ret->lock, NULL);
+            gu_lock_prof_init (&ret->prof, "gu_fifo");
             gu_cond_init  (&ret->get_cond, NULL);
             gu_cond_init  (&ret->put_cond, NULL);
         }
@@ -151,20 +153,20 @@ gu_fifo_t *gu_fifo_create (size_t length, size_t item_size)
 
 // defined as macro for proper line reporting
 #ifdef NDEBUG
-#define fifo_lock(q)                                    \
-    if (gu_likely (0 == gu_mutex_lock (&q->lock))) {}   \
-    else {                                              \
-        gu_fatal ("Failed to lock queue");              \
-        abort();                                        \
+#define fifo_lock(q)                                                  \
+    if (gu_likely (0 == gu_mutex_lock_prof (&q->lock, &q->prof))) {}  \
+    else {                                                            \
+        gu_fatal ("Failed to lock queue");                            \
+        abort();                                                      \
     }
 #else  /* NDEBUG */
-#define fifo_lock(q)                                    \
-    if (gu_likely (0 == gu_mutex_lock (&q->lock))) {    \
-        q->locked = true;                               \
-    }                                                   \
-    else {                                              \
-        gu_fatal ("Failed to lock queue");              \
-        abort();                                        \
+#define fifo_lock(q)                                                  \
+    if (gu_likely (0 == gu_mutex_lock_prof (&q->lock, &q->prof))) {   \
+        q->locked = true;                                             \
+    }                                                                 \
+    else {                                                            \
+        gu_fatal ("Failed to lock queue");                            \
+        abort();                                                      \
     }
 #endif /* NDEBUG */
 
@@ -174,7 +176,7 @@ fifo_unlock (gu_fifo_t* q)
 #ifndef NDEBUG
     q->locked = false;
 #endif
-    return -gu_mutex_unlock (&q->lock);
+    return -gu_mutex_unlock_prof (&q->lock, &q->prof);
 }
 
 #ifndef NDEBUG
@@ -205,7 +207,7 @@ static int fifo_flush (gu_fifo_t* q)
         /* will make getters to signal every time item is removed */
         gu_warn ("Waiting for %lu items to be fetched.", q->used);
         q->put_wait++;
-        ret = gu_cond_wait (&q->put_cond, &q->lock);
+        ret = gu_cond_wait_prof (&q->put_cond, &q->lock, &q->prof);
     }
 
     return ret;
@@ -258,7 +260,7 @@ static inline int fifo_lock_get (gu_fifo_t *q)
 #ifndef NDEBUG
         q->locked = false;
 #endif
-        ret = -gu_cond_wait (&q->get_cond, &q->lock);
+        ret = -gu_cond_wait_prof (&q->get_cond, &q->lock, &q->prof);
 #ifndef NDEBUG
         q->locked = true;
 #endif
@@ -291,7 +293,7 @@ static inline int fifo_lock_put (gu_fifo_t *q)
         q->locked = false;
 #endif
         q->put_wait++;
-        ret = -gu_cond_wait (&q->put_cond, &q->lock);
+        ret = -gu_cond_wait_prof (&q->put_cond, &q->lock, &q->prof);
 #ifndef NDEBUG
         q->locked = true;
 #endif
@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) 2017 Codership Oy <info@codership.com>
+ */
+
+#include "gu_latency_histogram.hpp"
+#include "gu_macros.h"
+
+#include <pthread.h>
+#include <stdint.h>
+
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+bool gu::LatencyHistogram::enabled_(false);
+
+static pthread_once_t gu_lat_hist_once = PTHREAD_ONCE_INIT;
+static pthread_key_t  gu_lat_hist_key;
+static int            gu_lat_hist_next(0);
+
+static void gu_lat_hist_key_create()
+{
+    pthread_key_create(&gu_lat_hist_key, NULL);
+}
+
+/* Assigns shards to threads round-robin on first use, so that threads
+ * created one after another do not share counters. */
+int
+gu::LatencyHistogram::shard_idx()
+{
+    pthread_once(&gu_lat_hist_once, gu_lat_hist_key_create);
+
+    intptr_t idx(reinterpret_cast<intptr_t>(
+                     pthread_getspecific(gu_lat_hist_key)));
+
+    if (gu_unlikely(0 == idx))
+    {
+        idx = gu_atomic_add_and_fetch(&gu_lat_hist_next, 1);
+        pthread_setspecific(gu_lat_hist_key, reinterpret_cast<void*>(idx));
+    }
+
+    return (idx - 1) % SHARDS;
+}
+
+gu::LatencyHistogram::LatencyHistogram()
+{
+    ::memset(shards_, 0, sizeof(shards_));
+}
+
+void
+gu::LatencyHistogram::merge(long long* const cnt, long long& total) const
+{
+    total = 0;
+
+    for (int b(0); b < BUCKETS; ++b)
+    {
+        cnt[b] = 0;
+
+        for (int s(0); s < SHARDS; ++s)
+        {
+            long long c;
+            gu_atomic_get(&shards_[s].cnt_[b], &c);
+            cnt[b] += c;
+        }
+
+        total += cnt[b];
+    }
+}
+
+long long
+gu::LatencyHistogram::percentile(double const p) const
+{
+    long long cnt[BUCKETS];
+    long long total;
+
+    merge(cnt, total);
+
+    if (0 == total) return 0;
+
+    long long rank(std::ceil(p * total));
+    if (rank < 1)     rank = 1;
+    if (rank > total) rank = total;
+
+    long long sum(0);
+
+    for (int b(0); b < BUCKETS; ++b)
+    {
+        sum += cnt[b];
+
+        if (sum >= rank)
+        {
+            // report the middle of the bucket
+            return (bucket_min(b) + bucket_min(b + 1) - 1) / 2;
+        }
+    }
+
+    return bucket_min(BUCKETS - 1);
+}
+
+long long
+gu::LatencyHistogram::count() const
+{
+    long long cnt[BUCKETS];
+    long long total;
+
+    merge(cnt, total);
+
+    return total;
+}
+
+double
+gu::LatencyHistogram::mean() const
+{
+    long long cnt[BUCKETS];
+    long long total;
+
+    merge(cnt, total);
+
+    if (0 == total) return 0.0;
+
+    long long sum(0);
+
+    for (int s(0); s < SHARDS; ++s)
+    {
+        long long v;
+        gu_atomic_get(&shards_[s].sum_, &v);
+        sum += v;
+    }
+
+    return double(sum)/total;
+}
+
+void
+gu::LatencyHistogram::clear()
+{
+    long long const zero(0);
+
+    for (int s(0); s < SHARDS; ++s)
+    {
+        for (int b(0); b < BUCKETS; ++b)
+        {
+            gu_atomic_set(&shards_[s].cnt_[b], &zero);
+        }
+
+        gu_atomic_set(&shards_[s].sum_, &zero);
+    }
+}
+
+std::string
+gu::LatencyHistogram::to_string() const
+{
+    static double const pcts[] = { 0.5, 0.9, 0.99, 0.999, 1.0 };
+
+    std::ostringstream os;
+    os << std::fixed << std::setprecision(6);
+
+    for (size_t i(0); i < sizeof(pcts)/sizeof(pcts[0]); ++i)
+    {
+        os << double(percentile(pcts[i]))*1.0e-9 << '/';
+    }
+
+    os << count();
+
+    return os.str();
+}
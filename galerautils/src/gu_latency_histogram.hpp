@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2017 Codership Oy <info@codership.com>
+ */
+
+/*!
+ * @file gu_latency_histogram.hpp
+ *
+ * Log-linear (HDR-style) latency histogram for hot code paths.
+ *
+ * Values are nanoseconds. Each power of two range is divided into SUB_BUCKETS
+ * linear buckets, so relative error of reported values does not exceed
+ * 1/SUB_BUCKETS. Recording is lock-free: threads are spread round-robin over
+ * a fixed number of shards and increment counters atomically, shards are
+ * merged only when percentiles are requested.
+ *
+ * Sampling is off by default, start()/record_since() don't read the clock
+ * until it is turned on with enable().
+ */
+
+#ifndef _gu_latency_histogram_hpp_
+#define _gu_latency_histogram_hpp_
+
+#include "gu_atomic.h"
+#include "gu_macros.h"
+#include "gu_time.h"
+
+#include <string>
+
+namespace gu
+{
+    class LatencyHistogram
+    {
+    public:
+
+        static int const SUB_BITS    = 4;
+        static int const SUB_BUCKETS = 1 << SUB_BITS;
+        static int const MAX_BITS    = 40;  // ~18 minutes, larger go to last
+        static int const BUCKETS     = (MAX_BITS - SUB_BITS + 2) * SUB_BUCKETS;
+        static int const SHARDS      = 16;
+
+        LatencyHistogram();
+
+        /*! turns sampling on or off, recorded values are kept */
+        static void enable(bool const on) { enabled_ = on; }
+
+        static bool enabled() { return enabled_; }
+
+        /*! @return start time for record_since(), 0 if sampling is disabled */
+        static long long start()
+        {
+            return gu_likely(!enabled_) ? 0 : gu_time_monotonic();
+        }
+
+        /*! records time elapsed since start (LatencyHistogram::start()) */
+        void record_since(long long const start)
+        {
+            // start is 0 if sampling got enabled in between
+            if (gu_likely(!enabled_) || 0 == start) return;
+            record(gu_time_monotonic() - start);
+        }
+
+        /*! records a value in nanoseconds, negative values are ignored */
+        void record(long long const ns)
+        {
+            if (ns < 0) return;
+
+            Shard& s(shards_[shard_idx()]);
+            gu_atomic_fetch_and_add(&s.cnt_[bucket(ns)], 1);
+            gu_atomic_fetch_and_add(&s.sum_, ns);
+        }
+
+        /*! @return value (ns) below which fraction p of recorded values lie */
+        long long percentile(double p) const;
+
+        long long count() const;
+
+        /*! @return mean value in nanoseconds */
+        double    mean() const;
+
+        void clear();
+
+        /*! "p50/p90/p99/p99.9/max/count", values in seconds */
+        std::string to_string() const;
+
+        /*! @return bucket index for value */
+        static int bucket(long long const ns)
+        {
+            if (ns < 2*SUB_BUCKETS) return static_cast<int>(ns);
+
+            int const shift(msb(ns) - SUB_BITS);
+
+            if (shift > MAX_BITS - SUB_BITS) return BUCKETS - 1;
+
+            return shift * SUB_BUCKETS + static_cast<int>(ns >> shift);
+        }
+
+        /*! @return the smallest value that falls in bucket b */
+        static long long bucket_min(int const b)
+        {
+            if (b < 2*SUB_BUCKETS) return b;
+
+            int const shift(b / SUB_BUCKETS - 1);
+
+            return (static_cast<long long>(b % SUB_BUCKETS + SUB_BUCKETS)
+                    << shift);
+        }
+
+    private:
+
+        struct Shard
+        {
+            long long cnt_[BUCKETS];
+            long long sum_;
+        };
+
+        Shard shards_[SHARDS];
+
+        static bool enabled_;
+
+        static int shard_idx();
+
+        static int msb(long long const ns)
+        {
+#ifdef __GNUC__
+            return 63 - __builtin_clzll(ns);
+#else
+            int ret(0);
+            for (long long v(ns >> 1); v; v >>= 1) ++ret;
+            return ret;
+#endif
+        }
+
+        void merge(long long* cnt, long long& total) const;
+
+        LatencyHistogram(const LatencyHistogram&);
+        LatencyHistogram& operator=(const LatencyHistogram&);
+    };
+}
+
+#endif // _gu_latency_histogram_hpp_
@@ -56,7 +56,7 @@ namespace gu
         inline void wait (const Cond& cond)
         {
             cond.ref_count++;
-            gu_cond_wait (&(cond.cond), &mtx_.impl());
+            gu_cond_wait_prof (&(cond.cond), &mtx_.impl(), &mtx_.prof);
             cond.ref_count--;
         }
 
@@ -66,7 +66,8 @@ namespace gu
 
             date._timespec(ts);
             cond.ref_count++;
-            int ret = gu_cond_timedwait (&(cond.cond), &mtx_.impl(), &ts);
+            int ret = gu_cond_timedwait_prof (&(cond.cond), &mtx_.impl(), &ts,
+                                             &mtx_.prof);
             cond.ref_count--;
 
             if (gu_unlikely(ret)) gu_throw_error(ret);
@@ -0,0 +1,135 @@
+// Copyright (C) 2017 Codership Oy <info@codership.com>
+
+/**
+ * Mutex contention profiler, see gu_lock_prof.h
+ */
+
+#include "gu_lock_prof.h"
+
+#include "gu_atomic.h"
+#include "gu_mem.h"
+
+#include <errno.h>
+#include <string.h>
+
+int gu_lock_prof_rate = 0;
+
+/* site registry */
+static gu_mutex_t      sites_mtx = GU_MUTEX_INITIALIZER;
+static gu_lock_site_t* sites     = NULL;
+
+gu_lock_site_t*
+gu_lock_site (const char* const name)
+{
+    gu_lock_site_t* site;
+
+    gu_mutex_lock (&sites_mtx);
+
+    for (site = sites; site != NULL; site = site->next)
+    {
+        if (!strcmp(site->name, name)) break;
+    }
+
+    if (NULL == site)
+    {
+        site = gu_calloc (1, sizeof(gu_lock_site_t));
+
+        if (site)
+        {
+            site->name = name;
+            site->next = sites;
+            sites      = site;
+        }
+    }
+
+    gu_mutex_unlock (&sites_mtx);
+
+    return site;
+}
+
+void
+gu_lock_prof_set_rate (int const rate)
+{
+    gu_lock_site_t* site;
+
+    gu_mutex_lock (&sites_mtx);
+
+    if (0 == gu_lock_prof_rate && rate > 0)
+    {
+        for (site = sites; site != NULL; site = site->next)
+        {
+            site->calls     = 0;
+            site->sampled   = 0;
+            site->contended = 0;
+            site->wait_ns   = 0;
+            site->hold_ns   = 0;
+        }
+    }
+
+    gu_lock_prof_rate = rate > 0 ? rate : 0;
+
+    gu_mutex_unlock (&sites_mtx);
+}
+
+void
+gu_lock_prof_foreach (void (*cb)(const gu_lock_site_t*, void*), void* arg)
+{
+    gu_lock_site_t* site;
+
+    gu_mutex_lock (&sites_mtx);
+
+    for (site = sites; site != NULL; site = site->next)
+    {
+        cb (site, arg);
+    }
+
+    gu_mutex_unlock (&sites_mtx);
+}
+
+int
+gu_lock_prof_lock (gu_mutex_t* const mtx, gu_lock_prof_t* const prof)
+{
+    gu_lock_site_t* const site = prof->site;
+    int const rate = gu_lock_prof_rate;
+    long long start;
+    bool busy;
+    int ret;
+
+    if (rate <= 0 || gu_atomic_fetch_and_add(&site->calls, 1) % rate)
+    {
+        return gu_mutex_lock (mtx);
+    }
+
+    start = gu_time_monotonic();
+
+#ifndef GU_DEBUG_MUTEX
+    ret  = gu_mutex_trylock (mtx);
+    busy = (EBUSY == ret);
+    if (busy) ret = gu_mutex_lock (mtx);
+#else
+    busy = mtx->locked; /* approximate */
+    ret  = gu_mutex_lock (mtx);
+#endif
+
+    if (gu_likely(0 == ret))
+    {
+        prof->locked = gu_time_monotonic();
+
+        gu_atomic_fetch_and_add (&site->sampled, 1);
+        if (busy)
+        {
+            gu_atomic_fetch_and_add (&site->contended, 1);
+            gu_atomic_fetch_and_add (&site->wait_ns, prof->locked - start);
+        }
+    }
+
+    return ret;
+}
+
+void
+gu_lock_prof_release (gu_lock_prof_t* const prof)
+{
+    gu_atomic_fetch_and_add (&prof->site->hold_ns,
+                             gu_time_monotonic() - prof->locked);
+    prof->locked = 0;
+}
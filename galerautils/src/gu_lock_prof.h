@@ -0,0 +1,132 @@
+// Copyright (C) 2017 Codership Oy <info@codership.com>
+
+/**
+ * @file Sampling mutex contention profiler
+ *
+ * Mutexes are grouped into named lock sites. While profiling is enabled
+ * every Nth acquisition of a site is sampled: it records whether the mutex
+ * was busy, how long it took to get it and how long it was held.
+ * When profiling is disabled lock and unlock cost one extra load and branch.
+ */
+
+#ifndef _gu_lock_prof_h_
+#define _gu_lock_prof_h_
+
+#include "gu_threads.h"
+#include "gu_macros.h"
+#include "gu_time.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Statistics of a lock site. Sites are never deallocated. */
+typedef struct gu_lock_site
+{
+    const char*          name;
+    struct gu_lock_site* next;
+    long long            calls;     //!< acquisitions while profiling
+    long long            sampled;   //!< sampled acquisitions
+    long long            contended; //!< sampled acquisitions that had to wait
+    long long            wait_ns;   //!< total wait time of sampled ones
+    long long            hold_ns;   //!< total hold time of sampled ones
+}
+gu_lock_site_t;
+
+/** Profiling state of a single mutex */
+typedef struct gu_lock_prof
+{
+    gu_lock_site_t* site;
+    long long       locked; //!< time when sampled acquisition got the lock
+}
+gu_lock_prof_t;
+
+#define GU_LOCK_PROF_INITIALIZER { NULL, 0 }
+
+/** Sampling rate: 0 - profiling disabled, N - every Nth acquisition.
+ *  Read without synchronization on the fast path. */
+extern int gu_lock_prof_rate;
+
+/** @return site registered under name, name must point to static storage */
+extern gu_lock_site_t*
+gu_lock_site (const char* name);
+
+/** Sets sampling rate, statistics are reset when profiling gets enabled */
+extern void
+gu_lock_prof_set_rate (int rate);
+
+/** Calls cb for every registered site */
+extern void
+gu_lock_prof_foreach (void (*cb)(const gu_lock_site_t* site, void* arg),
+                      void* arg);
+
+static inline void
+gu_lock_prof_init (gu_lock_prof_t* prof, const char* name)
+{
+    prof->site   = name ? gu_lock_site(name) : NULL;
+    prof->locked = 0;
+}
+
+/* slow paths */
+extern int
+gu_lock_prof_lock (gu_mutex_t* mtx, gu_lock_prof_t* prof);
+extern void
+gu_lock_prof_release (gu_lock_prof_t* prof);
+
+static inline int
+gu_mutex_lock_prof (gu_mutex_t* mtx, gu_lock_prof_t* prof)
+{
+    if (gu_likely(0 == gu_lock_prof_rate || NULL == prof->site))
+    {
+        return gu_mutex_lock(mtx);
+    }
+
+    return gu_lock_prof_lock(mtx, prof);
+}
+
+static inline int
+gu_mutex_unlock_prof (gu_mutex_t* mtx, gu_lock_prof_t* prof)
+{
+    if (gu_unlikely(prof->locked)) gu_lock_prof_release(prof);
+
+    return gu_mutex_unlock(mtx);
+}
+
+/* Time spent waiting on a condition does not count as hold time. */
+
+static inline int
+gu_cond_wait_prof (gu_cond_t* cond, gu_mutex_t* mtx, gu_lock_prof_t* prof)
+{
+    if (gu_unlikely(prof->locked))
+    {
+        int ret;
+        gu_lock_prof_release(prof);
+        ret = gu_cond_wait(cond, mtx);
+        prof->locked = gu_time_monotonic();
+        return ret;
+    }
+
+    return gu_cond_wait(cond, mtx);
+}
+
+static inline int
+gu_cond_timedwait_prof (gu_cond_t* cond, gu_mutex_t* mtx,
+                        const struct timespec* ts, gu_lock_prof_t* prof)
+{
+    if (gu_unlikely(prof->locked))
+    {
+        int ret;
+        gu_lock_prof_release(prof);
+        ret = gu_cond_timedwait(cond, mtx, ts);
+        prof->locked = gu_time_monotonic();
+        return ret;
+    }
+
+    return gu_cond_timedwait(cond, mtx, ts);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _gu_lock_prof_h_ */
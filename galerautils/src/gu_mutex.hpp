@@ -8,6 +8,7 @@
 
 #include "gu_macros.h"
 #include "gu_threads.h"
+#include "gu_lock_prof.h"
 #include "gu_throw.hpp"
 
 #include <cerrno>
@@ -19,9 +20,12 @@ namespace gu
     {
     public:
 
-        Mutex () : value()
+        /*! @param name lock site name for contention profiling,
+         *              must point to static storage */
+        explicit Mutex (const char* name = NULL) : value(), prof()
         {
             gu_mutex_init (&value, NULL); // always succeeds
+            gu_lock_prof_init (&prof, name);
         }
 
         ~Mutex ()
@@ -33,9 +37,9 @@ namespace gu
             }
         }
 
-        int lock()   const { return gu_mutex_lock(&value); }
+        int lock()   const { return gu_mutex_lock_prof(&value, &prof); }
 
-        int unlock() const { return gu_mutex_unlock(&value); }
+        int unlock() const { return gu_mutex_unlock_prof(&value, &prof); }
 
         gu_mutex_t& impl() const { return value; }
 
@@ -47,6 +51,7 @@ namespace gu
     protected:
 
         gu_mutex_t mutable value;
+        gu_lock_prof_t mutable prof;
 
     private:
 
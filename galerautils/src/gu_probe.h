@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2017 Codership Oy <info@codership.com>
+ */
+
+/*!
+ * @file gu_probe.h
+ *
+ * SystemTap/USDT static probe points.
+ *
+ * Probes are compiled in only when building with sdt=1 (GU_USE_SDT defined),
+ * otherwise the macros expand to nothing. A compiled in probe costs a single
+ * nop instruction until a tracer (perf, bpftrace, stap) attaches to it.
+ * Arguments must be integers or pointers.
+ *
+ * Probe reference list is maintained in docs/probes.txt, update it when
+ * adding probes.
+ */
+
+#ifndef _gu_probe_h_
+#define _gu_probe_h_
+
+#ifdef GU_USE_SDT
+
+#include <sys/sdt.h>
+
+#define GU_PROBE0(provider, name) \
+    DTRACE_PROBE(provider, name)
+#define GU_PROBE1(provider, name, a1) \
+    DTRACE_PROBE1(provider, name, a1)
+#define GU_PROBE2(provider, name, a1, a2) \
+    DTRACE_PROBE2(provider, name, a1, a2)
+#define GU_PROBE3(provider, name, a1, a2, a3) \
+    DTRACE_PROBE3(provider, name, a1, a2, a3)
+
+#else
+
+#define GU_PROBE0(provider, name)
+#define GU_PROBE1(provider, name, a1)
+#define GU_PROBE2(provider, name, a1, a2)
+#define GU_PROBE3(provider, name, a1, a2, a3)
+
+#endif /* GU_USE_SDT */
+
+#endif /* _gu_probe_h_ */
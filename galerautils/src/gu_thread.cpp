@@ -1,5 +1,5 @@
 //
-// Copyright (C) 2016 Codership Oy <info@codership.com>
+// Copyright (C) 2016-2017 Codership Oy <info@codership.com>
 //
 
 #include "gu_thread.hpp"
@@ -7,9 +7,20 @@
 #include "gu_utils.hpp"
 #include "gu_string_utils.hpp"
 #include "gu_throw.hpp"
+#include "gu_config.hpp"
+#include "gu_status.hpp"
+#include "gu_logger.hpp"
+#include "gu_atomic.h"
+
+#if defined(__FreeBSD__)
+#include <pthread_np.h>
+#endif
 
 #include <iostream>
+#include <sstream>
 #include <vector>
+#include <cstring>
+#include <cassert>
 
 static std::string const SCHED_OTHER_STR  ("other");
 static std::string const SCHED_FIFO_STR   ("fifo");
@@ -91,3 +102,364 @@ void gu::thread_set_schedparam(pthread_t thd, const gu::ThreadSchedparam& sp)
         gu_throw_error(err) << "Failed to set thread schedparams " << sp;
     }
 }
+
+//
+// Thread registry
+//
+
+namespace
+{
+    struct ThreadClass
+    {
+        const char* name; // also thread name, must fit in 15 characters
+        std::string affinity;
+        std::string sched;
+        int         configured; // parameters set, can be read without lock
+    };
+
+    ThreadClass thread_classes[] =
+    {
+        { "gcomm",          "", "", 0 },
+        { "gcs_recv",       "", "", 0 },
+        { "service",        "", "", 0 },
+        { "ist_recv",       "", "", 0 },
+        { "ist_send",       "", "", 0 },
+        { "ws_check",       "", "", 0 },
+        { "async_commit",   "", "", 0 },
+        { "stats",          "", "", 0 },
+        { "state_writer",   "", "", 0 },
+        { "gcache_janitor", "", "", 0 },
+        { "gcache_recover", "", "", 0 }
+    };
+
+    size_t const THREAD_CLASSES_NUM(sizeof(thread_classes) /
+                                    sizeof(thread_classes[0]));
+
+    struct RunningThread
+    {
+        RunningThread(gu_thread_t const t, const char* const c)
+            :
+            thd       (t),
+            cls       (c),
+            orig_sched()
+#if defined(__linux__)
+            ,orig_cpus()
+#endif
+        { }
+
+        gu_thread_t          thd;
+        const char*          cls;
+        gu::ThreadSchedparam orig_sched;
+#if defined(__linux__)
+        cpu_set_t            orig_cpus;
+#endif
+    };
+
+    // protects thread_classes and running_threads
+    gu_mutex_t                 registry_mtx = GU_MUTEX_INITIALIZER;
+    std::vector<RunningThread> running_threads;
+
+    std::string const THREAD_PREFIX   ("thread.");
+    std::string const AFFINITY_SUFFIX (".affinity");
+    std::string const SCHED_SUFFIX    (".sched");
+
+    ThreadClass* find_thread_class(const std::string& name)
+    {
+        for (size_t i(0); i < THREAD_CLASSES_NUM; ++i)
+        {
+            if (name == thread_classes[i].name) return &thread_classes[i];
+        }
+        return 0;
+    }
+
+    // parses CPU list like "0-3,8"
+    std::vector<int> parse_affinity(const std::string& affinity)
+    {
+        std::vector<int> ret;
+        std::vector<std::string> const ranges(gu::strsplit(affinity, ','));
+
+        for (size_t i(0); i < ranges.size(); ++i)
+        {
+            std::vector<std::string> const r(gu::strsplit(ranges[i], '-'));
+
+            int first, last;
+
+            try
+            {
+                if (r.size() < 1 || r.size() > 2) throw gu::NotFound();
+                first = gu::from_string<int>(r[0]);
+                last  = r.size() == 2 ? gu::from_string<int>(r[1]) : first;
+            }
+            catch (gu::NotFound&)
+            {
+                gu_throw_error(EINVAL) << "Invalid CPU list: '" << affinity
+                                       << "'";
+            }
+
+            if (first < 0 || last < first)
+            {
+                gu_throw_error(EINVAL) << "Invalid CPU range: '" << ranges[i]
+                                       << "'";
+            }
+
+            for (int cpu(first); cpu <= last; ++cpu) ret.push_back(cpu);
+        }
+
+        return ret;
+    }
+
+    void apply_affinity(const RunningThread& t, const std::string& affinity)
+    {
+#if defined(__linux__)
+        cpu_set_t cpus;
+
+        if (affinity.empty())
+        {
+            cpus = t.orig_cpus;
+        }
+        else
+        {
+            std::vector<int> const list(parse_affinity(affinity));
+            CPU_ZERO(&cpus);
+            for (size_t i(0); i < list.size(); ++i)
+            {
+                if (list[i] < CPU_SETSIZE) CPU_SET(list[i], &cpus);
+            }
+        }
+
+        int const err(pthread_setaffinity_np(t.thd, sizeof(cpus), &cpus));
+        if (err)
+        {
+            log_warn << "Failed to set CPU affinity '" << affinity
+                     << "' for " << t.cls << " thread: " << err << " ("
+                     << ::strerror(err) << ")";
+        }
+#else
+        if (!affinity.empty())
+        {
+            log_warn << "CPU affinity is not supported on this platform, "
+                     << "ignoring it for " << t.cls << " thread";
+        }
+#endif /* __linux__ */
+    }
+
+    void apply_sched(const RunningThread& t, const std::string& sched)
+    {
+        try
+        {
+            gu::thread_set_schedparam(t.thd, sched.empty() ?
+                                      t.orig_sched :
+                                      gu::ThreadSchedparam(sched));
+        }
+        catch (gu::Exception& e)
+        {
+            log_warn << "Failed to set scheduling parameters '" << sched
+                     << "' for " << t.cls << " thread: " << e.what();
+        }
+    }
+
+    void set_thread_name(const char* const name)
+    {
+#if defined(__linux__)
+        pthread_setname_np(pthread_self(), name);
+#elif defined(__FreeBSD__)
+        pthread_set_name_np(pthread_self(), name);
+#elif defined(__APPLE__)
+        pthread_setname_np(name);
+#endif
+    }
+
+    class RegistryLock
+    {
+    public:
+        RegistryLock()  { gu_mutex_lock(&registry_mtx);   }
+        ~RegistryLock() { gu_mutex_unlock(&registry_mtx); }
+    private:
+        RegistryLock(const RegistryLock&);
+        RegistryLock& operator=(const RegistryLock&);
+    };
+}
+
+static bool thread_class_configured(const char* const cls)
+{
+    // class names are constant, no need to lock the registry
+    ThreadClass* const tc(find_thread_class(cls));
+    assert(tc);
+
+    int configured(0);
+    if (tc) gu_atomic_get(&tc->configured, &configured);
+
+    return configured;
+}
+
+gu::RegisteredThread::RegisteredThread(const char* const cls,
+                                       bool const        if_configured)
+    :
+    cls_(cls),
+    thd_(gu_thread_self()),
+    registered_(!if_configured || thread_class_configured(cls))
+{
+    if (!registered_) return;
+
+    set_thread_name(cls_);
+
+    RunningThread t(thd_, cls_);
+
+    try
+    {
+        t.orig_sched = thread_get_schedparam(thd_);
+    }
+    catch (gu::Exception&)
+    {
+        t.orig_sched = ThreadSchedparam::system_default;
+    }
+#if defined(__linux__)
+    if (pthread_getaffinity_np(thd_, sizeof(t.orig_cpus), &t.orig_cpus))
+    {
+        CPU_ZERO(&t.orig_cpus);
+        for (int cpu(0); cpu < CPU_SETSIZE; ++cpu) CPU_SET(cpu, &t.orig_cpus);
+    }
+#endif
+
+    RegistryLock lock;
+
+    const ThreadClass* const tc(find_thread_class(cls_));
+    assert(tc);
+
+    if (tc)
+    {
+        if (!tc->affinity.empty()) apply_affinity(t, tc->affinity);
+        if (!tc->sched.empty())    apply_sched(t, tc->sched);
+    }
+
+    running_threads.push_back(t);
+}
+
+gu::RegisteredThread::~RegisteredThread()
+{
+    if (!registered_) return;
+
+    RegistryLock lock;
+
+    for (std::vector<RunningThread>::iterator i(running_threads.begin());
+         i != running_threads.end(); ++i)
+    {
+        if (gu_thread_equal(i->thd, thd_))
+        {
+            running_threads.erase(i);
+            break;
+        }
+    }
+}
+
+void gu::thread_register_params(gu::Config& conf)
+{
+    for (size_t i(0); i < THREAD_CLASSES_NUM; ++i)
+    {
+        std::string const prefix(THREAD_PREFIX + thread_classes[i].name);
+        conf.add(prefix + AFFINITY_SUFFIX, "");
+        conf.add(prefix + SCHED_SUFFIX, "");
+    }
+}
+
+void gu::thread_configure(const gu::Config& conf)
+{
+    for (size_t i(0); i < THREAD_CLASSES_NUM; ++i)
+    {
+        std::string const prefix(THREAD_PREFIX + thread_classes[i].name);
+        std::string const affinity_key(prefix + AFFINITY_SUFFIX);
+        std::string const sched_key(prefix + SCHED_SUFFIX);
+
+        try
+        {
+            thread_param_set(affinity_key, conf.get(affinity_key));
+        }
+        catch (gu::NotFound&) {}
+        catch (gu::NotSet&)   {}
+
+        try
+        {
+            thread_param_set(sched_key, conf.get(sched_key));
+        }
+        catch (gu::NotFound&) {}
+        catch (gu::NotSet&)   {}
+    }
+}
+
+void gu::thread_param_set(const std::string& key, const std::string& value)
+{
+    if (key.compare(0, THREAD_PREFIX.length(), THREAD_PREFIX)) throw NotFound();
+
+    size_t const dot(key.rfind('.'));
+    if (dot <= THREAD_PREFIX.length()) throw NotFound();
+
+    std::string const name(key, THREAD_PREFIX.length(),
+                           dot - THREAD_PREFIX.length());
+    std::string const suffix(key, dot);
+
+    bool const affinity(suffix == AFFINITY_SUFFIX);
+    if (!affinity && suffix != SCHED_SUFFIX) throw NotFound();
+
+    // validate before changing anything
+    if (!value.empty())
+    {
+        if (affinity)
+        {
+            (void)parse_affinity(value);
+        }
+        else try
+        {
+            (void)ThreadSchedparam(value);
+        }
+        catch (NotFound&)
+        {
+            gu_throw_error(EINVAL) << "Invalid schedparam: " << value;
+        }
+    }
+
+    RegistryLock lock;
+
+    ThreadClass* const tc(find_thread_class(name));
+    if (!tc) throw NotFound();
+
+    std::string& param(affinity ? tc->affinity : tc->sched);
+    if (param == value) return;
+    param = value;
+
+    int const configured(!tc->affinity.empty() || !tc->sched.empty());
+    gu_atomic_set(&tc->configured, &configured);
+
+    for (size_t i(0); i < running_threads.size(); ++i)
+    {
+        const RunningThread& t(running_threads[i]);
+        if (::strcmp(t.cls, tc->name)) continue;
+
+        if (affinity) apply_affinity(t, value);
+        else          apply_sched(t, value);
+    }
+}
+
+void gu::thread_get_status(gu::Status& status)
+{
+    RegistryLock lock;
+
+    for (size_t i(0); i < THREAD_CLASSES_NUM; ++i)
+    {
+        const ThreadClass& tc(thread_classes[i]);
+
+        size_t running(0);
+        for (size_t j(0); j < running_threads.size(); ++j)
+        {
+            if (!::strcmp(running_threads[j].cls, tc.name)) ++running;
+        }
+
+        if (0 == running && tc.affinity.empty() && tc.sched.empty()) continue;
+
+        std::ostringstream os;
+        os << running << "/"
+           << (tc.affinity.empty() ? "any"     : tc.affinity) << "/"
+           << (tc.sched.empty()    ? "default" : tc.sched);
+
+        status.insert(std::string("thread_") + tc.name, os.str());
+    }
+}
@@ -15,6 +15,9 @@
 
 namespace gu
 {
+    class Config;
+    class Status;
+
     //
     // Wrapper class for thread scheduling parameters. For details,
     // about values see sched_setscheduler() and pthread_setschedparams()
@@ -103,6 +106,69 @@ namespace gu
     {
         sp.print(os); return os;
     }
+
+    //
+    // Registry of provider threads.
+    //
+    // Every provider thread belongs to a named class. Each class has
+    // configurable CPU affinity and scheduling parameters:
+    //
+    //  thread.<class>.affinity - list of CPUs, e.g. "0-3,8", empty for any
+    //  thread.<class>.sched    - <policy>:<priority>, empty to leave as is
+    //
+    // Parameters are applied to threads as they start and to running
+    // threads when changed.
+    //
+    class RegisteredThread
+    {
+    public:
+        //
+        // Registers calling thread for the lifetime of the object: sets
+        // thread name to class name and applies class parameters.
+        // Class name must point to static storage.
+        //
+        // Short-lived threads pass if_configured = true to skip the
+        // registration cost unless some class parameter is set. Such
+        // threads don't see parameter changes made after they start.
+        //
+        explicit RegisteredThread(const char* cls, bool if_configured = false);
+
+        ~RegisteredThread();
+
+    private:
+        RegisteredThread(const RegisteredThread&);
+        RegisteredThread& operator=(const RegisteredThread&);
+
+        const char* const cls_;
+        gu_thread_t const thd_;
+        bool const        registered_;
+    };
+
+    //
+    // Add thread class parameters to configuration.
+    //
+    void thread_register_params(Config& conf);
+
+    //
+    // Apply thread class parameters from configuration.
+    //
+    // Throws gu::Exception if some value is malformed.
+    //
+    void thread_configure(const Config& conf);
+
+    //
+    // Set thread class parameter at runtime.
+    //
+    // Throws gu::NotFound if key is not a thread class parameter and
+    // gu::Exception if value is malformed.
+    //
+    void thread_param_set(const std::string& key, const std::string& value);
+
+    //
+    // Add thread_<class> entries of running thread count, affinity and
+    // scheduling parameters to status.
+    //
+    void thread_get_status(Status& status);
 }
 
 
@@ -28,6 +28,7 @@ typedef pthread_mutexattr_t   gu_mutexattr_t_SYS;
 typedef pthread_mutex_t       gu_mutex_t_SYS;
 #define gu_mutex_init_SYS     pthread_mutex_init
 #define gu_mutex_lock_SYS     pthread_mutex_lock
+#define gu_mutex_trylock_SYS  pthread_mutex_trylock
 #define gu_mutex_unlock_SYS   pthread_mutex_unlock
 #define gu_mutex_destroy_SYS  pthread_mutex_destroy
 
@@ -96,6 +97,7 @@ typedef gu_mutex_t_SYS gu_mutex_t;
 
 #define gu_mutex_init     gu_mutex_init_SYS
 #define gu_mutex_lock     gu_mutex_lock_SYS
+#define gu_mutex_trylock  gu_mutex_trylock_SYS
 #define gu_mutex_unlock   gu_mutex_unlock_SYS
 #define gu_mutex_destroy  gu_mutex_destroy_SYS
 #define gu_cond_wait      gu_cond_wait_SYS
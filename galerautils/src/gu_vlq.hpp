@@ -19,6 +19,8 @@
 
 #include "gu_macros.h"
 
+#include <cassert>
+
 #define GU_VLQ_CHECKS
 #define GU_VLQ_ALEX
 
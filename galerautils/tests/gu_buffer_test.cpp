@@ -0,0 +1,89 @@
+// Copyright (C) 2017 Codership Oy <info@codership.com>
+
+// $Id$
+
+#include "gu_buffer.hpp"
+
+#include "gu_buffer_test.hpp"
+
+START_TEST (shared_buffer_refs)
+{
+    gu::byte_t const data[] = { 1, 2, 3, 4, 5 };
+
+    gu::SharedBuffer empty;
+    fail_if(empty != 0);
+
+    gu::SharedBuffer buf(data, data + sizeof(data));
+    fail_if(buf == 0);
+    fail_if(buf->size() != sizeof(data));
+    fail_if((*buf)[4] != 5);
+
+    {
+        gu::SharedBuffer copy(buf);
+        fail_if(copy.get() != buf.get());
+        empty = copy;
+        copy = gu::SharedBuffer();
+        fail_if(copy != 0);
+    }
+
+    fail_if(empty.get() != buf.get());
+    empty = empty;
+    fail_if((*empty)[0] != 1);
+
+    gu::SharedBuffer reserved(1000);
+    fail_if(reserved->size() != 0);
+    fail_if(reserved->capacity() < 1000);
+}
+END_TEST
+
+START_TEST (shared_buffer_pool)
+{
+    gu::SharedBuffer::pool_configure(1 << 16);
+
+    long long allocs0, reuses0;
+    gu::SharedBuffer::pool_stats(allocs0, reuses0);
+
+    const gu::Buffer* ptr;
+    {
+        gu::SharedBuffer buf(3000);
+        buf->resize(3000);
+        ptr = buf.get();
+    }
+
+    {
+        // same size class, must come from the pool
+        gu::SharedBuffer buf(2100);
+        fail_if(buf.get() != ptr);
+        fail_if(buf->size() != 0);
+        fail_if(buf->capacity() < 2100);
+    }
+
+    long long allocs1, reuses1;
+    gu::SharedBuffer::pool_stats(allocs1, reuses1);
+    fail_if(allocs1 - allocs0 != 1);
+    fail_if(reuses1 - reuses0 != 1);
+
+    // buffers larger than pooled size are not kept
+    gu::SharedBuffer::pool_configure(1 << 10);
+    {
+        gu::SharedBuffer buf(3000);
+    }
+
+    gu::SharedBuffer::pool_stats(allocs0, reuses0);
+    fail_if(reuses0 != reuses1);
+
+    gu::SharedBuffer::pool_configure(1 << 17);
+}
+END_TEST
+
+Suite *gu_buffer_suite(void)
+{
+    Suite *s = suite_create("gu::SharedBuffer");
+    TCase *tc = tcase_create("gu_buffer");
+
+    suite_add_tcase (s, tc);
+    tcase_add_test(tc, shared_buffer_refs);
+    tcase_add_test(tc, shared_buffer_pool);
+
+    return s;
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2017 Codership Oy <info@codership.com>
+ */
+
+#include "../src/gu_event_trace.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+
+#include "gu_event_trace_test.hpp"
+
+using gu::EventTrace;
+
+static const char* const dump_file = "gu_event_trace_test.dump";
+
+/* reads dump and returns the number of records with given event and id */
+static size_t count_records(EventTrace::Event const ev, int64_t const id,
+                            int64_t* const last_seqno)
+{
+    FILE* const f(fopen(dump_file, "r"));
+    fail_if(0 == f);
+
+    EventTrace::FileHeader hdr;
+    fail_if(fread(&hdr, sizeof(hdr), 1, f) != 1);
+    fail_if(memcmp(hdr.magic_, EventTrace::MAGIC, sizeof(hdr.magic_)));
+    fail_if(hdr.version_  != EventTrace::VERSION);
+    fail_if(hdr.rec_size_ != sizeof(EventTrace::Record));
+
+    size_t ret(0);
+    EventTrace::Record rec;
+
+    while (fread(&rec, sizeof(rec), 1, f) == 1)
+    {
+        if (rec.event_ == uint32_t(ev) && rec.id_ == id)
+        {
+            ++ret;
+            fail_if(rec.duration_ < 0, "negative duration %lld",
+                    static_cast<long long>(rec.duration_));
+            *last_seqno = rec.seqno_;
+        }
+    }
+
+    fclose(f);
+
+    return ret;
+}
+
+START_TEST(test_event_trace)
+{
+    int64_t const id(0x7e57);
+    int64_t last(-1);
+
+    /* nothing is recorded while disabled */
+    EventTrace::enable(false);
+    fail_if(EventTrace::start() != 0);
+    EventTrace::record(EventTrace::EV_CERT_TEST, 0, id, EventTrace::start());
+    EventTrace::record(EventTrace::EV_CERT_TEST, 0, id);
+
+    EventTrace::enable(true);
+    fail_if(EventTrace::start() == 0);
+
+    EventTrace::dump(dump_file);
+    fail_if(count_records(EventTrace::EV_CERT_TEST, id, &last) != 0);
+
+    EventTrace::record(EventTrace::EV_CERT_TEST, 1, id, EventTrace::start());
+    EventTrace::record(EventTrace::EV_CERT_TEST, 2, id);
+
+    EventTrace::dump(dump_file);
+    fail_if(count_records(EventTrace::EV_CERT_TEST, id, &last) != 2);
+    fail_if(last != 2, "last seqno %lld", static_cast<long long>(last));
+
+    /* ring wraps around and keeps the latest records */
+    for (size_t i(0); i < 2*EventTrace::RING_LEN; ++i)
+    {
+        EventTrace::record(EventTrace::EV_CORE_SEND, i, id);
+    }
+
+    EventTrace::dump(dump_file);
+    size_t const n(count_records(EventTrace::EV_CORE_SEND, id, &last));
+    fail_if(n != EventTrace::RING_LEN, "%zu records", n);
+    fail_if(last != int64_t(2*EventTrace::RING_LEN - 1));
+
+    EventTrace::enable(false);
+    unlink(dump_file);
+}
+END_TEST
+
+Suite* gu_event_trace_suite()
+{
+    TCase* t = tcase_create ("test_event_trace");
+    tcase_add_test (t, test_event_trace);
+
+    Suite* s = suite_create ("gu::EventTrace");
+    suite_add_tcase (s, t);
+
+    return s;
+}
@@ -3,6 +3,7 @@
  */
 
 #include "../src/gu_histogram.hpp"
+#include "../src/gu_latency_histogram.hpp"
 #include "../src/gu_logger.hpp"
 #include <cstdlib>
 
@@ -31,10 +32,88 @@ START_TEST(test_histogram)
 }
 END_TEST
 
+START_TEST(test_latency_histogram_buckets)
+{
+    int prev(-1);
+
+    for (long long v(0); v < (1LL << 42); v = v*9/8 + 1)
+    {
+        int const b(LatencyHistogram::bucket(v));
+
+        fail_if(b < prev, "bucket(%lld) = %d < %d", v, b, prev);
+        fail_if(b >= LatencyHistogram::BUCKETS, "bucket(%lld) = %d", v, b);
+
+        if (b < LatencyHistogram::BUCKETS - 1)
+        {
+            fail_if(LatencyHistogram::bucket_min(b) > v,
+                    "bucket_min(%d) = %lld > %lld",
+                    b, LatencyHistogram::bucket_min(b), v);
+            fail_if(LatencyHistogram::bucket_min(b + 1) <= v,
+                    "bucket_min(%d) = %lld <= %lld",
+                    b + 1, LatencyHistogram::bucket_min(b + 1), v);
+        }
+
+        prev = b;
+    }
+}
+END_TEST
+
+START_TEST(test_latency_histogram)
+{
+    LatencyHistogram lh;
+
+    fail_if(lh.count() != 0);
+    fail_if(lh.percentile(0.5) != 0);
+
+    for (long long i(1); i <= 10000; ++i) lh.record(i * 1000);
+
+    lh.record(-1); // ignored
+
+    fail_if(lh.count() != 10000, "count: %lld", lh.count());
+
+    double const max_err(1.0/LatencyHistogram::SUB_BUCKETS);
+    double const pcts[] = { 0.5, 0.9, 0.99, 1.0 };
+
+    for (size_t i(0); i < sizeof(pcts)/sizeof(pcts[0]); ++i)
+    {
+        double const exp(pcts[i] * 10000 * 1000);
+        double const err((lh.percentile(pcts[i]) - exp)/exp);
+
+        fail_if(err > max_err || err < -max_err,
+                "p%f: %lld, expected %f", pcts[i], lh.percentile(pcts[i]),
+                exp);
+    }
+
+    fail_if(lh.mean() != 5000500.0, "mean: %f", lh.mean());
+
+    log_info << "latency: " << lh.to_string();
+
+    lh.clear();
+
+    fail_if(lh.count() != 0);
+
+    // sampling is off by default
+    fail_if(LatencyHistogram::enabled());
+    fail_if(LatencyHistogram::start() != 0);
+    lh.record_since(LatencyHistogram::start());
+    fail_if(lh.count() != 0);
+
+    LatencyHistogram::enable(true);
+    // started before enable(), skipped
+    lh.record_since(0);
+    lh.record_since(LatencyHistogram::start());
+    LatencyHistogram::enable(false);
+
+    fail_if(lh.count() != 1, "count: %lld", lh.count());
+}
+END_TEST
+
 Suite* gu_histogram_suite()
 {
     TCase* t = tcase_create ("test_histogram");
     tcase_add_test (t, test_histogram);
+    tcase_add_test (t, test_latency_histogram_buckets);
+    tcase_add_test (t, test_latency_histogram);
 
     Suite* s = suite_create ("gu::Histogram");
     suite_add_tcase (s, t);
@@ -0,0 +1,87 @@
+// Copyright (C) 2017 Codership Oy <info@codership.com>
+
+// $Id$
+
+#include "gu_lock.hpp"
+#include "gu_lock_prof.h"
+
+#include "gu_lock_prof_test.hpp"
+
+#include <unistd.h>
+
+static gu::Mutex     mtx("lock_prof_test");
+static gu_barrier_t  barrier;
+
+static void*
+hold_lock(void*)
+{
+    gu::Lock lock(mtx);
+    gu_barrier_wait(&barrier);
+    usleep(100000);
+    return NULL;
+}
+
+START_TEST (lock_prof)
+{
+    gu::Mutex unnamed;
+    gu_lock_site_t* const site(gu_lock_site("lock_prof_test"));
+    fail_if(NULL == site);
+
+    gu_lock_prof_set_rate(0);
+    { gu::Lock lock(mtx); }
+    fail_if(site->calls != 0);
+
+    gu_lock_prof_set_rate(2);
+    for (int i(0); i < 10; ++i)
+    {
+        gu::Lock lock(mtx);
+        gu::Lock lock2(unnamed);
+    }
+    fail_if(site->calls != 10, "calls: %lld", site->calls);
+    fail_if(site->sampled != 5, "sampled: %lld", site->sampled);
+    fail_if(site->contended != 0, "contended: %lld", site->contended);
+
+    gu_lock_prof_set_rate(1);
+    fail_if(site->calls != 10, "stats reset on rate change");
+
+    // time in cond wait is not hold time
+    {
+        gu::Cond cond;
+        gu::Lock lock(mtx);
+        try
+        {
+            lock.wait(cond, gu::datetime::Date::calendar() +
+                      gu::datetime::Period(100 * gu::datetime::MSec));
+        }
+        catch (gu::Exception& e)
+        {
+            fail_if(e.get_errno() != ETIMEDOUT);
+        }
+    }
+    fail_if(site->hold_ns >= 100 * 1000000LL, "hold: %lld", site->hold_ns);
+
+    gu_thread_t thd;
+    gu_barrier_init(&barrier, NULL, 2);
+    fail_if(gu_thread_create(&thd, NULL, hold_lock, NULL));
+    gu_barrier_wait(&barrier);
+    { gu::Lock lock(mtx); }
+    gu_thread_join(thd, NULL);
+    gu_barrier_destroy(&barrier);
+
+    fail_if(site->contended != 1, "contended: %lld", site->contended);
+    fail_if(site->wait_ns <= 0);
+
+    gu_lock_prof_set_rate(0);
+}
+END_TEST
+
+Suite *gu_lock_prof_suite(void)
+{
+    Suite *s = suite_create("gu_lock_prof");
+    TCase *tc = tcase_create("gu_lock_prof");
+
+    suite_add_tcase (s, tc);
+    tcase_add_test(tc, lock_prof);
+
+    return s;
+}
@@ -0,0 +1,12 @@
+// Copyright (C) 2017 Codership Oy <info@codership.com>
+
+// $Id$
+
+#ifndef __gu_lock_prof_test__
+#define __gu_lock_prof_test__
+
+#include <check.h>
+
+extern Suite *gu_lock_prof_suite(void);
+
+#endif /* __gu_lock_prof_test__ */
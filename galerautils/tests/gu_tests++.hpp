@@ -26,6 +26,9 @@
 #include "gu_histogram_test.hpp"
 #include "gu_stats_test.hpp"
 #include "gu_thread_test.hpp"
+#include "gu_event_trace_test.hpp"
+#include "gu_buffer_test.hpp"
+#include "gu_lock_prof_test.hpp"
 
 typedef Suite *(*suite_creator_t)(void);
 
@@ -47,6 +50,9 @@ static suite_creator_t suites[] =
     gu_histogram_suite,
     gu_stats_suite,
     gu_thread_suite,
+    gu_event_trace_suite,
+    gu_buffer_suite,
+    gu_lock_prof_suite,
     0
 };
 
@@ -5,6 +5,8 @@
 
 
 #include "gu_thread.hpp"
+#include "gu_status.hpp"
+#include "gu_exception.hpp"
 #include <sstream>
 
 #include "gu_thread_test.hpp"
@@ -50,6 +52,92 @@ START_TEST(check_thread_schedparam_system_default)
 }
 END_TEST
 
+static std::string thread_status(const char* const key)
+{
+    gu::Status status;
+    gu::thread_get_status(status);
+
+    gu::Status::const_iterator i(status.begin());
+    while (i != status.end() && i->first != key) ++i;
+
+    return (i != status.end() ? i->second : "");
+}
+
+START_TEST(check_thread_registry)
+{
+    try
+    {
+        gu::thread_param_set("thread.no_such_class.affinity", "0");
+        fail("unknown thread class accepted");
+    }
+    catch (gu::NotFound&) {}
+
+    try
+    {
+        gu::thread_param_set("thread.stats.priority", "0");
+        fail("unknown thread parameter accepted");
+    }
+    catch (gu::NotFound&) {}
+
+    try
+    {
+        gu::thread_param_set("thread.stats.affinity", "3-1");
+        fail("invalid CPU list accepted");
+    }
+    catch (gu::Exception& e)
+    {
+        fail_if(e.get_errno() != EINVAL);
+    }
+
+    try
+    {
+        gu::thread_param_set("thread.stats.sched", "other:x");
+        fail("invalid schedparam accepted");
+    }
+    catch (gu::Exception& e)
+    {
+        fail_if(e.get_errno() != EINVAL);
+    }
+
+    {
+        gu::RegisteredThread const reg("stats");
+        gu::thread_param_set("thread.stats.affinity", "0");
+
+        gu::Status status;
+        gu::thread_get_status(status);
+
+        gu::Status::const_iterator i(status.begin());
+        while (i != status.end() && i->first != "thread_stats") ++i;
+        fail_if(i == status.end());
+        fail_unless(i->second == "1/0/default", "'%s'", i->second.c_str());
+
+        gu::thread_param_set("thread.stats.affinity", "");
+    }
+
+    gu::Status status;
+    gu::thread_get_status(status);
+    gu::Status::const_iterator i(status.begin());
+    while (i != status.end() && i->first != "thread_stats") ++i;
+    fail_if(i != status.end(), "'%s'", i->second.c_str());
+
+    // short-lived thread is registered only if its class is configured
+    {
+        gu::RegisteredThread const reg("ws_check", true);
+        fail_if(thread_status("thread_ws_check") != "");
+    }
+
+    gu::thread_param_set("thread.ws_check.sched", "other:0");
+
+    {
+        gu::RegisteredThread const reg("ws_check", true);
+        fail_if(thread_status("thread_ws_check") != "1/any/other:0", "'%s'",
+                thread_status("thread_ws_check").c_str());
+    }
+
+    gu::thread_param_set("thread.ws_check.sched", "");
+}
+END_TEST
+
 Suite* gu_thread_suite()
 {
     Suite* s(suite_create("galerautils Thread"));
@@ -59,5 +147,9 @@ Suite* gu_thread_suite()
     tcase_add_test(tc, check_thread_schedparam_parse);
     tcase_add_test(tc, check_thread_schedparam_system_default);
 
+    tc = tcase_create("registry");
+    suite_add_tcase(s, tc);
+    tcase_add_test(tc, check_thread_registry);
+
     return s;
 }
@@ -41,6 +41,7 @@ Config::Config (int argc, char* argv[])
       options_ (),
       log_     (),
       cfg_     (),
+      ist_cache_(),
       exit_    (false)
 {
     po::options_description other ("Other options");
@@ -60,6 +61,8 @@ Config::Config (int argc, char* argv[])
         ("donor",    po::value<std::string>(&donor_),   "SST donor name")
         ("options,o",po::value<std::string>(&options_), "GCS/GCOMM option list")
         ("log,l",    po::value<std::string>(&log_),     "Log file")
+        ("ist-cache",po::value<std::string>(&ist_cache_),
+         "Keep write sets in GCache in this directory to serve IST")
         ;
 
     po::options_description cfg_opt;
@@ -137,6 +140,7 @@ Config::Config (int argc, char* argv[])
     strip_quotes(options_);
     strip_quotes(log_);
     strip_quotes(cfg_);
+    strip_quotes(ist_cache_);
 
     if (options_.length() > 0) options_ += "; ";
     options_ += "gcs.fc_limit=9999999; gcs.fc_factor=1.0; gcs.fc_master_slave=yes";
@@ -167,7 +171,8 @@ std::ostream& operator << (std::ostream& os, const Config& c)
        << "\n\tdonor:   " << c.donor()
        << "\n\toptions: " << c.options()
        << "\n\tcfg:     " << c.cfg()
-       << "\n\tlog:     " << c.log();
+       << "\n\tlog:     " << c.log()
+       << "\n\tist-cache: " << c.ist_cache();
     return os;
 }
 
@@ -0,0 +1,177 @@
+/* Copyright (C) 2017 Codership Oy <info@codership.com> */
+
+#include "garb_ist_cache.hpp"
+
+#include <gcs_action_source.hpp>
+#include <state_request.hpp>
+#include <uuid.hpp>
+
+#include <gu_logger.hpp>
+#include <gu_throw.hpp>
+
+namespace garb
+{
+
+/* replication protocol version from which trx version is 3 and IST stripes
+ * are served, see ReplicatorSMM::establish_protocol_versions() */
+static int const MIN_PROTO_VER(5);
+static int const TRX_VER(3);
+
+void
+IstCache::register_params (gu::Config& conf)
+{
+    gcache::GCache::register_params(conf);
+    galera::Certification::register_params(conf);
+    galera::ist::register_params(conf);
+}
+
+IstCache::IstCache (gu::Config& conf, const std::string& dir)
+    :
+    conf_       (conf),
+    gcache_     (conf, dir),
+    gcs_        (conf, gcache_),
+    service_thd_(gcs_, gcache_),
+    pool_       (sizeof(galera::TrxHandle), 1024, "GarbTrxHandle"),
+    cert_       (conf, service_thd_),
+    senders_    (gcs_, gcache_),
+    uuid_       (WSREP_UUID_UNDEFINED),
+    cc_seqno_   (GCS_SEQNO_ILL),
+    proto_ver_  (-1),
+    enabled_    (false)
+{
+    log_info << "Caching write sets for IST in '" << dir << "'";
+}
+
+IstCache::~IstCache ()
+{
+    senders_.cancel();
+}
+
+void
+IstCache::conf_change (const gcs_act_conf_t& conf)
+{
+    if (conf.conf_id < 0 || conf.repl_proto_ver < MIN_PROTO_VER)
+    {
+        if (conf.conf_id >= 0)
+        {
+            log_warn << "Replication protocol " << conf.repl_proto_ver
+                     << " is too old, not caching write sets for IST";
+        }
+
+        enabled_ = false;
+        return;
+    }
+
+    ::memcpy(uuid_.data, conf.uuid, sizeof(uuid_.data));
+    cc_seqno_  = conf.seqno;
+    proto_ver_ = conf.repl_proto_ver;
+
+    /* continues history if it is contiguous, resets it otherwise */
+    gcache_.seqno_reset(galera::to_gu_uuid(uuid_), cc_seqno_);
+
+    cert_.assign_initial_position(cc_seqno_, TRX_VER);
+
+    if (cc_seqno_ > 0) service_thd_.release_seqno(cc_seqno_);
+
+    service_thd_.flush();
+
+    enabled_ = true;
+}
+
+void
+IstCache::ordered (const gcs_action& act)
+{
+    if (!enabled_)
+    {
+        gcache_.free(const_cast<void*>(act.buf));
+        return;
+    }
+
+    galera::GcsActionTrx gtrx(pool_, act);
+    galera::TrxHandle* const trx(gtrx.trx());
+
+    trx->set_state(galera::TrxHandle::S_REPLICATING);
+    trx->set_state(galera::TrxHandle::S_CERTIFYING);
+
+    bool const ok(galera::Certification::TEST_OK == cert_.append_trx(trx));
+
+    if (ok)
+    {
+        trx->set_state(galera::TrxHandle::S_APPLYING);
+        trx->set_state(galera::TrxHandle::S_COMMITTING);
+        trx->set_state(galera::TrxHandle::S_COMMITTED);
+    }
+    else
+    {
+        trx->set_state(galera::TrxHandle::S_MUST_ABORT);
+        trx->set_state(galera::TrxHandle::S_ABORTING);
+        trx->set_state(galera::TrxHandle::S_ROLLED_BACK);
+    }
+
+    trx->verify_checksum();
+
+    /* failed write sets are skipped by IST receivers */
+    gcache_.seqno_assign(trx->action(), trx->global_seqno(),
+                         ok ? trx->depends_seqno() : -1);
+
+    (void)cert_.set_trx_committed(trx);
+}
+
+void
+IstCache::commit_cut (gcs_seqno_t const seqno)
+{
+    if (enabled_) cert_.purge_trxs_upto(seqno, true);
+}
+
+void
+IstCache::serve_stripe (const gcs_action& act)
+{
+    if (!enabled_)
+    {
+        log_warn << "IST stripe requested while not caching write sets";
+        return;
+    }
+
+    galera::StateRequest* const streq
+        (galera::read_state_request(act.buf, act.size));
+
+    if (streq->ist_len())
+    {
+        galera::IST_request istr;
+        galera::get_ist_request(streq, &istr);
+
+        wsrep_seqno_t const first(istr.last_applied() + 1);
+
+        if (galera::to_gu_uuid(istr.uuid()) ==
+            galera::to_gu_uuid(uuid_))
+        {
+            log_info << "Serving IST stripe for request: " << istr;
+
+            try
+            {
+                // gcache lock is held by the sender's shared cursor
+                senders_.run(conf_, istr.peer(), first, cc_seqno_,
+                             proto_ver_);
+            }
+            catch (gu::NotFound& nf)
+            {
+                log_warn << "IST stripe first seqno " << first
+                         << " not found from cache, joiner IST will fail";
+            }
+            catch (gu::Exception& e)
+            {
+                log_error << "IST stripe sender failed: " << e.what();
+            }
+        }
+        else
+        {
+            log_warn << "IST stripe request for "
+                     << galera::to_gu_uuid(istr.uuid())
+                     << " does not match group " << galera::to_gu_uuid(uuid_);
+        }
+    }
+
+    delete streq;
+}
+
+} /* namespace garb */
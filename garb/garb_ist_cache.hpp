@@ -0,0 +1,67 @@
+/* Copyright (C) 2017 Codership Oy <info@codership.com> */
+
+#ifndef _GARB_IST_CACHE_HPP_
+#define _GARB_IST_CACHE_HPP_
+
+#include <GCache.hpp>
+#include <galera_gcs.hpp>
+#include <galera_service_thd.hpp>
+#include <certification.hpp>
+#include <trx_handle.hpp>
+#include <ist.hpp>
+
+#include <gcs.hpp>
+#include <gu_config.hpp>
+
+namespace garb
+{
+
+/*! Keeps replicated write sets in GCache so that garbd can serve IST stripes
+ *  to joiners. Write sets are certified to mark the failed ones in GCache
+ *  the same way database nodes do - IST receivers don't certify. */
+class IstCache
+{
+public:
+
+    static void register_params (gu::Config&);
+
+    IstCache (gu::Config& conf, const std::string& dir);
+
+    ~IstCache ();
+
+    gcache_t* gcache() { return reinterpret_cast<gcache_t*>(&gcache_); }
+
+    /*! resets history and certification position on primary view */
+    void conf_change (const gcs_act_conf_t& conf);
+
+    /*! certifies and stores ordered write set, takes over act.buf */
+    void ordered (const gcs_action& act);
+
+    /*! releases write sets up to seqno */
+    void commit_cut (gcs_seqno_t seqno);
+
+    /*! starts sending IST stripe requested in act, act.buf is not released */
+    void serve_stripe (const gcs_action& act);
+
+private:
+
+    gu::Config&                 conf_;
+    gcache::GCache              gcache_;
+    galera::DummyGcs            gcs_;     /* garbd reports to group itself */
+    galera::ServiceThd          service_thd_;
+    galera::TrxHandle::SlavePool pool_;
+    galera::Certification       cert_;
+    galera::ist::AsyncSenderMap senders_;
+    wsrep_uuid_t                uuid_;
+    gcs_seqno_t                 cc_seqno_;
+    int                         proto_ver_;
+    bool                        enabled_; /* history is contiguous */
+
+    IstCache (const IstCache&);
+    IstCache& operator= (const IstCache&);
+
+}; /* class IstCache */
+
+} /* namespace garb */
+
+#endif /* _GARB_IST_CACHE_HPP_ */
@@ -24,7 +24,9 @@ RecvLoop::RecvLoop (const Config& config)
     gconf_ (),
     params_(gconf_),
     parse_ (gconf_, config_.options()),
-    gcs_   (gconf_, config_.name(), config_.address(), config_.group())
+    cache_ (gconf_, config_.ist_cache()),
+    gcs_   (gconf_, config_.name(), config_.address(), config_.group(),
+            cache_.gcache())
 {
     /* set up signal handlers */
     global_gcs = &gcs_;
@@ -52,6 +54,8 @@ RecvLoop::RecvLoop (const Config& config)
 void
 RecvLoop::loop()
 {
+    IstCache* const cache(cache_.ptr_);
+
     while (1)
     {
         gcs_action act;
@@ -61,22 +65,51 @@ RecvLoop::loop()
         switch (act.type)
         {
         case GCS_ACT_TORDERED:
+            /* without cache gcs consumes these itself, see gcs_recv_thread() */
             if (gu_unlikely(!(act.seqno_g & 127)))
                 /* == report_interval_ of 128 */
             {
                 gcs_.set_last_applied (act.seqno_g);
             }
+
+            if (cache)
+            {
+                cache->ordered(act); /* buffer now belongs to cache */
+                continue;
+            }
             break;
         case GCS_ACT_COMMIT_CUT:
+            if (cache)
+            {
+                gcs_seqno_t seq;
+                gu::unserialize8(static_cast<const gu::byte_t*>(act.buf),
+                                 act.size, 0, seq);
+                cache->commit_cut(seq);
+            }
             break;
         case GCS_ACT_STATE_REQ:
-            gcs_.join (-ENOSYS); /* we can't donate state */
+            if (cache && GCS_STR_STRIPE_HELPER == act.seqno_g)
+            {
+                cache->serve_stripe(act);
+            }
+            else
+            {
+                gcs_.join (-ENOSYS); /* we can't donate state */
+            }
+
+            if (cache)
+            {
+                gcache_free(cache->gcache(), act.buf);
+                continue;
+            }
             break;
         case GCS_ACT_CONF:
         {
             const gcs_act_conf_t* const cc
                 (reinterpret_cast<const gcs_act_conf_t*>(act.buf));
 
+            if (cache) cache->conf_change(*cc);
+
             if (cc->conf_id > 0) /* PC */
             {
                 if (GCS_NODE_STATE_PRIM == cc->my_state)
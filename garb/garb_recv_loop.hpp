@@ -1,13 +1,15 @@
-/* Copyright (C) 2011-2014 Codership Oy <info@codership.com> */
+/* Copyright (C) 2011-2017 Codership Oy <info@codership.com> */
 
 #ifndef _GARB_RECV_LOOP_HPP_
 #define _GARB_RECV_LOOP_HPP_
 
 #include "garb_gcs.hpp"
 #include "garb_config.hpp"
+#include "garb_ist_cache.hpp"
 
 #include <gu_throw.hpp>
 #include <gu_asio.hpp>
+#include <gu_thread.hpp>
 
 #include <pthread.h>
 
@@ -34,10 +36,12 @@ private:
         RegisterParams(gu::Config& cnf)
         {
             gu::ssl_register_params(cnf);
+            gu::thread_register_params(cnf);
             if (gcs_register_params(reinterpret_cast<gu_config_t*>(&cnf)))
             {
                 gu_throw_fatal << "Error initializing GCS parameters";
             }
+            IstCache::register_params(cnf);
         }
     }
         params_;
@@ -47,10 +51,25 @@ private:
         ParseOptions(gu::Config& cnf, const std::string& opt)
         {
             cnf.parse(opt);
+            gu::thread_configure(cnf);
         }
     }
         parse_;
 
+    struct Cache
+    {
+        Cache(gu::Config& cnf, const std::string& dir)
+            : ptr_(dir.empty() ? 0 : new IstCache(cnf, dir))
+        {}
+        ~Cache() { delete ptr_; }
+        gcache_t* gcache() const { return ptr_ ? ptr_->gcache() : NULL; }
+        IstCache* const ptr_;
+    private:
+        Cache(const Cache&);
+        Cache& operator=(const Cache&);
+    }
+        cache_;
+
     Gcs           gcs_;
 }; /* RecvLoop */
 
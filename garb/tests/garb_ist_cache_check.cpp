@@ -0,0 +1,292 @@
+/*
+ * Copyright (C) 2017 Codership Oy <info@codership.com>
+ */
+
+#include "../garb_ist_cache.hpp"
+
+#include <state_request.hpp>
+#include <key_data.hpp>
+#include <uuid.hpp>
+
+#include <gu_uuid.h>
+
+#include <sstream>
+#include <cstring>
+#include <unistd.h>
+
+#include <check.h>
+
+using galera::TrxHandle;
+
+static int const REPL_PROTO_VER(8);
+static int const TRX_VER(3);
+
+static std::string const cache_file("garb_check.cache");
+
+static void
+init_config (gu::Config& conf)
+{
+    // same as garbd does
+    gu::ssl_register_params(conf);
+    fail_if(gcs_register_params(reinterpret_cast<gu_config_t*>(&conf)));
+    garb::IstCache::register_params(conf);
+    conf.set("gcache.name", cache_file);
+    conf.set("gcache.size", "64K");
+}
+
+static wsrep_uuid_t
+new_uuid ()
+{
+    wsrep_uuid_t ret;
+    gu_uuid_generate(reinterpret_cast<gu_uuid_t*>(&ret), 0, 0);
+    return ret;
+}
+
+/* delivers primary configuration change at seqno to cache */
+static void
+conf_change (garb::IstCache& cache, const wsrep_uuid_t& group,
+             gcs_seqno_t const seqno)
+{
+    gcs_act_conf_t conf;
+    ::memset(&conf, 0, sizeof(conf));
+    conf.seqno          = seqno;
+    conf.conf_id        = 1;
+    ::memcpy(conf.uuid, group.data, sizeof(conf.uuid));
+    conf.memb_num       = 1;
+    conf.my_state       = GCS_NODE_STATE_SYNCED;
+    conf.repl_proto_ver = REPL_PROTO_VER;
+
+    cache.conf_change(conf);
+}
+
+/* delivers write set with a single exclusive key to cache */
+static void
+ordered (garb::IstCache&        cache,
+         TrxHandle::LocalPool&  lp,
+         const wsrep_uuid_t&    source,
+         const char*            key,
+         wsrep_seqno_t const    last_seen,
+         gcs_seqno_t const      seqno)
+{
+    TrxHandle::Params const params("", TRX_VER, galera::KeySet::MAX_VERSION);
+    TrxHandle* const trx(TrxHandle::New(lp, params, source, 1, seqno));
+
+    const wsrep_buf_t k[1] = { { key, strlen(key) } };
+    trx->append_key(galera::KeyData(TRX_VER, k, 1, WSREP_KEY_EXCLUSIVE, true));
+    trx->append_data("bar", 3, WSREP_DATA_ORDERED, true);
+
+    galera::WriteSetNG::GatherVector bufs;
+    ssize_t const size(trx->write_set_out().gather(trx->source_id(),
+                                                   trx->conn_id(),
+                                                   trx->trx_id(),
+                                                   bufs));
+    trx->set_last_seen_seqno(last_seen);
+
+    gu::byte_t* const ptr(static_cast<gu::byte_t*>(
+                              gcache_malloc(cache.gcache(), size)));
+    gu::byte_t* p(ptr);
+    for (size_t i(0); i < bufs->size(); ++i)
+    {
+        ::memcpy(p, bufs[i].ptr, bufs[i].size); p += bufs[i].size;
+    }
+    fail_if(p - ptr != size);
+
+    struct gcs_action const act = { ptr, size, seqno, seqno,
+                                    GCS_ACT_TORDERED };
+    cache.ordered(act);
+
+    trx->unref();
+}
+
+static gcache::GCache&
+gcache_of (garb::IstCache& cache)
+{
+    return *reinterpret_cast<gcache::GCache*>(cache.gcache());
+}
+
+/* @return cached dependency seqno of seqno, throws gu::NotFound */
+static wsrep_seqno_t
+cached_depends (garb::IstCache& cache, gcs_seqno_t const seqno)
+{
+    std::vector<gcache::GCache::Buffer> buf(1);
+
+    if (gcache_of(cache).seqno_get_buffers(buf, seqno) != 1)
+    {
+        throw gu::NotFound();
+    }
+
+    gcache_of(cache).seqno_unlock();
+
+    return buf[0].seqno_d();
+}
+
+START_TEST(test_ist_cache_certify)
+{
+    gu::Config conf;
+    init_config(conf);
+
+    TrxHandle::LocalPool lp(TrxHandle::LOCAL_STORAGE_SIZE(), 4, "ist_cache");
+    wsrep_uuid_t const group(new_uuid());
+    wsrep_uuid_t const s1(new_uuid());
+    wsrep_uuid_t const s2(new_uuid());
+
+    {
+        garb::IstCache cache(conf, ".");
+
+        // not caching before primary configuration
+        ordered(cache, lp, s1, "k", 0, 1);
+        fail_if(gcache_of(cache).seqno_min() != -1);
+
+        conf_change(cache, group, 0);
+
+        ordered(cache, lp, s1, "k", 0, 1);
+        // conflicts with 1, did not see it
+        ordered(cache, lp, s2, "k", 0, 2);
+        // saw 1 and does not depend on failed 2
+        ordered(cache, lp, s2, "k", 1, 3);
+
+        fail_if(gcache_of(cache).seqno_min() != 1);
+        fail_if(cached_depends(cache, 1) != 0);
+        fail_if(cached_depends(cache, 2) != -1,
+                "conflicting write set stored with depends %lld",
+                (long long)cached_depends(cache, 2));
+        fail_if(cached_depends(cache, 3) != 1,
+                "write set stored with depends %lld",
+                (long long)cached_depends(cache, 3));
+    }
+
+    unlink(cache_file.c_str());
+}
+END_TEST
+
+START_TEST(test_ist_cache_eviction)
+{
+    gu::Config conf;
+    init_config(conf);
+
+    TrxHandle::LocalPool lp(TrxHandle::LOCAL_STORAGE_SIZE(), 4, "ist_cache");
+    wsrep_uuid_t const group(new_uuid());
+    wsrep_uuid_t const source(new_uuid());
+
+    // several times more than gcache.size
+    gcs_seqno_t const last(2000);
+
+    {
+        garb::IstCache cache(conf, ".");
+
+        conf_change(cache, group, 0);
+
+        for (gcs_seqno_t i(1); i <= last / 2; ++i)
+        {
+            ordered(cache, lp, source, "k", i - 1, i);
+        }
+
+        // nothing is released before commit cut
+        fail_if(gcache_of(cache).seqno_min() != 1);
+
+        cache.commit_cut(last / 2);
+        usleep(100000); // let service thread release write sets
+
+        for (gcs_seqno_t i(last / 2 + 1); i <= last; ++i)
+        {
+            ordered(cache, lp, source, "k", i - 1, i);
+        }
+
+        gcs_seqno_t const min(gcache_of(cache).seqno_min());
+        fail_if(min <= 1, "released write sets were not evicted");
+        fail_if(min > last / 2 + 1, "evicted %lld, past commit cut",
+                (long long)min);
+        fail_if(cached_depends(cache, last) != last - 1);
+    }
+
+    unlink(cache_file.c_str());
+}
+END_TEST
+
+START_TEST(test_ist_cache_serve_stripe)
+{
+    gu::Config conf;
+    init_config(conf);
+    // receiver side parameters are normally registered by the provider
+    conf.add("base_host");
+    conf.add("base_port");
+    conf.set(galera::ist::Receiver::RECV_ADDR, "tcp://127.0.0.1:0");
+
+    TrxHandle::LocalPool lp(TrxHandle::LOCAL_STORAGE_SIZE(), 4, "ist_cache");
+    TrxHandle::SlavePool sp(sizeof(TrxHandle), 4, "ist_cache");
+    wsrep_uuid_t const group(new_uuid());
+    wsrep_uuid_t const source(new_uuid());
+
+    gcs_seqno_t const first(11);
+    gcs_seqno_t const last(100);
+
+    {
+        garb::IstCache cache(conf, ".");
+
+        conf_change(cache, group, 0);
+
+        for (gcs_seqno_t i(1); i <= last; ++i)
+        {
+            ordered(cache, lp, source, "k", i - 1, i);
+        }
+
+        // joiner requests IST at configuration change
+        conf_change(cache, group, last);
+
+        galera::ist::Receiver receiver(conf, sp, 0);
+        std::string const addr(receiver.prepare(first, last, REPL_PROTO_VER));
+
+        std::ostringstream os;
+        os << galera::IST_request(addr, group, first - 1, last);
+        std::string const ist(os.str());
+
+        galera::StateRequest_v1 const req("", 0, ist.c_str(), ist.size() + 1);
+        struct gcs_action const act = { req.req(), req.len(),
+                                        GCS_STR_STRIPE_HELPER, 1,
+                                        GCS_ACT_STATE_REQ };
+        cache.serve_stripe(act);
+
+        receiver.ready(1);
+
+        gcs_seqno_t expected(first);
+        TrxHandle* trx(0);
+
+        while (receiver.recv(&trx) == 0)
+        {
+            fail_if(trx->global_seqno() != expected,
+                    "received %lld, expected %lld",
+                    (long long)trx->global_seqno(), (long long)expected);
+            ++expected;
+            trx->unref();
+        }
+
+        fail_if(expected != last + 1, "IST ended at %lld, expected %lld",
+                (long long)expected - 1, (long long)last);
+        fail_if(receiver.finished() != last);
+    }
+
+    unlink(cache_file.c_str());
+}
+END_TEST
+
+Suite* ist_cache_suite()
+{
+    Suite* s = suite_create("ist_cache");
+    TCase* tc;
+
+    tc = tcase_create("test_ist_cache_certify");
+    tcase_add_test(tc, test_ist_cache_certify);
+    suite_add_tcase(s, tc);
+
+    tc = tcase_create("test_ist_cache_eviction");
+    tcase_set_timeout(tc, 60);
+    tcase_add_test(tc, test_ist_cache_eviction);
+    suite_add_tcase(s, tc);
+
+    tc = tcase_create("test_ist_cache_serve_stripe");
+    tcase_set_timeout(tc, 60);
+    tcase_add_test(tc, test_ist_cache_serve_stripe);
+    suite_add_tcase(s, tc);
+
+    return s;
+}
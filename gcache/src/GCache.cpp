@@ -6,8 +6,11 @@
 #include "gcache_bh.hpp"
 
 #include <gu_logger.hpp>
+#include <gu_time.h>
+#include <gu_thread.hpp>
 
 #include <cerrno>
+#include <cstring>
 #include <unistd.h>
 
 namespace gcache
@@ -38,13 +41,13 @@ namespace gcache
         :
         config    (cfg),
         params    (config, data_dir),
-        mtx       (),
+        mtx       ("gcache"),
         cond      (),
         seqno2ptr (),
         gid       (),
         mem       (params.mem_size(), seqno2ptr),
         rb        (params.rb_name(), params.rb_size(), seqno2ptr, gid,
-                   params.recover()),
+                   params.recover(), true),
         ps        (params.dir_name(),
                    params.keep_pages_size(),
                    params.page_size(),
@@ -56,14 +59,99 @@ namespace gcache
         seqno_locked(SEQNO_NONE),
         seqno_max   (seqno2ptr.empty() ?
                      SEQNO_NONE : seqno2ptr.rbegin()->first),
-        seqno_released(seqno_max)
+        seqno_released(seqno_max),
+        recovery_mtx    (),
+        recovery_cond   (),
+        recovery_thd    (),
+        reset_seqno     (SEQNO_NONE),
+        reset_gid       (),
+        reset_pending   (false),
+        recovery_running(false),
+        recovery_locked (false),
+        recovering      (false)
 #ifndef NDEBUG
         ,buf_tracker()
 #endif
-    {}
+    {
+        if (!rb.recovery_pending()) return;
+
+        {
+            gu::Lock lock(recovery_mtx);
+
+            recovering = true;
+
+            int const err(pthread_create(&recovery_thd, NULL, recovery_thread,
+                                         this));
+            if (0 == err)
+            {
+                recovery_running = true;
+
+                /* don't return until the thread holds mtx, so that nobody
+                 * can access the seqno index before it is recovered */
+                while (!recovery_locked) lock.wait(recovery_cond);
+                return;
+            }
+
+            log_warn << "Failed to start GCache recovery thread: " << err
+                     << " (" << strerror(err) << "), recovering inline.";
+        }
+
+        recover_history();
+    }
+
+    void*
+    GCache::recovery_thread(void* arg)
+    {
+        gu::RegisteredThread const reg("gcache_recover");
+        static_cast<GCache*>(arg)->recover_history();
+        return NULL;
+    }
+
+    void
+    GCache::recover_history()
+    {
+        gu::Lock lock(mtx);
+
+        {
+            gu::Lock rlock(recovery_mtx);
+            recovery_locked = true;
+            recovery_cond.broadcast();
+        }
+
+        long long const start(gu_time_monotonic());
+
+        rb.recover();
+
+        seqno_max = seqno2ptr.empty() ? SEQNO_NONE : seqno2ptr.rbegin()->first;
+        seqno_released = seqno_max;
+
+        log_info << "GCache history recovery took "
+                 << (gu_time_monotonic() - start)/1000000 << " ms, "
+                 << "recovered seqnos: "
+                 << (seqno2ptr.empty() ? SEQNO_NONE : seqno2ptr.begin()->first)
+                 << '-' << seqno_max;
+
+        bool     reset;
+        gu::UUID g;
+        seqno_t  s;
+
+        {
+            gu::Lock rlock(recovery_mtx);
+            recovering = false;
+            reset = reset_pending;
+            g = reset_gid;
+            s = reset_seqno;
+            reset_pending = false;
+            recovery_cond.broadcast();
+        }
+
+        if (reset) seqno_reset_locked(g, s);
+    }
 
     GCache::~GCache ()
     {
+        if (recovery_running) pthread_join(recovery_thd, NULL);
+
         gu::Lock lock(mtx);
         log_debug << "\n" << "GCache mallocs : " << mallocs
                   << "\n" << "GCache reallocs: " << reallocs
@@ -16,6 +16,7 @@
 
 #include <string>
 #include <iostream>
+#include <pthread.h>
 #ifndef NDEBUG
 #include <set>
 #endif
@@ -35,6 +36,11 @@ namespace gcache
         /*!
          * Creates a new gcache file in "gcache.name" conf parameter or
          * in data_dir. If file already exists, it gets overwritten.
+         *
+         * If "gcache.recover" is set, ring buffer history is recovered by a
+         * background thread which holds the cache lock until done, so that
+         * constructor returns immediately and all calls that need the seqno
+         * index block only until recovery completes.
          */
         GCache (gu::Config& cfg, const std::string& data_dir);
 
@@ -57,6 +63,8 @@ namespace gcache
         /*!
          * Reinitialize seqno sequence (after SST or such)
          * Clears seqno->ptr map // and sets seqno_min to seqno.
+         * If history recovery is still in progress, the reset is recorded
+         * and applied by the recovery thread without blocking the caller.
          */
         void  seqno_reset (const gu::UUID& gid, seqno_t seqno);
 
@@ -85,7 +93,17 @@ namespace gcache
         }
 
         /*!
-         * Move lock to a given seqno.
+         * Returns seqno history is locked at, 0 if not locked
+         */
+        int64_t seqno_lock_position() const
+        {
+            gu::Lock lock(mtx);
+            return seqno_locked;
+        }
+
+        /*!
+         * Move lock to a given seqno. seqno_release() does not release
+         * locked seqno and the ones after it.
          * @throws gu::NotFound if seqno is not in the cache.
          */
         void  seqno_lock (int64_t const seqno_g);
@@ -153,11 +171,13 @@ namespace gcache
         /*!
          * Fills a vector with Buffer objects starting with seqno start
          * until either vector length or seqno map is exhausted.
-         * Moves seqno lock to start.
+         * Moves seqno lock to start unless lock is false: readers sharing
+         * the lock keep it at the slowest of them themselves.
          *
          * @retval number of buffers filled (<= v.size())
          */
-        size_t seqno_get_buffers (std::vector<Buffer>& v, int64_t start);
+        size_t seqno_get_buffers (std::vector<Buffer>& v, int64_t start,
+                                  bool lock = true);
 
         /*!
          * Releases any seqno locks present.
@@ -228,10 +248,25 @@ namespace gcache
         int64_t         seqno_max;
         int64_t         seqno_released;
 
+        /* background history recovery */
+        gu::Mutex       recovery_mtx;
+        gu::Cond        recovery_cond;
+        pthread_t       recovery_thd;
+        seqno_t         reset_seqno;
+        gu::UUID        reset_gid;
+        bool            reset_pending;
+        bool            recovery_running; // thread must be joined
+        bool            recovery_locked;  // thread holds mtx
+        bool            recovering;
+
 #ifndef NDEBUG
         std::set<const void*> buf_tracker;
 #endif
 
+        static void* recovery_thread(void*);
+        void  recover_history();
+        void  seqno_reset_locked(const gu::UUID& gid, seqno_t seqno);
+
         /* returns true when successfully discards all seqnos up to s */
         bool discard_seqno (int64_t s);
 
@@ -4,6 +4,8 @@
 
 #include "GCache.hpp"
 
+#include <gu_event_trace.hpp>
+
 #include <cassert>
 
 namespace gcache
@@ -54,6 +56,7 @@ namespace gcache
 
         if (gu_likely(s > 0))
         {
+            long long const start(gu::EventTrace::start());
             size_type const size(s + sizeof(BufferHeader));
 
             gu::Lock lock(mtx);
@@ -69,6 +72,8 @@ namespace gcache
 #ifndef NDEBUG
             if (0 != ptr) buf_tracker.insert (ptr);
 #endif
+            gu::EventTrace::record(gu::EventTrace::EV_GCACHE_MALLOC, -1, s,
+                                   start);
         }
 
         return ptr;
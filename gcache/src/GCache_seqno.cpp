@@ -7,6 +7,7 @@
 
 #include <cerrno>
 #include <cassert>
+#include <algorithm>
 
 #include <sched.h> // sched_yeild()
 
@@ -19,8 +20,26 @@ namespace gcache
     void
     GCache::seqno_reset (const gu::UUID& g, seqno_t const s)
     {
+        {
+            gu::Lock lock(recovery_mtx);
+
+            if (recovering)
+            {
+                reset_gid     = g;
+                reset_seqno   = s;
+                reset_pending = true;
+                return;
+            }
+        }
+
         gu::Lock lock(mtx);
 
+        seqno_reset_locked(g, s);
+    }
+
+    void
+    GCache::seqno_reset_locked (const gu::UUID& g, seqno_t const s)
+    {
         assert(seqno2ptr.empty() || seqno_max == seqno2ptr.rbegin()->first);
 
         if (g == gid && s == seqno_max) return;
@@ -120,6 +139,13 @@ namespace gcache
                 return;
             }
 
+            /* locked history is still needed by IST senders, it will be
+             * released by the next call after unlock */
+            int64_t const limit(seqno_locked != SEQNO_NONE ?
+                                std::min(seqno, seqno_locked - 1) : seqno);
+
+            if (limit <= seqno_released) return;
+
             assert(seqno_max >= seqno_released);
 
             /* here we check if (seqno_max - seqno_released) is decreasing
@@ -129,8 +155,8 @@ namespace gcache
             old_gap = new_gap;
 
             int64_t const start(it->first - 1);
-            int64_t const end  (seqno - start >= 2*batch_size ?
-                                start + batch_size : seqno);
+            int64_t const end  (limit - start >= 2*batch_size ?
+                                start + batch_size : limit);
 #if 0
             log_info << "############ releasing " << (seqno - start)
                      << " buffers, batch_size: " << batch_size
@@ -160,9 +186,9 @@ namespace gcache
                 if (gu_likely(!BH_is_released(bh))) free_common(bh);
             }
 
-            assert (loop || seqno == seqno_released);
+            assert (loop || limit == seqno_released);
 
-            loop = (end < seqno) && loop;
+            loop = (end < limit) && loop;
         }
         while(loop);
     }
@@ -227,7 +253,8 @@ namespace gcache
 
     size_t
     GCache::seqno_get_buffers (std::vector<Buffer>& v,
-                               int64_t const start)
+                               int64_t const start,
+                               bool    const lock_start)
     {
         size_t const max(v.size());
 
@@ -242,12 +269,15 @@ namespace gcache
 
             if (p != seqno2ptr.end())
             {
-                if (seqno_locked != SEQNO_NONE)
+                if (lock_start)
                 {
-                    cond.signal();
-                }
+                    if (seqno_locked != SEQNO_NONE)
+                    {
+                        cond.signal();
+                    }
 
-                seqno_locked = start;
+                    seqno_locked = start;
+                }
 
                 do {
                     assert (p->first == int64_t(start + found));
@@ -10,6 +10,8 @@
 
 #include <gu_logger.hpp>
 #include <gu_throw.hpp>
+#include <gu_probe.h>
+#include <gu_thread.hpp>
 
 #include <cstdio>
 #include <cstring>
@@ -47,33 +49,57 @@ make_page_name (const std::string& base_name, size_t count)
     return os.str();
 }
 
-static void*
-remove_file (void* __restrict__ arg)
+static void
+remove_file (const std::string& file_name)
 {
-    char* const file_name (static_cast<char*>(arg));
+    if (remove (file_name.c_str()))
+    {
+        int err = errno;
 
-    if (NULL != file_name)
+        log_error << "Failed to remove page file '" << file_name << "': "
+                  << err << " (" << strerror(err) << ")";
+    }
+    else
     {
-        if (remove (file_name))
-        {
-            int err = errno;
+        log_info << "Deleted page " << file_name;
+    }
+}
+
+/* Unmapping and removing of large page files may take long, it is done
+ * by janitor thread so that threads which free buffers (appliers) don't
+ * wait for it holding gcache mutex. */
+void*
+gcache::PageStore::janitor (void* arg)
+{
+    gu::RegisteredThread const reg("gcache_janitor");
+    PageStore* const ps(static_cast<PageStore*>(arg));
+
+    while (true)
+    {
+        Page* page;
 
-            log_error << "Failed to remove page file '" << file_name << "': "
-                      << err << " (" << strerror(err) << ")";
-        }
-        else
         {
-            log_info << "Deleted page " << file_name;
+            gu::Lock lock(ps->retired_mtx_);
+
+            while (ps->retired_.empty() && !ps->janitor_exit_)
+            {
+                lock.wait(ps->retired_cond_);
+            }
+
+            if (ps->retired_.empty()) break; // exit requested, all done
+
+            page = ps->retired_.front();
+            ps->retired_.pop_front();
         }
 
-        free (file_name);
-    }
-    else
-    {
-        log_error << "Null file name in " << __FUNCTION__;
+        std::string const file_name(page->name());
+
+        delete page;
+
+        remove_file (file_name);
     }
 
-    pthread_exit(NULL);
+    return NULL;
 }
 
 bool
@@ -85,26 +111,23 @@ gcache::PageStore::delete_page ()
 
     pages_.pop_front();
 
-    char* const file_name(strdup(page->name().c_str()));
-
     total_size_ -= page->size();
 
     if (current_ == page) current_ = 0;
 
-    delete page;
+    GU_PROBE2(gcache, page_discard, page->size(), total_size_);
 
-#ifdef GCACHE_DETACH_THREAD
-    pthread_t delete_thr_;
-#else
-    if (delete_thr_ != pthread_t(-1)) pthread_join (delete_thr_, NULL);
-#endif /* GCACHE_DETACH_THERAD */
-
-    int err = pthread_create (&delete_thr_, &delete_page_attr_, remove_file,
-                              file_name);
-    if (0 != err)
+    if (janitor_running_)
     {
-        delete_thr_ = pthread_t(-1);
-        gu_throw_error(err) << "Failed to create page file deletion thread";
+        gu::Lock lock(retired_mtx_);
+        retired_.push_back(page);
+        retired_cond_.signal();
+    }
+    else
+    {
+        std::string const file_name(page->name());
+        delete page;
+        remove_file (file_name);
     }
 
     return true;
@@ -136,6 +159,7 @@ gcache::PageStore::new_page (size_type size)
     pages_.push_back (page);
     total_size_ += page->size();
     current_ = page;
+    GU_PROBE2(gcache, page_create, page->size(), total_size_);
     count_++;
 }
 
@@ -152,29 +176,24 @@ gcache::PageStore::PageStore (const std::string& dir_name,
     pages_     (),
     current_   (0),
     total_size_(0),
-    delete_page_attr_()
-#ifndef GCACHE_DETACH_THREAD
-    , delete_thr_(pthread_t(-1))
-#endif /* GCACHE_DETACH_THREAD */
+    retired_mtx_    (),
+    retired_cond_   (),
+    retired_        (),
+    janitor_thr_    (),
+    janitor_running_(false),
+    janitor_exit_   (false)
 {
-    int err = pthread_attr_init (&delete_page_attr_);
+    int const err(pthread_create (&janitor_thr_, NULL, janitor, this));
 
     if (0 != err)
     {
-        gu_throw_error(err) << "Failed to initialize page file deletion "
-                            << "thread attributes";
+        log_warn << "Failed to start page file deletion thread: " << err
+                 << " (" << strerror(err) << "), deleting pages inline";
     }
-
-#ifdef GCACHE_DETACH_THREAD
-    err = pthread_attr_setdetachstate (&delete_page_attr_,
-                                       PTHREAD_CREATE_DETACHED);
-    if (0 != err)
+    else
     {
-        pthread_attr_destroy (&delete_page_attr_);
-        gu_throw_error(err) << "Failed to set DETACHED attribute to "
-                            << "page file deletion thread";
+        janitor_running_ = true;
     }
-#endif /* GCACHE_DETACH_THREAD */
 }
 
 gcache::PageStore::~PageStore ()
@@ -182,22 +201,28 @@ gcache::PageStore::~PageStore ()
     try
     {
         while (pages_.size() && delete_page()) {};
-#ifndef GCACHE_DETACH_THREAD
-        if (delete_thr_ != pthread_t(-1)) pthread_join (delete_thr_, NULL);
-#endif /* GCACHE_DETACH_THREAD */
     }
     catch (gu::Exception& e)
     {
         log_error << e.what() << " in ~PageStore()"; // abort() ?
     }
 
+    if (janitor_running_)
+    {
+        {
+            gu::Lock lock(retired_mtx_);
+            janitor_exit_ = true;
+            retired_cond_.signal();
+        }
+
+        pthread_join (janitor_thr_, NULL);
+    }
+
     if (pages_.size() > 0)
     {
         log_error << "Could not delete " << pages_.size()
                   << " page files: some buffers are still \"mmapped\".";
     }
-
-    pthread_attr_destroy (&delete_page_attr_);
 }
 
 inline void*
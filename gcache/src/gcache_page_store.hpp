@@ -11,8 +11,11 @@
 #include "gcache_page.hpp"
 #include "gcache_seqno.hpp"
 
+#include <gu_lock.hpp>
+
 #include <string>
 #include <deque>
+#include <pthread.h>
 
 namespace gcache
 {
@@ -66,10 +69,16 @@ namespace gcache
         std::deque<Page*> pages_;
         Page*             current_;
         size_t            total_size_;
-        pthread_attr_t    delete_page_attr_;
-#ifndef GCACHE_DETACH_THREAD
-        pthread_t         delete_thr_;
-#endif /* GCACHE_DETACH_THREAD */
+
+        /* pages taken out of the store, waiting to be deleted */
+        gu::Mutex         retired_mtx_;
+        gu::Cond          retired_cond_;
+        std::deque<Page*> retired_;
+        pthread_t         janitor_thr_;
+        bool              janitor_running_;
+        bool              janitor_exit_;
+
+        static void* janitor (void* arg);
 
         void new_page    (size_type size);
 
@@ -47,7 +47,8 @@ namespace gcache
                             size_t             size,
                             seqno2ptr_t&       seqno2ptr,
                             gu::UUID&          gid,
-                            bool const         recover)
+                            bool const         recover,
+                            bool const         defer_recovery)
     :
         fd_        (name, check_size(size)),
         mmap_      (fd_),
@@ -65,11 +66,17 @@ namespace gcache
         size_trail_(0),
 //        mallocs_   (0),
 //        reallocs_  (0),
+        recovery_offset_ (-1),
+        recovery_pending_(false),
         open_      (true)
     {
         constructor_common ();
         open_preamble(recover);
-        BH_clear (BH_cast(next_));
+
+        if (!recovery_pending_)
+            BH_clear (BH_cast(next_));
+        else if (!defer_recovery)
+            this->recover();
     }
 
     RingBuffer::~RingBuffer ()
@@ -630,16 +637,11 @@ namespace gcache
                 log_info << "Recovering GCache ring buffer: version: " << version
                          << ", UUID: " << gid_ << ", offset: " << offset;
 
-                try
-                {
-                    recover(offset - (start_ - preamble));
-                }
-                catch (gu::Exception& e)
-                {
-                    log_warn << "Failed to recover GCache ring buffer: "
-                             << e.what();
-                    reset();
-                }
+                /* preamble is rewritten only when recovery completes, so that
+                 * interrupted recovery can use the recorded offset again */
+                recovery_offset_  = offset - (start_ - preamble);
+                recovery_pending_ = true;
+                return;
             }
             else
             {
@@ -651,9 +653,32 @@ namespace gcache
         write_preamble(false);
     }
 
+    void
+    RingBuffer::recover()
+    {
+        if (!recovery_pending_) return;
+
+        try
+        {
+            recover(recovery_offset_);
+        }
+        catch (gu::Exception& e)
+        {
+            log_warn << "Failed to recover GCache ring buffer: " << e.what();
+            reset();
+        }
+
+        recovery_pending_ = false;
+
+        write_preamble(false);
+        BH_clear (BH_cast(next_));
+    }
+
     void
     RingBuffer::close_preamble()
     {
+        if (recovery_pending_) return; // keep preamble for the next attempt
+
         write_preamble(true);
     }
 
@@ -27,10 +27,21 @@ namespace gcache
                     size_t             size,
                     seqno2ptr_t&       seqno2ptr,
                     gu::UUID&          gid,
-                    bool               recover);
+                    bool               recover,
+                    bool               defer_recovery = false);
 
         ~RingBuffer ();
 
+        /*! @return true if history recovery was deferred by constructor and
+         *          recover() has not been called yet */
+        bool  recovery_pending() const { return recovery_pending_; }
+
+        /*!
+         * Completes deferred history recovery: scans the buffer and populates
+         * seqno2ptr map. Must be called before any other access to the store.
+         */
+        void  recover();
+
         void* malloc  (size_type size);
 
         void  free    (BufferHeader* bh);
@@ -133,6 +144,8 @@ namespace gcache
         size_t             size_used_;
         size_t             size_trail_;
 
+        off_t              recovery_offset_;
+        bool               recovery_pending_;
         bool               open_;
 
         BufferHeader* get_new_buffer (size_type size);
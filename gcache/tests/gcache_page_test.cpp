@@ -8,6 +8,8 @@
 #include "gcache_bh.hpp"
 #include "gcache_page_test.hpp"
 
+#include <unistd.h>
+
 using namespace gcache;
 
 void ps_free (void* ptr)
@@ -115,6 +117,35 @@ START_TEST(test3) // check that all page size is efficiently used
 }
 END_TEST
 
+START_TEST(test_janitor) // page files are deleted in background
+{
+    const char* const dir_name = "";
+    ssize_t const bh_size = sizeof(gcache::BufferHeader);
+    const char* const page0 = "gcache.page.000000";
+
+    {
+        gcache::PageStore ps (dir_name, 1, 2 + bh_size, false);
+
+        void* buf = ps.malloc (3 + bh_size);
+
+        fail_if (0 == buf);
+        fail_if (access(page0, F_OK) != 0, "page %s not created", page0);
+
+        ps_free(buf);
+        ps.discard (ptr2BH(buf));
+
+        // page is out of the store right away, file deletion may lag
+        fail_if(ps.total_pages() != 0,"expected 0 pages, got %zu",
+                ps.total_pages());
+        fail_if(ps.total_size()  != 0,"expected size 0, got %zu",
+                ps.total_size());
+    }
+
+    // destructor waits for pending deletions
+    fail_if (access(page0, F_OK) == 0, "page %s not deleted", page0);
+}
+END_TEST
+
 Suite* gcache_page_suite()
 {
     Suite* s = suite_create("gcache::PageStore");
@@ -124,6 +155,7 @@ Suite* gcache_page_suite()
     tcase_add_test(tc, test1);
     tcase_add_test(tc, test2);
     tcase_add_test(tc, test3);
+    tcase_add_test(tc, test_janitor);
     suite_add_tcase(s, tc);
 
     return s;
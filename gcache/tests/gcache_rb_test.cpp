@@ -491,6 +491,49 @@ START_TEST(recovery)
 }
 END_TEST
 
+START_TEST(deferred_recovery)
+{
+    ::unlink(RB_NAME.c_str());
+
+    size_t const rb_size(ALLOC_SIZE(8) * 8);
+    gu::UUID     gid(GID);
+
+    {
+        seqno2ptr_t s2p;
+        RingBuffer  rb(RB_NAME, rb_size, s2p, gid, false);
+
+        for (seqno_t s(1); s <= 3; ++s)
+        {
+            void* const ptr(rb.malloc(ALLOC_SIZE(8)));
+            fail_if (NULL == ptr);
+
+            s2p.insert(seqno2ptr_pair_t(s, ptr));
+            BufferHeader* const bh(ptr2BH(ptr));
+            bh->seqno_g = s;
+            bh->seqno_d = s - 1;
+            BH_release(bh);
+            rb.free(bh);
+        }
+    }
+
+    {
+        seqno2ptr_t s2p;
+        RingBuffer  rb(RB_NAME, rb_size, s2p, gid, true, true);
+
+        fail_if (!rb.recovery_pending());
+        fail_if (!s2p.empty());
+
+        rb.recover();
+
+        fail_if (rb.recovery_pending());
+        fail_if (s2p.size() != 3, "Expected 3 seqnos, got %zu", s2p.size());
+        fail_if (s2p.begin()->first != 1);
+        fail_if (s2p.rbegin()->first != 3);
+    }
+
+    ::unlink(RB_NAME.c_str());
+}
+END_TEST
 
 Suite* gcache_rb_suite()
 {
@@ -505,6 +548,7 @@ Suite* gcache_rb_suite()
 
     tcase_set_timeout(tc, 60);
     tcase_add_test(tc, recovery);
+    tcase_add_test(tc, deferred_recovery);
     suite_add_tcase(ts, tc);
 
     return ts;
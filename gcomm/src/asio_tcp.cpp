@@ -415,10 +415,9 @@ void gcomm::AsioTcpSocket::read_handler(const asio::error_code& ec,
         if (recv_offset_ >= hdr.len() + NetHeader::serial_size_)
         {
             Datagram dg(
-                gu::SharedBuffer(
-                    new gu::Buffer(&recv_buf_[0] + NetHeader::serial_size_,
-                                   &recv_buf_[0] + NetHeader::serial_size_
-                                   + hdr.len())));
+                gu::SharedBuffer(&recv_buf_[0] + NetHeader::serial_size_,
+                                 &recv_buf_[0] + NetHeader::serial_size_
+                                 + hdr.len()));
             if (net_.checksum_ != NetHeader::CS_NONE)
             {
 #ifdef TEST_NET_CHECKSUM_ERROR
@@ -192,10 +192,9 @@ void gcomm::AsioUdpSocket::read_handler(const asio::error_code& ec,
         else
         {
             Datagram dg(
-                gu::SharedBuffer(
-                    new gu::Buffer(&recv_buf_[0] + NetHeader::serial_size_,
-                                   &recv_buf_[0] + NetHeader::serial_size_
-                                   + hdr.len())));
+                gu::SharedBuffer(&recv_buf_[0] + NetHeader::serial_size_,
+                                 &recv_buf_[0] + NetHeader::serial_size_
+                                 + hdr.len()));
             if (net_.checksum_ == true && check_cs(hdr, dg))
             {
                 log_warn << "checksum failed, hdr: len=" << hdr.len()
@@ -18,6 +18,9 @@
 
 #include "defaults.hpp"
 
+#include "gu_event_trace.hpp"
+#include "gu_probe.h"
+
 #include <cmath>
 
 #include <stdexcept>
@@ -1638,8 +1641,7 @@ int gcomm::evs::Proto::send_user(const seqno_t win)
             ++n;
             ++i;
         }
-        Datagram dg(gu::SharedBuffer(new gu::Buffer(send_buf_.begin(),
-                                                        send_buf_.end())));
+        Datagram dg(gu::SharedBuffer(send_buf_.begin(), send_buf_.end()));
         if ((ret = send_user(dg, 0xff, ord, win, -1, n)) == 0)
         {
             while (n-- > 0)
@@ -2123,6 +2125,7 @@ void gcomm::evs::Proto::resend(const UUID& gap_source, const Range range)
         else
         {
             evs_log_debug(D_RETRANS) << "retransmitted " << um;
+            GU_PROBE2(gcomm, evs_retransmit, msg.seq(), msg.seq_range());
         }
         seq = seq + msg.seq_range() + 1;
         retrans_msgs_++;
@@ -3031,14 +3034,13 @@ void gcomm::evs::Proto::deliver_finish(const InputMapMsg& msg)
                                     offset));
             Datagram dg(
                 gu::SharedBuffer(
-                    new gu::Buffer(
-                        &msg.rb().payload()[0]
-                        + offset
-                        + am.serial_size(),
-                        &msg.rb().payload()[0]
-                        + offset
-                        + am.serial_size()
-                        + am.len())));
+                    &msg.rb().payload()[0]
+                    + offset
+                    + am.serial_size(),
+                    &msg.rb().payload()[0]
+                    + offset
+                    + am.serial_size()
+                    + am.len()));
             ProtoUpMeta um(msg.msg().source(),
                            msg.msg().source_view_id(),
                            0,
@@ -3086,7 +3088,13 @@ void gcomm::evs::Proto::deliver()
             (msg.msg().order() <= O_FIFO &&
              input_map_->is_fifo(i) == true))
         {
+            long long const start(gu::EventTrace::start());
             deliver_finish(msg);
+            gu::EventTrace::record(gu::EventTrace::EV_EVS_DELIVER,
+                                   InputMapMsgIndex::key(i).seq(),
+                                   InputMapMsgIndex::key(i).index(), start);
+            GU_PROBE2(gcomm, evs_deliver, InputMapMsgIndex::key(i).seq(),
+                      InputMapMsgIndex::key(i).index());
             gu_trace(input_map_->erase(i));
         }
         else
@@ -12,6 +12,7 @@
 #include <limits>
 
 #include <cstring>
+#include <cassert>
 #include <stdint.h>
 
 namespace gcomm
@@ -155,7 +156,7 @@ namespace gcomm
             :
             header_       (),
             header_offset_(header_size_),
-            payload_      (new gu::Buffer()),
+            payload_      (0),
             offset_       (0)
         { }
         /*!
@@ -171,7 +172,7 @@ namespace gcomm
             :
             header_       (),
             header_offset_(header_size_),
-            payload_      (new gu::Buffer(buf)),
+            payload_      (buf.begin(), buf.end()),
             offset_       (offset)
         {
             assert(offset_ <= payload_->size());
@@ -217,8 +218,8 @@ namespace gcomm
         void normalize()
         {
             const gu::SharedBuffer old_payload(payload_);
-            payload_ = gu::SharedBuffer(new gu::Buffer);
-            payload_->reserve(header_len() + old_payload->size() - offset_);
+            payload_ = gu::SharedBuffer(
+                header_len() + old_payload->size() - offset_);
 
             if (header_len() > offset_)
             {
@@ -16,6 +16,8 @@
 
 #include "gu_uri.hpp"
 
+#include <boost/shared_ptr.hpp>
+
 
 namespace gcomm
 {
@@ -0,0 +1,157 @@
+/* Copyright (C) 2017 Codership Oy <info@codership.com> */
+
+/*
+ * Microbenchmark for datagram payload buffer allocation.
+ *
+ * Runs the buffer handling of the gcomm message path: a copy of the
+ * message in gcomm_send(), a reference kept in the EVS send queue,
+ * aggregation of several messages into one buffer, a copy out of the
+ * socket receive buffer and a copy of every aggregated message on delivery.
+ * Heap allocations are counted by replacing global operator new.
+ *
+ * Usage: datagram_bench [messages [message size [aggregate]]]
+ */
+
+#include "gu_buffer.hpp"
+#include "gu_time.h"
+
+#include <boost/shared_ptr.hpp>
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <new>
+#include <cstdlib>
+
+static long long allocs(0);
+
+#if __cplusplus >= 201103L
+#define BENCH_THROW_BAD_ALLOC
+#else
+#define BENCH_THROW_BAD_ALLOC throw(std::bad_alloc)
+#endif
+
+void* operator new(size_t size) BENCH_THROW_BAD_ALLOC
+{
+    ++allocs;
+    void* const ret(::malloc(size ? size : 1));
+    if (!ret) throw std::bad_alloc();
+    return ret;
+}
+
+void operator delete(void* ptr) throw()
+{
+    ::free(ptr);
+}
+
+/* payload handling as it was before pooled buffers */
+struct Plain
+{
+    typedef boost::shared_ptr<gu::Buffer> Ptr;
+
+    static Ptr make(const gu::byte_t* b, const gu::byte_t* e)
+    {
+        return Ptr(new gu::Buffer(b, e));
+    }
+};
+
+struct Pooled
+{
+    typedef gu::SharedBuffer Ptr;
+
+    static Ptr make(const gu::byte_t* b, const gu::byte_t* e)
+    {
+        return Ptr(b, e);
+    }
+};
+
+template <class B>
+static void
+run(const char* const name, size_t const msgs, size_t const msg_size,
+    size_t const aggr)
+{
+    typedef typename B::Ptr Ptr;
+
+    std::vector<gu::byte_t> const msg(msg_size, 0xab);
+    std::vector<gu::byte_t> send_buf;
+    std::vector<gu::byte_t> recv_buf;
+    std::vector<Ptr>        send_queue;
+
+    send_buf.reserve(aggr * msg_size);
+    recv_buf.reserve(aggr * msg_size);
+
+    long long const allocs_before(allocs);
+    long long const start(gu_time_monotonic());
+
+    for (size_t i(0); i < msgs; i += aggr)
+    {
+        send_buf.clear();
+
+        for (size_t j(0); j < aggr; ++j)
+        {
+            // gcomm_send() copy
+            Ptr const dg(B::make(&msg[0], &msg[0] + msg.size()));
+            // kept in the send queue until delivered
+            send_queue.push_back(dg);
+            send_buf.insert(send_buf.end(), dg->begin(), dg->end());
+        }
+
+        // aggregated datagram
+        Ptr const aggregate(B::make(&send_buf[0],
+                                    &send_buf[0] + send_buf.size()));
+
+        // socket write and read back
+        recv_buf.assign(aggregate->begin(), aggregate->end());
+        Ptr const received(B::make(&recv_buf[0],
+                                   &recv_buf[0] + recv_buf.size()));
+
+        // aggregate unpacking and delivery
+        for (size_t j(0); j < aggr; ++j)
+        {
+            const gu::byte_t* const b(&(*received)[0] + j * msg_size);
+            Ptr const delivered(B::make(b, b + msg_size));
+            Ptr const up(delivered);
+            (void)up;
+        }
+
+        send_queue.clear();
+    }
+
+    long long const elapsed(gu_time_monotonic() - start);
+    long long const n(allocs - allocs_before);
+
+    std::cout << std::setw(12) << std::left << name
+              << " allocations/msg: " << std::setw(8)
+              << std::setprecision(3) << double(n) / msgs
+              << " ns/msg: " << double(elapsed) / msgs
+              << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    size_t const msgs    (argc > 1 ? ::strtoul(argv[1], NULL, 10) : 1000000);
+    size_t const msg_size(argc > 2 ? ::strtoul(argv[2], NULL, 10) : 200);
+    size_t const aggr    (argc > 3 ? ::strtoul(argv[3], NULL, 10) : 4);
+
+    if (msgs == 0 || msg_size == 0 || aggr == 0)
+    {
+        std::cerr << "Usage: " << argv[0]
+                  << " [messages [message size [aggregate]]]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    run<Plain>("shared_ptr", msgs, msg_size, aggr);
+
+    gu::SharedBuffer::pool_configure(0);
+    run<Pooled>("unpooled", msgs, msg_size, aggr);
+
+    gu::SharedBuffer::pool_configure(aggr * msg_size);
+    run<Pooled>("pooled", msgs, msg_size, aggr);
+
+    long long pool_allocs, pool_reuses;
+    gu::SharedBuffer::pool_stats(pool_allocs, pool_reuses);
+    std::cout << "pool allocs: " << pool_allocs
+              << ", reuses: " << pool_reuses << std::endl;
+
+    return EXIT_SUCCESS;
+}
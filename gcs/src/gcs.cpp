@@ -16,6 +16,7 @@
 #include <assert.h>
 
 #include <galerautils.h>
+#include <gu_thread.hpp>
 
 #include "gcs_priv.hpp"
 #include "gcs_params.hpp"
@@ -26,6 +27,11 @@
 #include "gcs_sm.hpp"
 #include "gcs_gcache.hpp"
 
+#include <gu_latency_histogram.hpp>
+#include <gu_probe.h>
+
+#include <new>
+
 const char* gcs_node_state_to_str (gcs_node_state_t state)
 {
     static const char* str[GCS_NODE_STATE_MAX + 1] =
@@ -92,6 +98,11 @@ static const char* gcs_conn_state_str[GCS_CONN_STATE_MAX] =
 static bool const GCS_FC_STOP = true;
 static bool const GCS_FC_CONT = false;
 
+#ifdef GCS_FOR_GARB
+/* garbd reports last applied seqno once in this many actions, power of 2 */
+#define GCS_GARB_REPORT_INTERVAL 128
+#endif /* GCS_FOR_GARB */
+
 /** Flow control message */
 struct gcs_fc_event
 {
@@ -176,6 +187,9 @@ struct gcs_conn
     bool        volatile need_to_join;
     gcs_seqno_t volatile join_seqno;
 
+    /* IST senders granted to the last state transfer request */
+    int          ist_stripes;
+
     /* sync control */
     bool         sync_sent_;
     bool         sync_sent() const
@@ -195,6 +209,11 @@ struct gcs_conn
 
     int inner_close_count; // how many times _close has been called.
     int outer_close_count; // how many times gcs_close has been called.
+
+    /* gcs_replv() latency: send monitor entry to core send return and
+     * core send return to delivery */
+    gu::LatencyHistogram* send_lat;
+    gu::LatencyHistogram* deliv_lat;
 };
 
 // Oh C++, where art thou?
@@ -204,16 +223,145 @@ struct gcs_recv_act
     gcs_seqno_t         local_id;
 };
 
+/* Wait primitives of a replicating thread. Those are created once per
+ * thread on its first gcs_replv() call and reused for every subsequent
+ * action, so that replication does not pay for mutex/cond initialization
+ * and destruction each time. */
+struct gcs_repl_wait
+{
+    gu_mutex_t            mutex;
+    gu_cond_t             cond;
+    pthread_t             owner;
+    struct gcs_repl_wait* next;
+};
+
+/* Contexts are freed by the key destructor on thread exit. The key lives
+ * only while there are GCS connections: the first gcs_create() creates it
+ * and the last gcs_destroy() deletes it together with the contexts of the
+ * threads that are still alive, so that no destructor pointing into this
+ * library is left behind after it is unloaded. */
+static pthread_mutex_t       _repl_wait_lock  = PTHREAD_MUTEX_INITIALIZER;
+static long                  _repl_wait_users = 0;
+static pthread_key_t         _repl_wait_key;
+static struct gcs_repl_wait* _repl_wait_list  = NULL; // all live contexts
+
+static void
+_repl_wait_free (struct gcs_repl_wait* const w)
+{
+    gu_cond_destroy  (&w->cond);
+    gu_mutex_destroy (&w->mutex);
+    gu_free (w);
+}
+
+static void
+_repl_wait_destroy (void* const arg)
+{
+    pthread_mutex_lock (&_repl_wait_lock);
+
+    /* context could have been freed by concurrent _repl_wait_key_delete(),
+     * so it is looked up rather than dereferenced */
+    for (struct gcs_repl_wait** p = &_repl_wait_list; *p; p = &(*p)->next)
+    {
+        if (*p == arg && pthread_equal ((*p)->owner, pthread_self()))
+        {
+            struct gcs_repl_wait* const w = *p;
+            *p = w->next;
+            _repl_wait_free (w);
+            break;
+        }
+    }
+
+    pthread_mutex_unlock (&_repl_wait_lock);
+}
+
+static long
+_repl_wait_key_create ()
+{
+    int err = 0;
+
+    pthread_mutex_lock (&_repl_wait_lock);
+
+    if (0 == _repl_wait_users)
+    {
+        err = pthread_key_create (&_repl_wait_key, _repl_wait_destroy);
+    }
+
+    if (0 == err) ++_repl_wait_users;
+
+    pthread_mutex_unlock (&_repl_wait_lock);
+
+    return -err;
+}
+
+static void
+_repl_wait_key_delete ()
+{
+    pthread_mutex_lock (&_repl_wait_lock);
+
+    assert (_repl_wait_users > 0);
+
+    if (0 == --_repl_wait_users)
+    {
+        pthread_key_delete (_repl_wait_key);
+
+        while (_repl_wait_list)
+        {
+            struct gcs_repl_wait* const w = _repl_wait_list;
+            _repl_wait_list = w->next;
+            _repl_wait_free (w);
+        }
+    }
+
+    pthread_mutex_unlock (&_repl_wait_lock);
+}
+
+static inline struct gcs_repl_wait*
+_repl_wait_get ()
+{
+    struct gcs_repl_wait* w =
+        (struct gcs_repl_wait*)pthread_getspecific (_repl_wait_key);
+
+    if (gu_unlikely(NULL == w))
+    {
+        w = GU_MALLOC (struct gcs_repl_wait);
+
+        if (NULL != w)
+        {
+            gu_mutex_init (&w->mutex, NULL);
+            gu_cond_init  (&w->cond,  NULL);
+            w->owner = pthread_self();
+
+            if (pthread_setspecific (_repl_wait_key, w))
+            {
+                _repl_wait_free (w);
+                return NULL;
+            }
+
+            pthread_mutex_lock (&_repl_wait_lock);
+            w->next = _repl_wait_list;
+            _repl_wait_list = w;
+            pthread_mutex_unlock (&_repl_wait_lock);
+        }
+    }
+
+    return w;
+}
+
 struct gcs_repl_act
 {
-    const struct gu_buf* act_in;
-    struct gcs_action*   action;
-    gu_mutex_t           wait_mutex;
-    gu_cond_t            wait_cond;
-    gcs_repl_act(const struct gu_buf* a_act_in, struct gcs_action* a_action)
+    const struct gu_buf*  act_in;
+    struct gcs_action*    action;
+    gu_mutex_t&           wait_mutex;
+    gu_cond_t&            wait_cond;
+    bool                  done;  // set by recv thread, guards wait_cond
+    gcs_repl_act(const struct gu_buf* a_act_in, struct gcs_action* a_action,
+                 struct gcs_repl_wait& wait)
       :
-        act_in(a_act_in),
-        action(a_action)
+        act_in    (a_act_in),
+        action    (a_action),
+        wait_mutex(wait.mutex),
+        wait_cond (wait.cond),
+        done      (false)
     { }
 };
 
@@ -317,20 +465,41 @@ gcs_create (gu_config_t* const conf, gcache_t* const gcache,
         goto sm_create_failed;
     }
 
+    conn->send_lat  = new (std::nothrow) gu::LatencyHistogram();
+    conn->deliv_lat = new (std::nothrow) gu::LatencyHistogram();
+
+    if (!conn->send_lat || !conn->deliv_lat) {
+        gu_error ("Failed to allocate latency histograms");
+        goto lat_alloc_failed;
+    }
+
     conn->state        = GCS_CONN_CLOSED;
     conn->my_idx       = -1;
     conn->local_act_id = GCS_SEQNO_FIRST;
     conn->global_seqno = 0;
     conn->fc_offset    = 0;
     conn->timeout      = GU_TIME_ETERNITY;
+    conn->ist_stripes  = 1;
     conn->gcache       = gcache;
     conn->max_fc_state = conn->params.sync_donor ?
         GCS_CONN_DONOR : GCS_CONN_JOINED;
 
+    if (_repl_wait_key_create()) {
+        gu_error ("Failed to create replication wait context key");
+        goto wait_key_failed;
+    }
+
     gu_mutex_init (&conn->fc_lock, NULL);
 
     return conn; // success
 
+wait_key_failed:
+lat_alloc_failed:
+
+    delete conn->send_lat;
+    delete conn->deliv_lat;
+    gcs_sm_destroy (conn->sm);
+
 sm_create_failed:
 
     gu_fifo_destroy (conn->recv_q);
@@ -447,6 +616,7 @@ gcs_fc_stop_end (gcs_conn_t* conn)
         if (ret >= 0) {
             ret = 0;
             conn->stats_fc_stop_sent++;
+            GU_PROBE1(gcs, fc_stop_sent, conn->queue_len);
         }
         else {
             assert (conn->stop_sent() > 0);
@@ -510,6 +680,7 @@ gcs_fc_cont_end (gcs_conn_t* conn)
         if (gu_likely (ret >= 0)) {
             ret = 0;
             conn->stats_fc_cont_sent++;
+            GU_PROBE1(gcs, fc_cont_sent, conn->queue_len);
         }
         else {
             /* restore counter */
@@ -848,6 +1019,7 @@ gcs_handle_flow_control (gcs_conn_t*                conn,
 
     conn->stop_count += ((fc->stop != 0) << 1) - 1; // +1 if !0, -1 if 0
     conn->stats_fc_received += (fc->stop != 0);
+    GU_PROBE2(gcs, fc_received, fc->stop, conn->stop_count);
 
     if (1 == conn->stop_count) {
         gcs_sm_pause (conn->sm);    // first STOP request
@@ -1228,6 +1400,7 @@ _close(gcs_conn_t* conn, bool join_recv_thread)
              * they'll quit on their own,
              * they don't depend on the conn object after waking */
             gu_mutex_lock   (&act->wait_mutex);
+            act->done = true;
             gu_cond_signal  (&act->wait_cond);
             gu_mutex_unlock (&act->wait_mutex);
         }
@@ -1249,6 +1422,7 @@ _close(gcs_conn_t* conn, bool join_recv_thread)
  */
 static void *gcs_recv_thread (void *arg)
 {
+    gu::RegisteredThread const reg("gcs_recv");
     gcs_conn_t* conn = (gcs_conn_t*)arg;
     ssize_t     ret  = -ECONNABORTED;
 
@@ -1335,9 +1509,25 @@ static void *gcs_recv_thread (void *arg)
             repl_act->action->seqno_l = this_act_id;
 
             gu_mutex_lock   (&repl_act->wait_mutex);
+            repl_act->done = true;
             gu_cond_signal  (&repl_act->wait_cond);
             gu_mutex_unlock (&repl_act->wait_mutex);
         }
+#ifdef GCS_FOR_GARB
+        else if (GCS_ACT_TORDERED == rcvd.act.type && NULL == conn->gcache &&
+                 gu_likely(this_act_id >= 0))
+        {
+            /* Payload was not reassembled and there is nothing to deliver:
+             * skip the queue and report progress right here. Recv thread must
+             * not wait in the send monitor, so go straight to core. */
+            assert (NULL == rcvd.act.buf);
+
+            if (gu_unlikely(!(rcvd.id & (GCS_GARB_REPORT_INTERVAL - 1))))
+            {
+                (void)gcs_core_set_last_applied (conn->core, rcvd.id);
+            }
+        }
+#endif /* GCS_FOR_GARB */
         else if (gu_likely(this_act_id >= 0))
         {
             /* remote/non-repl'ed action */
@@ -1553,6 +1743,11 @@ long gcs_destroy (gcs_conn_t *conn)
 
     _cleanup_params (conn);
 
+    delete conn->send_lat;
+    delete conn->deliv_lat;
+
+    _repl_wait_key_delete();
+
     gu_free (conn);
 
     return 0;
@@ -1597,9 +1792,9 @@ long gcs_interrupt (gcs_conn_t* conn, long handle)
     return gcs_sm_interrupt (conn->sm, handle);
 }
 
-gcs_seqno_t gcs_caused(gcs_conn_t* conn)
+gcs_seqno_t gcs_caused(gcs_conn_t* conn, long long const lease)
 {
-    return gcs_core_caused(conn->core);
+    return gcs_core_caused(conn->core, lease);
 }
 
 /* Puts action in the send queue and returns after it is replicated */
@@ -1618,11 +1813,13 @@ long gcs_replv (gcs_conn_t*          const conn,      //!<in
     act->seqno_l = GCS_SEQNO_ILL;
     act->seqno_g = GCS_SEQNO_ILL;
 
+    struct gcs_repl_wait* const wait(_repl_wait_get());
+    if (gu_unlikely(NULL == wait)) return -ENOMEM;
+
     /* This is good - we don't have to do a copy because we wait */
-    struct gcs_repl_act repl_act(act_in, act);
+    struct gcs_repl_act repl_act(act_in, act, *wait);
 
-    gu_mutex_init (&repl_act.wait_mutex, NULL);
-    gu_cond_init  (&repl_act.wait_cond,  NULL);
+    long long const start(gu::LatencyHistogram::start());
 
     /* Send action and wait for signal from recv_thread
      * we need to lock a mutex before we can go wait for signal */
@@ -1680,8 +1877,21 @@ long gcs_replv (gcs_conn_t*          const conn,      //!<in
 
             /* now we can go waiting for action delivery */
             if (ret >= 0) {
-                gu_cond_wait (&repl_act.wait_cond, &repl_act.wait_mutex);
-#ifndef GCS_FOR_GARB
+                conn->send_lat->record_since(start);
+                long long const sent(gu::LatencyHistogram::start());
+
+                while (!repl_act.done) {
+                    gu_cond_wait (&repl_act.wait_cond, &repl_act.wait_mutex);
+                }
+
+                conn->deliv_lat->record_since(sent);
+#ifdef GCS_FOR_GARB
+                if (NULL == conn->gcache) {
+                    /* payload is not stored */
+                    assert (act->buf == 0);
+                }
+                else
+#endif /* GCS_FOR_GARB */
                 /* assert (act->buf != 0); */
                 if (act->buf == 0)
                 {
@@ -1689,9 +1899,6 @@ long gcs_replv (gcs_conn_t*          const conn,      //!<in
                     ret = -ENOTCONN;
                     goto out;
                 }
-#else
-                assert (act->buf == 0);
-#endif /* GCS_FOR_GARB */
 
                 if (act->seqno_g < 0) {
                     assert (GCS_SEQNO_ILL    == act->seqno_l ||
@@ -1719,13 +1926,9 @@ long gcs_replv (gcs_conn_t*          const conn,      //!<in
                 }
             }
         }
-#ifndef GCS_FOR_GARB
     out:
-#endif /* GCS_FOR_GARB */
         gu_mutex_unlock  (&repl_act.wait_mutex);
     }
-    gu_mutex_destroy (&repl_act.wait_mutex);
-    gu_cond_destroy  (&repl_act.wait_cond);
 
 #ifdef GCS_DEBUG_GCS
 //    gu_debug ("\nact_size = %u\nact_type = %u\n"
@@ -1752,6 +1955,12 @@ long gcs_request_state_transfer (gcs_conn_t  *conn,
 
     *local = GCS_SEQNO_ILL;
 
+    if (gcs_core_group_protocol_version(conn->core) <
+        GCS_STR_STRIPES_PROTO) {
+        // group members may not understand stripe request
+        version &= GCS_STR_VER_MASK;
+    }
+
     if (rst) {
         gu_debug("ist_uuid[" GU_UUID_FORMAT "], ist_seqno[%lld]",
                  GU_UUID_ARGS(ist_uuid), (long long)ist_seqno);
@@ -1764,7 +1973,7 @@ long gcs_request_state_transfer (gcs_conn_t  *conn,
          * NOTE: this is sender part. Check gcs_group_handle_state_request()
          *       for the receiver part. */
 
-        if (version < 2) {
+        if ((version & GCS_STR_VER_MASK) < 2) {
             memcpy (rst + offset, donor, donor_len);
             offset += donor_len;
             memcpy (rst + offset, req, size);
@@ -1773,6 +1982,7 @@ long gcs_request_state_transfer (gcs_conn_t  *conn,
 
         // version 2(expose joiner's seqno and smart donor selection)
         // RST format: |donor_name|\0|'V'|version|ist_uuid|ist_seqno|app_request|
+        // upper bits of version may carry number of IST stripes requested.
 
         // we expect 'version' could be hold by 'char'
         // since app_request v0 starts with sst method name
@@ -1804,19 +2014,21 @@ long gcs_request_state_transfer (gcs_conn_t  *conn,
 
         if (ret > 0) {
             assert (action.buf != rst);
-#ifndef GCS_FOR_GARB
-            assert (action.buf != NULL);
-            gcs_gcache_free (conn->gcache, action.buf);
+#ifdef GCS_FOR_GARB
+            if (NULL != action.buf)
 #else
-            assert (action.buf == NULL);
+            assert (action.buf != NULL);
 #endif
+            gcs_gcache_free (conn->gcache, action.buf);
             assert (ret == (ssize_t)rst_size);
             assert (action.seqno_g >= 0);
             assert (action.seqno_l >  0);
 
-            // on joiner global seqno stores donor index
+            // on joiner global seqno stores donor index (and number of
+            // IST stripe helpers, see gcs_group_handle_state_request())
             // on donor global seqno stores global seqno
-            ret = action.seqno_g;
+            ret = action.seqno_g % GCS_STR_STRIPE_UNIT;
+            conn->ist_stripes = action.seqno_g / GCS_STR_STRIPE_UNIT + 1;
         }
         else {
             assert (/*action.buf == NULL ||*/ action.buf == rst);
@@ -1826,6 +2038,11 @@ long gcs_request_state_transfer (gcs_conn_t  *conn,
     return ret;
 }
 
+int gcs_ist_stripes (gcs_conn_t* conn)
+{
+    return conn->ist_stripes;
+}
+
 long gcs_desync (gcs_conn_t* conn, gcs_seqno_t* local)
 {
     gu_uuid_t ist_uuid = {{0, }};
@@ -2031,6 +2248,12 @@ gcs_get_stats (gcs_conn_t* conn, struct gcs_stats* stats)
     stats->fc_ssent    = conn->stats_fc_stop_sent;
     stats->fc_csent    = conn->stats_fc_cont_sent;
     stats->fc_received = conn->stats_fc_received;
+
+    gcs_core_causal_stats (conn->core,
+                           &stats->causal_reqs,
+                           &stats->causal_msgs,
+                           &stats->causal_leased,
+                           false);
 }
 
 void
@@ -2041,6 +2264,12 @@ gcs_flush_stats(gcs_conn_t* conn)
     conn->stats_fc_stop_sent = 0;
     conn->stats_fc_cont_sent = 0;
     conn->stats_fc_received  = 0;
+
+    long long reqs, msgs, leased;
+    gcs_core_causal_stats (conn->core, &reqs, &msgs, &leased, true);
+
+    conn->send_lat->clear();
+    conn->deliv_lat->clear();
 }
 
 void gcs_get_status(gcs_conn_t* conn, gu::Status& status)
@@ -2049,6 +2278,9 @@ void gcs_get_status(gcs_conn_t* conn, gu::Status& status)
     {
         gcs_core_get_status(conn->core, status);
     }
+
+    status.insert("gcs_send_latency",     conn->send_lat->to_string());
+    status.insert("gcs_delivery_latency", conn->deliv_lat->to_string());
 }
 
 static long
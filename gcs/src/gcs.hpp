@@ -279,17 +279,26 @@ extern long gcs_resume_recv (gcs_conn_t* conn);
 /*!
  * After action with this seqno is applied, this thread is guaranteed to see
  * all the changes made by the client, even on other nodes.
+ * Concurrent callers are served by a single causal message where possible,
+ * see gcs_stats::causal_reqs and gcs_stats::causal_msgs.
+ *
+ * @param lease if positive, a causal seqno obtained by this node less than
+ *              lease nanoseconds ago may be returned without a total order
+ *              round trip. In that case the result is guaranteed to cover
+ *              only the changes made before that seqno was obtained, i.e.
+ *              the staleness of the result is bounded by lease.
  *
  * @return global sequence number or negative error code
  */
-extern gcs_seqno_t gcs_caused(gcs_conn_t* conn);
+extern gcs_seqno_t gcs_caused(gcs_conn_t* conn, long long lease = 0);
 
 /*! @brief Sends state transfer request
  * Broadcasts state transfer request which will be passed to one of the
  * suitable group members.
  *
  * @param conn  connection to group
- * @param ver   STR version.
+ * @param ver   STR version. From version 2 on the upper bits may carry the
+ *              number of IST stripes requested, see GCS_STR_STRIPES_SHIFT.
  * @param req   opaque byte array that contains data required for
  *              the state transfer (application dependent)
  * @param size  request size
@@ -310,6 +319,29 @@ extern long gcs_request_state_transfer (gcs_conn_t  *conn,
                                         gcs_seqno_t ist_seqno,
                                         gcs_seqno_t *seqno);
 
+/*! IST striping.
+ * Joiner may ask for its IST range to be served in parallel by several nodes:
+ * (stripes - 1) << GCS_STR_STRIPES_SHIFT is or'ed to STR version.
+ * Besides the donor the group then chooses up to (stripes - 1) other synced
+ * nodes which have the whole IST range in cache. Those receive the request as
+ * GCS_ACT_STATE_REQ with GCS_STR_STRIPE_HELPER global seqno and should only
+ * connect to joiner's IST receiver, there is no state change for them. */
+#define GCS_STR_VER_MASK      0x0f
+#define GCS_STR_STRIPES_SHIFT 4
+#define GCS_STR_STRIPES_MAX   16
+#define GCS_STR_STRIPE_HELPER (-(1LL << 20))
+/*! Joiner receives donor index + (number of IST stripe helpers) * this unit
+ *  in the state request action id, see gcs_request_state_transfer() */
+#define GCS_STR_STRIPE_UNIT   (1 << 16)
+/*! Lowest group protocol version at which stripes may be requested: older
+ *  nodes read STR version byte as signed char. Below it the stripe bits are
+ *  cleared by gcs_request_state_transfer(). */
+#define GCS_STR_STRIPES_PROTO 1
+
+/*! @return number of IST senders (donor included) granted to the last
+ *          successful state transfer request made by this node */
+extern int gcs_ist_stripes (gcs_conn_t* conn);
+
 /*! @brief Turns off flow control on the node.
  * Effectively desynchronizes the node from the cluster (while the node keeps on
  * receiving all the actions). Requires gcs_join() to return to normal.
@@ -441,6 +473,9 @@ struct gcs_stats
     int       send_q_len;     //! current send queue length
     int       send_q_len_max; //! maximum send queue length
     int       send_q_len_min; //! minimum send queue length
+    long long causal_reqs;    //! causal requests served
+    long long causal_msgs;    //! causal messages sent to serve them
+    long long causal_leased;  //! causal requests served from lease
     gcs_backend_stats_t backend_stats; //! backend stats.
 };
 
@@ -454,4 +489,9 @@ void gcs_get_status(gcs_conn_t* conn, gu::Status& status);
 /*! A node with this name will be treated as a stateless arbitrator */
 #define GCS_ARBITRATOR_NAME "garb"
 
+/*! Lowest group protocol version at which arbitrators caching write sets
+ *  are excluded from IST donor selection and preferred as stripe helpers.
+ *  Below it all members select donors the way older nodes do. */
+#define GCS_ARBITRATOR_CACHE_PROTO GCS_STR_STRIPES_PROTO
+
 #endif // _gcs_h_
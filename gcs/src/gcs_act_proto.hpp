@@ -5,7 +5,7 @@
  */
 /*
  * Interface to action protocol
- * (to be extended to support protocol versions, currently supports only v0)
+ * (to be extended to support protocol versions, v1 is the same as v0)
  */
 
 #ifndef _gcs_act_proto_h_
@@ -17,8 +17,9 @@
 #include <stdint.h>
 typedef uint8_t gcs_proto_t;
 
-/*! Supported protocol range (for now only version 0 is supported) */
-#define GCS_ACT_PROTO_MAX 0
+/*! Supported protocol range (version 1 has the same format as 0, it follows
+ *  group protocol version, see gcs_core.cpp) */
+#define GCS_ACT_PROTO_MAX 1
 
 /*! Internal action fragment data representation */
 typedef struct gcs_act_frag
@@ -21,6 +21,7 @@
 #include "gcs_gcache.hpp"
 
 #include "gu_debug_sync.hpp"
+#include "gu_event_trace.hpp"
 
 #include <string.h> // for mempcpy
 #include <errno.h>
@@ -75,6 +76,18 @@ struct gcs_core
     /* group context */
     gcs_group_t     group;
 
+    /* causal requests */
+    gu_mutex_t      causal_lock;
+    gu_cond_t       causal_cond;     // signaled when in-flight batch returns
+    struct causal_act* causal_next;  // batch collecting waiters, not sent yet
+    bool            causal_in_flight;
+    long long       causal_reqs;     // causal requests served
+    long long       causal_msgs;     // causal messages sent
+    long long       causal_leased;   // causal requests served from lease
+    gcs_seqno_t     lease_seqno;     // causal seqno known at lease_time
+    long long       lease_time;      // when lease_seqno was valid, 0 - never
+    long long       last_sent_time;  // own unconfirmed GCS_MSG_LAST sent at
+
     /* backend part */
     size_t          msg_size;
     gcs_backend_t   backend;   // message IO context
@@ -94,14 +107,38 @@ typedef struct core_act
 }
 core_act_t;
 
+/* Causal requests that arrive while another causal message is in flight
+ * are collected in a batch which is sent as a single GCS_MSG_CAUSAL once
+ * the in-flight message returns. Since the batch is sent strictly after
+ * every member has joined it, returned seqno is valid for all of them. */
 typedef struct causal_act
 {
-    gcs_seqno_t* act_id;
-    gu_mutex_t*  mtx;
-    gu_cond_t*   cond;
+    gcs_seqno_t act_id;
+    long long   sent;    // monotonic time the message was sent at
+    gu_cond_t   cond;
+    long        waiters;
+    bool        done;
 } causal_act_t;
 
-static int const GCS_PROTO_MAX = 0;
+/* Causal lease: every total order round trip initiated by this node
+ * (causal messages and last applied reports) tells us a seqno which was
+ * the group-wide causal seqno at the moment the message was sent. Callers
+ * which accept bounded staleness may reuse it for the duration of lease
+ * instead of sending a new causal message. Must be called under
+ * causal_lock. */
+static inline void
+core_lease_update (gcs_core_t* core, long long const sent)
+{
+    if (GCS_GROUP_PRIMARY == core->group.state && sent > core->lease_time)
+    {
+        core->lease_seqno = core->group.act_id_;
+        core->lease_time  = sent;
+    }
+}
+
+/* 1: IST stripe requests in the upper bits of STR version byte,
+ *    action protocol is the same as in 0 */
+static int const GCS_PROTO_MAX = 1;
 
 gcs_core_t*
 gcs_core_create (gu_config_t* const conf,
@@ -135,6 +172,10 @@ gcs_core_create (gu_config_t* const conf,
                                                    sizeof (core_act_t));
                 if (core->fifo) {
                     gu_mutex_init  (&core->send_lock, NULL);
+                    gu_mutex_init  (&core->causal_lock, NULL);
+                    gu_cond_init   (&core->causal_cond, NULL);
+                    core->causal_next      = NULL;
+                    core->causal_in_flight = false;
                     core->proto_ver = -1; // shall be bumped in gcs_group_act_conf()
                     gcs_group_init (&core->group, cache, node_name, inc_addr,
                                     GCS_PROTO_MAX, repl_proto_ver,
@@ -311,6 +352,7 @@ gcs_core_send (gcs_core_t*          const conn,
     ssize_t        send_size;
     const unsigned char proto_ver = conn->proto_ver;
     const ssize_t  hdr_size       = gcs_act_proto_hdr_size (proto_ver);
+    const long long start         = gu::EventTrace::start();
 
     core_act_t*    local_act;
 
@@ -451,6 +493,8 @@ gcs_core_send (gcs_core_t*          const conn,
     conn->send_act_no++;
     ret = sent;
 
+    gu::EventTrace::record(gu::EventTrace::EV_CORE_SEND, -1, ret, start);
+
 out:
 //    gu_debug ("returning: %d (%s)", ret, strerror(-ret));
     return ret;
@@ -552,7 +596,7 @@ core_handle_act_msg (gcs_core_t*          core,
 #ifndef GCS_FOR_GARB
             assert (NULL != act->act.buf);
 #else
-            assert (NULL == act->act.buf);
+            assert ((NULL == act->act.buf) == (NULL == core->cache));
 #endif
             act->sender_idx = msg->sender_idx;
 
@@ -609,6 +653,7 @@ core_handle_act_msg (gcs_core_t*          core,
                             // act->id != GCS_SEQNO_ILL (most likely act->id == -EAGAIN)
                             core->state == CORE_PRIMARY)) {
 #ifdef GCS_FOR_GARB
+            if (NULL == core->cache) {
             /* ignoring state requests from other nodes (not allocated) */
             if (my_msg) {
                 if (act->act.buf_len != act->local[0].size) {
@@ -617,10 +662,8 @@ core_handle_act_msg (gcs_core_t*          core,
                     abort();
                 }
                 act->act.buf = act->local[0].ptr;
-#endif
                 ret = gcs_group_handle_state_request (group, act);
                 assert (ret <= 0 || ret == act->act.buf_len);
-#ifdef GCS_FOR_GARB
                 if (ret < 0) gu_fatal ("Handling state request failed: %d",ret);
                 act->act.buf = NULL;
             }
@@ -631,7 +674,14 @@ core_handle_act_msg (gcs_core_t*          core,
                 act->sender_idx  = -1;
                 ret = 0;
             }
-#endif
+            }
+            else /* caching garbd handles them like any node, see
+                  * group_select_ist_helpers() */
+#endif /* GCS_FOR_GARB */
+            {
+                ret = gcs_group_handle_state_request (group, act);
+                assert (ret <= 0 || ret == act->act.buf_len);
+            }
             }
 //          gu_debug ("Received action: seqno: %lld, sender: %d, size: %d, "
 //                    "act: %p", act->id, msg->sender_idx, ret, act->buf);
@@ -672,6 +722,13 @@ core_handle_last_msg (gcs_core_t*          core,
 {
     assert (GCS_MSG_LAST == msg->type);
 
+    if (gcs_group_my_idx(&core->group) == msg->sender_idx) {
+        gu_mutex_lock (&core->causal_lock);
+        core_lease_update (core, core->last_sent_time);
+        core->last_sent_time = 0;
+        gu_mutex_unlock (&core->causal_lock);
+    }
+
     if (gcs_group_is_primary(&core->group)) {
         gcs_seqno_t commit_cut =
             gcs_group_handle_last_msg (&core->group, msg);
@@ -719,6 +776,12 @@ core_handle_comp_msg (gcs_core_t*          core,
         return 0;
     }
 
+    /* causal lease does not survive configuration change */
+    gu_mutex_lock (&core->causal_lock);
+    core->lease_time     = 0;
+    core->last_sent_time = 0;
+    gu_mutex_unlock (&core->causal_lock);
+
     if (gu_mutex_lock (&core->send_lock)) abort();
     ret = gcs_group_handle_comp_msg (group, (const gcs_comp_msg_t*)msg->buf);
 
@@ -1022,10 +1085,10 @@ static long core_msg_causal(gcs_core_t* conn,
                             struct gcs_recv_msg* msg)
 {
     causal_act_t* act;
-    if (gu_unlikely(msg->size != sizeof(*act)))
+    if (gu_unlikely(msg->size != sizeof(act)))
     {
         gu_error("invalid causal act len %ld, expected %ld",
-                 msg->size, sizeof(*act));
+                 msg->size, sizeof(act));
         return -EPROTO;
     }
 
@@ -1033,11 +1096,15 @@ static long core_msg_causal(gcs_core_t* conn,
         GCS_GROUP_PRIMARY == conn->group.state ?
         conn->group.act_id_ : GCS_SEQNO_ILL;
 
-    act = (causal_act_t*)msg->buf;
-    gu_mutex_lock(act->mtx);
-    *act->act_id = causal_seqno;
-    gu_cond_signal(act->cond);
-    gu_mutex_unlock(act->mtx);
+    memcpy(&act, msg->buf, sizeof(act));
+    gu_mutex_lock(&conn->causal_lock);
+    core_lease_update(conn, act->sent);
+    act->act_id = causal_seqno;
+    act->done   = true;
+    conn->causal_in_flight = false;
+    gu_cond_broadcast(&act->cond);
+    gu_cond_signal(&conn->causal_cond);
+    gu_mutex_unlock(&conn->causal_lock);
     return msg->size;
 }
 
@@ -1134,7 +1201,11 @@ out:
 
 //    gu_debug ("Returning %d", ret);
 
-    if (ret < 0) {
+    if (gu_likely(ret > 0)) {
+        gu::EventTrace::record(gu::EventTrace::EV_CORE_RECV, recv_act->id,
+                               recv_act->act.type);
+    }
+    else if (ret < 0) {
         assert (recv_act->id < 0);
 
         if (GCS_ACT_TORDERED == recv_act->act.type && recv_act->act.buf) {
@@ -1197,6 +1268,9 @@ long gcs_core_destroy (gcs_core_t* core)
 
     /* after that we must be able to destroy mutexes */
     while (gu_mutex_destroy (&core->send_lock));
+    assert (NULL == core->causal_next);
+    gu_cond_destroy (&core->causal_cond);
+    while (gu_mutex_destroy (&core->causal_lock));
     /* now noone will interfere */
     while ((tmp = (core_act_t*)gcs_fifo_lite_get_head (core->fifo))) {
         // whatever is in tmp.action is allocated by app., just forget it.
@@ -1298,6 +1372,12 @@ core_send_seqno (gcs_core_t* core, gcs_seqno_t seqno, gcs_msg_type_t msg_type)
 long
 gcs_core_set_last_applied (gcs_core_t* core, gcs_seqno_t seqno)
 {
+    /* if the previous report is not confirmed yet, keep its (older) time:
+     * it is safe to underestimate lease freshness but not overestimate it */
+    gu_mutex_lock (&core->causal_lock);
+    if (0 == core->last_sent_time) core->last_sent_time = gu_time_monotonic();
+    gu_mutex_unlock (&core->causal_lock);
+
     return core_send_seqno (core, seqno, GCS_MSG_LAST);
 }
 
@@ -1325,37 +1405,116 @@ gcs_core_send_fc (gcs_core_t* core, const void* fc, size_t fc_size)
 }
 
 gcs_seqno_t
-gcs_core_caused(gcs_core_t* core)
+gcs_core_caused(gcs_core_t* core, long long const lease)
 {
-    long         ret;
-    gcs_seqno_t  act_id = GCS_SEQNO_ILL;
-    gu_mutex_t   mtx;
-    gu_cond_t    cond;
-    causal_act_t act = {&act_id, &mtx, &cond};
-
-    gu_mutex_init (&mtx, NULL);
-    gu_cond_init  (&cond, NULL);
-    gu_mutex_lock (&mtx);
+    gcs_seqno_t   act_id;
+    causal_act_t* act;
+    bool          leader(false);
+
+    gu_mutex_lock (&core->causal_lock);
+
+    core->causal_reqs++;
+
+    if (lease > 0 && core->lease_time > 0 &&
+        gu_time_monotonic() - core->lease_time < lease)
     {
-        ret = core_msg_send_retry (core, &act, sizeof(act), GCS_MSG_CAUSAL);
+        core->causal_leased++;
+        act_id = core->lease_seqno;
+        gu_mutex_unlock (&core->causal_lock);
+        return act_id;
+    }
 
-        if (ret == sizeof(act))
+    if (NULL == core->causal_next)
+    {
+        act = GU_CALLOC(1, causal_act_t);
+
+        if (gu_unlikely(NULL == act))
         {
-            gu_cond_wait (&cond, &mtx);
+            gu_mutex_unlock (&core->causal_lock);
+            return -ENOMEM;
         }
-        else
+
+        act->act_id = GCS_SEQNO_ILL;
+        gu_cond_init (&act->cond, NULL);
+        core->causal_next = act;
+        leader = true;
+    }
+    else
+    {
+        act = core->causal_next;
+    }
+
+    act->waiters++;
+
+    if (leader)
+    {
+        /* keep collecting waiters until the previous message returns */
+        while (core->causal_in_flight)
+        {
+            gu_cond_wait (&core->causal_cond, &core->causal_lock);
+        }
+
+        core->causal_next      = NULL;
+        core->causal_in_flight = true;
+        core->causal_msgs++;
+        act->sent = gu_time_monotonic();
+
+        gu_mutex_unlock (&core->causal_lock);
+
+        long const ret(core_msg_send_retry (core, &act, sizeof(act),
+                                            GCS_MSG_CAUSAL));
+
+        gu_mutex_lock (&core->causal_lock);
+
+        if (ret != sizeof(act))
         {
             assert (ret < 0);
-            act_id = ret;
+            act->act_id = ret;
+            act->done   = true;
+            core->causal_in_flight = false;
+            gu_cond_broadcast (&act->cond);
+            gu_cond_signal (&core->causal_cond);
         }
     }
-    gu_mutex_unlock  (&mtx);
-    gu_mutex_destroy (&mtx);
-    gu_cond_destroy  (&cond);
+
+    while (!act->done)
+    {
+        gu_cond_wait (&act->cond, &core->causal_lock);
+    }
+
+    act_id = act->act_id;
+
+    if (0 == --act->waiters)
+    {
+        gu_cond_destroy (&act->cond);
+        gu_free (act);
+    }
+
+    gu_mutex_unlock (&core->causal_lock);
 
     return act_id;
 }
 
+void
+gcs_core_causal_stats (gcs_core_t* core,
+                       long long*  reqs,
+                       long long*  msgs,
+                       long long*  leased,
+                       bool        flush)
+{
+    gu_mutex_lock (&core->causal_lock);
+    *reqs   = core->causal_reqs;
+    *msgs   = core->causal_msgs;
+    *leased = core->causal_leased;
+    if (flush)
+    {
+        core->causal_reqs   = 0;
+        core->causal_msgs   = 0;
+        core->causal_leased = 0;
+    }
+    gu_mutex_unlock (&core->causal_lock);
+}
+
 long
 gcs_core_param_set (gcs_core_t* core, const char* key, const char* value)
 {
@@ -154,8 +154,20 @@ gcs_core_send_sync (gcs_core_t* core, gcs_seqno_t seqno);
 extern long
 gcs_core_send_fc (gcs_core_t* core, const void* fc, size_t fc_size);
 
+/* returns causal seqno. If lease is positive, seqno learned by this node
+ * less than lease nanoseconds ago may be returned without sending a causal
+ * message */
 extern gcs_seqno_t
-gcs_core_caused(gcs_core_t* core);
+gcs_core_caused(gcs_core_t* core, long long lease);
+
+/* returns the number of causal requests served, causal messages sent and
+ * requests served from causal lease */
+extern void
+gcs_core_causal_stats (gcs_core_t* core,
+                       long long*  reqs,
+                       long long*  msgs,
+                       long long*  leased,
+                       bool        flush);
 
 extern long
 gcs_core_param_set (gcs_core_t* core, const char* key, const char* value);
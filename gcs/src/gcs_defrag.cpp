@@ -69,16 +69,16 @@ gcs_defrag_handle_frag (gcs_defrag_t*         df,
 
                     df->size = frg->act_size;
 
-#ifndef GCS_FOR_GARB
-                    if (df->cache !=NULL) {
-                        gcache_free (df->cache, df->head);
+                    if (GCS_DEFRAG_KEEPS_PAYLOAD(df)) {
+                        if (df->cache !=NULL) {
+                            gcache_free (df->cache, df->head);
+                        }
+                        else {
+                            free ((void*)df->head);
+                        }
+
+                        DF_ALLOC();
                     }
-                    else {
-                        free ((void*)df->head);
-                    }
-
-                    DF_ALLOC();
-#endif /* GCS_FOR_GARB */
                 }
             }
             else if (frg->act_id == df->sent_id && frg->frag_no < df->frag_no) {
@@ -109,13 +109,14 @@ gcs_defrag_handle_frag (gcs_defrag_t*         df,
             df->sent_id = frg->act_id;
             df->reset   = false;
 
-#ifndef GCS_FOR_GARB
-            DF_ALLOC();
-#else
-            /* we don't store actions locally at all */
-            df->head = NULL;
-            df->tail = df->head;
-#endif
+            if (GCS_DEFRAG_KEEPS_PAYLOAD(df)) {
+                DF_ALLOC();
+            }
+            else {
+                /* we don't store actions locally at all */
+                df->head = NULL;
+                df->tail = df->head;
+            }
         }
         else {
             /* not a first fragment */
@@ -143,15 +144,16 @@ gcs_defrag_handle_frag (gcs_defrag_t*         df,
     df->received += frg->frag_len;
     assert (df->received <= df->size);
 
-#ifndef GCS_FOR_GARB
-    assert (df->tail);
-    memcpy (df->tail, frg->frag, frg->frag_len);
-    df->tail += frg->frag_len;
-#else
-    /* we skip memcpy since have not allocated any buffer */
-    assert (NULL == df->tail);
-    assert (NULL == df->head);
-#endif
+    if (GCS_DEFRAG_KEEPS_PAYLOAD(df)) {
+        assert (df->tail);
+        memcpy (df->tail, frg->frag, frg->frag_len);
+        df->tail += frg->frag_len;
+    }
+    else {
+        /* we skip memcpy since have not allocated any buffer */
+        assert (NULL == df->tail);
+        assert (NULL == df->head);
+    }
 
 #if 1
     if (df->received == df->size) {
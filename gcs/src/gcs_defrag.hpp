@@ -32,6 +32,13 @@ typedef struct gcs_defrag
 }
 gcs_defrag_t;
 
+#ifdef GCS_FOR_GARB
+/* garbd reassembles action payload only when caching write sets for IST */
+#define GCS_DEFRAG_KEEPS_PAYLOAD(df) (NULL != (df)->cache)
+#else
+#define GCS_DEFRAG_KEEPS_PAYLOAD(df) (true)
+#endif /* GCS_FOR_GARB */
+
 static inline void
 gcs_defrag_init (gcs_defrag_t* df, gcache_t* cache)
 {
@@ -64,14 +71,12 @@ gcs_defrag_forget (gcs_defrag_t* df)
 static inline void
 gcs_defrag_free (gcs_defrag_t* df)
 {
-#ifndef GCS_FOR_GARB
+    assert(GCS_DEFRAG_KEEPS_PAYLOAD(df) || NULL == df->head);
+
     if (df->head) {
         gcs_gcache_free (df->cache, df->head);
         // df->head, df->tail will be zeroed in gcs_defrag_init() below
     }
-#else
-    assert(NULL == df->head);
-#endif
 
     gcs_defrag_init (df, df->cache);
 }
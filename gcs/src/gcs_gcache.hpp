@@ -7,13 +7,9 @@
 #ifndef _gcs_gcache_h_
 #define _gcs_gcache_h_
 
-#ifndef GCS_FOR_GARB
-    #include <gcache.h>
-#else
-    #ifndef gcache_t
-        struct gcache_t;
-    #endif
-#endif
+/* garbd passes a cache only when it keeps write sets to serve IST,
+ * otherwise it never stores action payload */
+#include <gcache.h>
 
 #include <gu_macros.h>
 
@@ -22,22 +18,18 @@
 static inline void*
 gcs_gcache_malloc (gcache_t* gcache, size_t size)
 {
-#ifndef GCS_FOR_GARB
     if (gu_likely(gcache != NULL))
         return gcache_malloc (gcache, size);
     else
-#endif
         return ::malloc (size);
 }
 
 static inline void
 gcs_gcache_free (gcache_t* gcache, const void* buf)
 {
-#ifndef GCS_FOR_GARB
     if (gu_likely (gcache != NULL))
         gcache_free (gcache, buf);
     else
-#endif
         ::free (const_cast<void*>(buf));
 }
 
@@ -86,6 +86,13 @@ typedef deque<RecvBufData>
 
 RecvBufQueue;
 
+//
+// Messages delivered by the gcomm thread are queued under mutex_ and handed
+// over to the gcs receive thread in batches: the receiving side swaps the
+// whole queue into batch_ in one lock acquisition and consumes it without
+// locking. The gcomm thread signals only when the receiver is blocked on an
+// empty queue.
+//
 class RecvBuf
 {
 private:
@@ -101,7 +108,9 @@ private:
 
 public:
 
-    RecvBuf() : mutex_(), cond_(), queue_(), waiting_(false) { }
+    RecvBuf()
+        : mutex_("gcs_gcomm_recv"), cond_(), queue_(), batch_(),
+          waiting_(false) { }
 
     void push_back(const RecvBufData& p)
     {
@@ -112,8 +121,11 @@ public:
         if (waiting_ == true) { cond_.signal(); }
     }
 
+    // must be called only from the receiving thread
     const RecvBufData& front(const Date& timeout)
     {
+        if (gu_likely(batch_.empty() == false)) return batch_.front();
+
         Lock lock(mutex_);
 
         while (queue_.empty())
@@ -130,21 +142,24 @@ public:
         }
         assert (false == waiting_);
 
-        return queue_.front();
+        queue_.swap(batch_);
+
+        return batch_.front();
     }
 
+    // must be called only from the receiving thread
     void pop_front()
     {
-        Lock lock(mutex_);
-        assert(queue_.empty() == false);
-        queue_.pop_front();
+        assert(batch_.empty() == false);
+        batch_.pop_front();
     }
 
 private:
 
     Mutex mutex_;
     Cond cond_;
-    RecvBufQueue queue_;
+    RecvBufQueue queue_; // filled by gcomm thread, protected by mutex_
+    RecvBufQueue batch_; // owned by the receiving thread
     bool waiting_;
 };
 
@@ -186,7 +201,7 @@ public:
         uri_(u),
         net_(Protonet::create(conf_)),
         tp_(0),
-        mutex_(),
+        mutex_("gcomm_conn"),
         refcnt_(0),
         terminated_(false),
         error_(0),
@@ -206,6 +221,7 @@ public:
 
     static void* run_fn(void* arg)
     {
+        gu::RegisteredThread const reg("gcomm");
         static_cast<GCommConn*>(arg)->run();
         return 0;
     }
@@ -557,7 +573,14 @@ static GCS_BACKEND_MSG_SIZE_FN(gcomm_msg_size)
     {
         return -1;
     }
-    return ref.get()->get_mtu();
+
+    long const mtu(ref.get()->get_mtu());
+
+    // Pool datagram buffers up to the largest message gcomm is going to
+    // carry, with some headroom for protocol headers.
+    gu::SharedBuffer::pool_configure(std::max(pkt_size, mtu) + (1 << 10));
+
+    return mtu;
 }
 
 
@@ -573,9 +596,8 @@ static GCS_BACKEND_SEND_FN(gcomm_send)
     GCommConn& conn(*ref.get());
 
     Datagram dg(
-        SharedBuffer(
-            new Buffer(reinterpret_cast<const byte_t*>(buf),
-                       reinterpret_cast<const byte_t*>(buf) + len)));
+        SharedBuffer(reinterpret_cast<const byte_t*>(buf),
+                     reinterpret_cast<const byte_t*>(buf) + len));
 
     int err;
     // Set thread scheduling params if gcomm thread runs with
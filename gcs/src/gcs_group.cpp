@@ -836,6 +836,14 @@ group_node_is_stateful (const gcs_group_t* group, const gcs_node_t* node)
     }
 }
 
+/*! @return true if arbitrators may cache write sets and serve IST stripes:
+ *          all members must agree on that to select the same donor */
+static inline bool
+group_arbitrators_cache (const gcs_group_t* group)
+{
+    return (group->quorum.gcs_proto_ver >= GCS_ARBITRATOR_CACHE_PROTO);
+}
+
 static int
 group_find_node_by_state (const gcs_group_t*     const group,
                           int              const joiner_idx,
@@ -975,8 +983,13 @@ static gcs_seqno_t
 group_lowest_cached_seqno(const gcs_group_t* const group)
 {
     gcs_seqno_t ret = GCS_SEQNO_ILL;
+    bool const skip_arbitrators = group_arbitrators_cache(group);
     int idx = 0;
     for (idx = 0; idx < group->num; idx++) {
+        /* caching arbitrators serve only IST stripes, not whole transfers */
+        if (skip_arbitrators &&
+            !group_node_is_stateful(group, &group->nodes[idx])) continue;
+
         gcs_seqno_t seq = gcs_node_cached(&group->nodes[idx]);
         if (seq != GCS_SEQNO_ILL)
         {
@@ -1005,6 +1018,8 @@ group_find_ist_donor_by_name (const gcs_group_t* const group,
         if (strncmp(node->name, name, name_len) == 0 &&
             joiner_idx != idx &&
             node->status >= status &&
+            (!group_arbitrators_cache(group) ||
+             group_node_is_stateful(group, node)) &&
             cached != GCS_SEQNO_ILL &&
             // ist potentially possible
             (ist_seqno + 1) >= cached)
@@ -1314,6 +1329,54 @@ group_desync_request (const char* const donor)
             !strcmp(GCS_DESYNC_REQ, donor));
 }
 
+static inline bool
+group_node_covers_ist (const gcs_node_t* const node, gcs_seqno_t const ist_seqno)
+{
+    gcs_seqno_t const cached = gcs_node_cached(node);
+    return (cached != GCS_SEQNO_ILL && cached <= (ist_seqno + 1));
+}
+
+/*! Chooses up to max synced nodes besides joiner and donor that can serve
+ *  a stripe of IST starting at ist_seqno + 1.
+ *  @return number of helpers chosen, their indexes in helpers */
+static int
+group_select_ist_helpers (const gcs_group_t* const group,
+                          int                const joiner_idx,
+                          int                const donor_idx,
+                          gcs_seqno_t        const ist_seqno,
+                          int                const max,
+                          int*               const helpers)
+{
+    int n    = 0;
+    int pass = 0;
+
+    if (!group_node_covers_ist(&group->nodes[donor_idx], ist_seqno)) return 0;
+
+    /* arbitrators which cache write sets go first: serving from them does not
+     * load database nodes */
+    for (pass = group_arbitrators_cache(group) ? 0 : 1; pass < 2; pass++)
+    {
+        bool const stateful = (pass > 0);
+        int idx;
+
+        for (idx = 0; idx < group->num && n < max; idx++)
+        {
+            if (idx == joiner_idx || idx == donor_idx) continue;
+
+            const gcs_node_t* const node = &group->nodes[idx];
+
+            if (GCS_NODE_STATE_SYNCED == node->status &&
+                group_node_is_stateful(group, node) == stateful &&
+                group_node_covers_ist(node, ist_seqno))
+            {
+                helpers[n++] = idx;
+            }
+        }
+    }
+
+    return n;
+}
+
 /* NOTE: check gcs_request_state_transfer() for sender part. */
 /*! Returns 0 if request is ignored, request size if it should be passed up */
 int
@@ -1332,10 +1395,19 @@ gcs_group_handle_state_request (gcs_group_t*         group,
     gu_uuid_t ist_uuid = {{0, }};
     gcs_seqno_t ist_seqno = GCS_SEQNO_ILL;
     int str_version = 1; // actually it's 0 or 1.
+    int stripes     = 1;
 
     if (act->act.buf_len != (ssize_t)(donor_name_len + 1) &&
         donor_name[donor_name_len + 1] == 'V') {
-        str_version = (int)donor_name[donor_name_len + 2];
+        if (group->quorum.gcs_proto_ver >= GCS_STR_STRIPES_PROTO) {
+            int const v = (unsigned char)donor_name[donor_name_len + 2];
+            str_version = v & GCS_STR_VER_MASK;
+            stripes     = (v >> GCS_STR_STRIPES_SHIFT) + 1;
+        }
+        else {
+            // the way older members read it
+            str_version = (int)donor_name[donor_name_len + 2];
+        }
     }
 
     if (str_version >= 2) {
@@ -1382,12 +1454,36 @@ gcs_group_handle_state_request (gcs_group_t*         group,
     assert (donor_idx != joiner_idx || desync  || donor_idx < 0);
     assert (donor_idx == joiner_idx || !desync || donor_idx < 0);
 
-    if (group->my_idx != joiner_idx && group->my_idx != donor_idx) {
-        // if neither DONOR nor JOINER, ignore request
+    int  helpers[GCS_STR_STRIPES_MAX];
+    int  helpers_num = 0;
+    bool my_helper   = false;
+
+    if (stripes > 1 && str_version >= 2 && donor_idx >= 0 && !desync &&
+        !gu_uuid_compare(&ist_uuid, &group->group_uuid)) {
+
+        helpers_num = group_select_ist_helpers(group, joiner_idx, donor_idx,
+                                               ist_seqno, stripes - 1,
+                                               helpers);
+
+        int i;
+        for (i = 0; i < helpers_num; i++) {
+            if (helpers[i] == group->my_idx) my_helper = true;
+        }
+
+        if (helpers_num > 0) {
+            gu_info ("Member %d.%d (%s) IST will be served in %d stripes",
+                     joiner_idx, group->nodes[joiner_idx].segment, joiner_name,
+                     helpers_num + 1);
+        }
+    }
+
+    if (group->my_idx != joiner_idx && group->my_idx != donor_idx &&
+        !my_helper) {
+        // if neither DONOR nor JOINER nor IST helper, ignore request
         gcs_group_ignore_action (group, act);
         return 0;
     }
-    else if (group->my_idx == donor_idx) {
+    else if (group->my_idx == donor_idx || my_helper) {
         act->act.buf_len -= donor_name_len + 1;
         memmove (*(void**)&act->act.buf,
                  ((char*)act->act.buf) + donor_name_len + 1,
@@ -1400,7 +1496,17 @@ gcs_group_handle_state_request (gcs_group_t*         group,
     // It will be used to detect error conditions (no availabale donor,
     // donor crashed and the like).
     // This may be ugly, well, any ideas?
-    act->id = donor_idx;
+    // Joiner also gets the number of IST senders encoded there, helpers
+    // are told apart by special negative value.
+    if (my_helper) {
+        act->id = GCS_STR_STRIPE_HELPER;
+    }
+    else if (group->my_idx == joiner_idx && donor_idx >= 0) {
+        act->id = donor_idx + (gcs_seqno_t)helpers_num * GCS_STR_STRIPE_UNIT;
+    }
+    else {
+        act->id = donor_idx;
+    }
 
     return act->act.buf_len;
 }
@@ -1505,12 +1611,11 @@ group_get_node_state (const gcs_group_t* const group, long const node_idx)
     if (node->bootstrap)          flags |= GCS_STATE_FBOOTSTRAP;
 #ifdef GCS_FOR_GARB
     flags |= GCS_STATE_ARBITRATOR;
+#endif /* GCS_FOR_GARB */
 
-    int64_t const cached = GCS_SEQNO_ILL;
-#else
-    int64_t const cached = /* group->cache check is needed for unit tests */
+    /* group->cache check is needed for unit tests and non-caching garbd */
+    int64_t const cached =
         group->cache ? gcache_seqno_min(group->cache) : GCS_SEQNO_ILL;
-#endif /* GCS_FOR_GARB */
 
     return gcs_state_msg_create (
         &group->state_uuid,
@@ -46,6 +46,7 @@ gcs_sm_create (long len, long n)
     if (sm) {
         sm_init_stats (&sm->stats);
         gu_mutex_init (&sm->lock, NULL);
+        gu_lock_prof_init (&sm->prof, "gcs_sm");
         gu_cond_init  (&sm->cond, NULL);
         sm->cond_wait   = 0;
         sm->wait_q_len  = len;
@@ -79,7 +80,7 @@ gcs_sm_close (gcs_sm_t* sm)
 {
     gu_info ("Closing send monitor...");
 
-    if (gu_unlikely(gu_mutex_lock (&sm->lock))) abort();
+    if (gu_unlikely(gu_mutex_lock_prof (&sm->lock, &sm->prof))) abort();
 
     sm->ret = -EBADFD;
 
@@ -90,9 +91,9 @@ gcs_sm_close (gcs_sm_t* sm)
 
     // in case the queue is full
     while (sm->users >= (long)sm->wait_q_len) {
-        gu_mutex_unlock (&sm->lock);
+        gu_mutex_unlock_prof (&sm->lock, &sm->prof);
         usleep(1000);
-        gu_mutex_lock (&sm->lock);
+        gu_mutex_lock_prof (&sm->lock, &sm->prof);
     }
 
     while (sm->users > 0) { // wait for cleared queue
@@ -105,7 +106,7 @@ gcs_sm_close (gcs_sm_t* sm)
 
     gu_cond_destroy (&cond);
 
-    gu_mutex_unlock (&sm->lock);
+    gu_mutex_unlock_prof (&sm->lock, &sm->prof);
 
     gu_info ("Closed send monitor.");
 
@@ -117,7 +118,7 @@ gcs_sm_open (gcs_sm_t* sm)
 {
     long ret = -1;
 
-    if (gu_unlikely(gu_mutex_lock (&sm->lock))) abort();
+    if (gu_unlikely(gu_mutex_lock_prof (&sm->lock, &sm->prof))) abort();
 
     if (-EBADFD == sm->ret)  /* closed */
     {
@@ -125,7 +126,7 @@ gcs_sm_open (gcs_sm_t* sm)
     }
     ret = sm->ret;
 
-    gu_mutex_unlock (&sm->lock);
+    gu_mutex_unlock_prof (&sm->lock, &sm->prof);
 
     if (ret) { gu_error ("Can't open send monitor: wrong state %d", ret); }
 
@@ -152,7 +153,7 @@ gcs_sm_stats_get (gcs_sm_t*  sm,
     long long      now;
     bool           paused;
 
-    if (gu_unlikely(gu_mutex_lock (&sm->lock))) abort();
+    if (gu_unlikely(gu_mutex_lock_prof (&sm->lock, &sm->prof))) abort();
 
     *q_len_max = sm->users_max;
     *q_len_min = sm->users_min;
@@ -161,7 +162,7 @@ gcs_sm_stats_get (gcs_sm_t*  sm,
     now    = gu_time_monotonic();
     paused = sm->pause;
 
-    gu_mutex_unlock (&sm->lock);
+    gu_mutex_unlock_prof (&sm->lock, &sm->prof);
 
     if (paused) { // taking sample in a middle of a pause
         tmp.paused_ns += now - tmp.pause_start;
@@ -192,7 +193,7 @@ gcs_sm_stats_get (gcs_sm_t*  sm,
 void
 gcs_sm_stats_flush(gcs_sm_t* sm)
 {
-    if (gu_unlikely(gu_mutex_lock (&sm->lock))) abort();
+    if (gu_unlikely(gu_mutex_lock_prof (&sm->lock, &sm->prof))) abort();
 
     long long const now = gu_time_monotonic();
 
@@ -212,7 +213,7 @@ gcs_sm_stats_flush(gcs_sm_t* sm)
 
     sm->users_max = sm->users;
     sm->users_min = sm->users;
-    gu_mutex_unlock (&sm->lock);
+    gu_mutex_unlock_prof (&sm->lock, &sm->prof);
 }
 
 #ifdef GCS_SM_DEBUG
@@ -276,8 +277,8 @@ _gcs_sm_dump_state_common(gcs_sm_t* sm, FILE* file)
 void
 gcs_sm_dump_state(gcs_sm_t* sm, FILE* file)
 {
-    if (gu_unlikely(gu_mutex_lock (&sm->lock))) abort();
+    if (gu_unlikely(gu_mutex_lock_prof (&sm->lock, &sm->prof))) abort();
     _gcs_sm_dump_state_common(sm, file);
-    gu_mutex_unlock (&sm->lock);
+    gu_mutex_unlock_prof (&sm->lock, &sm->prof);
 }
 #endif /* GCS_SM_DEBUG */
@@ -45,6 +45,7 @@ typedef struct gcs_sm
 {
     gcs_sm_stats_t stats;
     gu_mutex_t    lock;
+    gu_lock_prof_t prof;
     gu_cond_t     cond;
     long          cond_wait;
     unsigned long wait_q_len;
@@ -219,7 +220,7 @@ _gcs_sm_enqueue_common (gcs_sm_t* sm, gu_cond_t* cond, bool block,
     if (block == true)
     {
         GCS_SM_HIST_LOG("queueing at %lu", tail);
-        gu_cond_wait (cond, &sm->lock);
+        gu_cond_wait_prof (cond, &sm->lock, &sm->prof);
         assert(tail == sm->wait_q_head || false == sm->wait_q[tail].wait);
         assert(sm->wait_q[tail].cond == cond || false == sm->wait_q[tail].wait);
         ret = sm->wait_q[tail].wait ? 0 : -EINTR;
@@ -234,7 +235,7 @@ _gcs_sm_enqueue_common (gcs_sm_t* sm, gu_cond_t* cond, bool block,
         struct timespec ts;
         abstime._timespec(ts);
         GCS_SM_HIST_LOG("waiting at %lu", tail);
-        ret = -gu_cond_timedwait(cond, &sm->lock, &ts);
+        ret = -gu_cond_timedwait_prof(cond, &sm->lock, &ts, &sm->prof);
         if (0 == ret)
         {
             ret = sm->wait_q[tail].wait ? 0 : -EINTR;
@@ -295,7 +296,7 @@ _gcs_sm_enqueue_common (gcs_sm_t* sm, gu_cond_t* cond, bool block,
 static inline long
 gcs_sm_schedule (gcs_sm_t* sm)
 {
-    if (gu_unlikely(gu_mutex_lock (&sm->lock))) abort();
+    if (gu_unlikely(gu_mutex_lock_prof (&sm->lock, &sm->prof))) abort();
 
     long ret = sm->ret;
 
@@ -328,7 +329,7 @@ gcs_sm_schedule (gcs_sm_t* sm)
     assert(ret < 0);
 
     GCS_SM_HIST_LOG("return %ld", sm->wait_q_tail);
-    gu_mutex_unlock (&sm->lock);
+    gu_mutex_unlock_prof (&sm->lock, &sm->prof);
 
     return ret;
 }
@@ -392,7 +393,7 @@ gcs_sm_enter (gcs_sm_t* sm, gu_cond_t* cond, bool scheduled, bool block)
         }
 
         GCS_SM_HIST_LOG("%lu entered: %ld", tail, ret);
-        gu_mutex_unlock (&sm->lock);
+        gu_mutex_unlock_prof (&sm->lock, &sm->prof);
     }
     else if (ret != -EBADFD){
         gu_warn("thread %ld failed to schedule for monitor: %ld (%s)",
@@ -405,7 +406,7 @@ gcs_sm_enter (gcs_sm_t* sm, gu_cond_t* cond, bool scheduled, bool block)
 static inline void
 gcs_sm_leave (gcs_sm_t* sm)
 {
-    if (gu_unlikely(gu_mutex_lock (&sm->lock))) abort();
+    if (gu_unlikely(gu_mutex_lock_prof (&sm->lock, &sm->prof))) abort();
 
     GCS_SM_ASSERT(sm->entered > 0);
     sm->entered--;
@@ -413,13 +414,13 @@ gcs_sm_leave (gcs_sm_t* sm)
 
     _gcs_sm_leave_common(sm);
 
-    gu_mutex_unlock (&sm->lock);
+    gu_mutex_unlock_prof (&sm->lock, &sm->prof);
 }
 
 static inline void
 gcs_sm_pause (gcs_sm_t* sm)
 {
-    if (gu_unlikely(gu_mutex_lock (&sm->lock))) abort();
+    if (gu_unlikely(gu_mutex_lock_prof (&sm->lock, &sm->prof))) abort();
 
     /* don't pause closed monitor */
     if (gu_likely(0 == sm->ret) && !sm->pause) {
@@ -427,7 +428,7 @@ gcs_sm_pause (gcs_sm_t* sm)
         sm->pause = true;
     }
     GCS_SM_HIST_LOG("paused");
-    gu_mutex_unlock (&sm->lock);
+    gu_mutex_unlock_prof (&sm->lock, &sm->prof);
 }
 
 static inline void
@@ -441,7 +442,7 @@ _gcs_sm_continue_common (gcs_sm_t* sm)
 static inline void
 gcs_sm_continue (gcs_sm_t* sm)
 {
-    if (gu_unlikely(gu_mutex_lock (&sm->lock))) abort();
+    if (gu_unlikely(gu_mutex_lock_prof (&sm->lock, &sm->prof))) abort();
 
     if (gu_likely(sm->pause)) {
         _gcs_sm_continue_common (sm);
@@ -452,7 +453,7 @@ gcs_sm_continue (gcs_sm_t* sm)
         gu_info ("Trying to continue unpaused monitor");
     }
     GCS_SM_HIST_LOG("resumed");
-    gu_mutex_unlock (&sm->lock);
+    gu_mutex_unlock_prof (&sm->lock, &sm->prof);
 }
 
 /*!
@@ -469,7 +470,7 @@ gcs_sm_interrupt (gcs_sm_t* sm, long handle)
     assert (handle > 0);
     long ret;
 
-    if (gu_unlikely(gu_mutex_lock (&sm->lock))) abort();
+    if (gu_unlikely(gu_mutex_lock_prof (&sm->lock, &sm->prof))) abort();
 
     handle--;
 
@@ -492,7 +493,7 @@ gcs_sm_interrupt (gcs_sm_t* sm, long handle)
         GCS_SM_HIST_LOG("interrupted %ld: not found", handle);
     }
 
-    gu_mutex_unlock (&sm->lock);
+    gu_mutex_unlock_prof (&sm->lock, &sm->prof);
 
     return ret;
 }
@@ -529,11 +530,11 @@ gcs_sm_grab (gcs_sm_t* sm)
 {
     long ret;
 
-    if (gu_unlikely(gu_mutex_lock (&sm->lock))) abort();
+    if (gu_unlikely(gu_mutex_lock_prof (&sm->lock, &sm->prof))) abort();
 
     while (!(ret = sm->ret) && sm->entered >= GCS_SM_CC) {
         sm->cond_wait++;
-        gu_cond_wait (&sm->cond, &sm->lock);
+        gu_cond_wait_prof (&sm->cond, &sm->lock, &sm->prof);
     }
 
     if (ret) {
@@ -547,7 +548,7 @@ gcs_sm_grab (gcs_sm_t* sm)
         GCS_SM_HIST_LOG("grab succeeded");
     }
 
-    gu_mutex_unlock (&sm->lock);
+    gu_mutex_unlock_prof (&sm->lock, &sm->prof);
 
     return ret;
 }
@@ -556,14 +557,14 @@ gcs_sm_grab (gcs_sm_t* sm)
 static inline void
 gcs_sm_release (gcs_sm_t* sm)
 {
-    if (gu_unlikely(gu_mutex_lock (&sm->lock))) abort();
+    if (gu_unlikely(gu_mutex_lock_prof (&sm->lock, &sm->prof))) abort();
 
     sm->entered--;
     assert(sm->entered >= 0);
     _gcs_sm_wake_up_waiters (sm);
     GCS_SM_HIST_LOG("released");
 
-    gu_mutex_unlock (&sm->lock);
+    gu_mutex_unlock_prof (&sm->lock, &sm->prof);
 }
 
 #endif /* _gcs_sm_h_ */
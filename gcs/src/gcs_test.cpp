@@ -61,6 +61,10 @@ typedef struct gcs_test_thread
     long              n_tries;
     void*             msg;
     char*             log_msg;
+    long long         lat_total; // total replication latency, ns
+    long long         lat_min;
+    long long         lat_max;
+    long              lat_count;
 }
 gcs_test_thread_t;
 
@@ -76,6 +80,10 @@ static long gcs_test_thread_create (gcs_test_thread_t *t, long id, long n_tries)
     t->act.seqno_l  = GCS_SEQNO_ILL;
     t->act.type     = GCS_ACT_TORDERED;
     t->n_tries      = n_tries;
+    t->lat_total    = 0;
+    t->lat_min      = GU_TIME_ETERNITY;
+    t->lat_max      = 0;
+    t->lat_count    = 0;
 
     if (t->msg)
     {
@@ -381,6 +389,7 @@ void *gcs_test_repl (void *arg)
         if (ret < 0) break;
 
         /* replicate message */
+        long long const start = gu_time_monotonic();
         ret = gcs_repl (gcs, &thread->act, false);
 
         if (ret < 0) {
@@ -389,6 +398,12 @@ void *gcs_test_repl (void *arg)
             break;
         }
 
+        long long const lat = gu_time_monotonic() - start;
+        thread->lat_total += lat;
+        thread->lat_count++;
+        if (lat < thread->lat_min) thread->lat_min = lat;
+        if (lat > thread->lat_max) thread->lat_max = lat;
+
         msg_repld++;
         size_repld += thread->act.size;
 //      usleep ((rand() & 1) << 1);
@@ -584,6 +599,32 @@ static long gcs_test_thread_pool_start (gcs_test_thread_pool_t *pool)
     return 0;
 }
 
+/* prints gcs_repl() latency over all threads of the pool */
+static void
+gcs_test_thread_pool_latency (const gcs_test_thread_pool_t *pool)
+{
+    long long total = 0;
+    long long min   = GU_TIME_ETERNITY;
+    long long max   = 0;
+    long      count = 0;
+    long      i;
+
+    for (i = 0; i < pool->n_started; i++) {
+        const gcs_test_thread_t* const t = pool->threads + i;
+        total += t->lat_total;
+        count += t->lat_count;
+        if (t->lat_min < min) min = t->lat_min;
+        if (t->lat_max > max) max = t->lat_max;
+    }
+
+    if (count > 0) {
+        printf ("Replication latency: avg %8.1f us, min %8.1f us, "
+                "max %8.1f us (%ld actions)\n",
+                (double)total/count * 1.0e-3, min * 1.0e-3, max * 1.0e-3,
+                count);
+    }
+}
+
 static long gcs_test_thread_pool_join (const gcs_test_thread_pool_t *pool)
 {
     long i;
@@ -783,6 +824,7 @@ int main (int argc, char *argv[])
                          interval);
         printf ("Overhead at 10000 actions/sec: %5.2f%%\n",
                 1000000.0 * interval / (msg_repld + msg_recvd));
+        gcs_test_thread_pool_latency (&repl_pool);
         puts("");
     }
 
@@ -702,6 +702,97 @@ START_TEST (gcs_core_test_own)
 }
 END_TEST
 
+static void*
+core_caused_thread (void* arg)
+{
+    *(gcs_seqno_t*)arg = gcs_core_caused (Core, 0);
+    return (NULL);
+}
+
+static void
+core_test_wait_causal (long long reqs, long long msgs)
+{
+    long long r, m, l;
+    do
+    {
+        usleep (1000);
+        gcs_core_causal_stats (Core, &r, &m, &l, false);
+    }
+    while (r < reqs || m < msgs);
+}
+
+// tests that causal requests made while another one is in flight share
+// a single causal message
+START_TEST (gcs_core_test_causal)
+{
+    core_test_init ();
+    fail_if (NULL == Core);
+
+    gcs_core_send_lock_step (Core, false);
+
+    static int const n_threads = 4;
+    gu_thread_t  threads[n_threads];
+    gcs_seqno_t  seqnos[n_threads];
+    long         ret;
+    long long    reqs, msgs, leased;
+
+    // first request goes out immediately and stays in flight since nobody
+    // is receiving yet
+    ret = gu_thread_create (&threads[0], NULL, core_caused_thread, &seqnos[0]);
+    fail_if (0 != ret);
+    core_test_wait_causal (1, 1);
+
+    // the rest shall be batched behind it
+    for (int i = 1; i < n_threads; ++i)
+    {
+        ret = gu_thread_create (&threads[i], NULL, core_caused_thread,
+                                &seqnos[i]);
+        fail_if (0 != ret);
+    }
+    core_test_wait_causal (n_threads, 1);
+
+    action_t act_r(act1, NULL, NULL, -1, (gcs_act_type_t)-1, -1,
+                   (gu_thread_t)-1);
+    fail_if (CORE_RECV_START (&act_r));
+
+    for (int i = 0; i < n_threads; ++i)
+    {
+        gu_thread_join (threads[i], NULL);
+        fail_if (Seqno != seqnos[i], "Expected causal seqno %lld, got %lld",
+                 (long long)Seqno, (long long)seqnos[i]);
+    }
+
+    gcs_core_causal_stats (Core, &reqs, &msgs, &leased, true);
+    fail_if (n_threads != reqs, "Expected %d causal requests, got %lld",
+             n_threads, reqs);
+    fail_if (2 != msgs, "Expected 2 causal messages, got %lld", msgs);
+    fail_if (0 != leased, "Expected 0 leased causal requests, got %lld",
+             leased);
+
+    // the round trips above established a lease which must be used now
+    gcs_seqno_t const leased_seqno =
+        gcs_core_caused (Core, GU_TIME_ETERNITY);
+    fail_if (Seqno != leased_seqno, "Expected leased seqno %lld, got %lld",
+             (long long)Seqno, (long long)leased_seqno);
+    gcs_core_causal_stats (Core, &reqs, &msgs, &leased, true);
+    fail_if (1 != reqs || 0 != msgs || 1 != leased,
+             "Expected 1 leased causal request, got reqs: %lld, msgs: %lld, "
+             "leased: %lld", reqs, msgs, leased);
+
+    // let the receiving thread go
+    ret = gcs_core_send (Core, act1, sizeof(act1_str), GCS_ACT_TORDERED);
+    fail_if (ret != sizeof(act1_str), "Expected %d, got %d (%s)",
+             sizeof(act1_str), ret, strerror (-ret));
+    fail_if (CORE_RECV_END (&act_r, act1_str, sizeof(act1_str),
+                            GCS_ACT_TORDERED));
+
+    // lock step must be enabled for gcs_core_destroy()
+    gcs_core_send_lock_step (Core, true);
+
+    core_test_cleanup ();
+}
+END_TEST
+
 /*
  * Disabled test because it is too slow and timeouts on crowded
  * build systems like e.g. build.opensuse.org
@@ -949,6 +1040,7 @@ Suite *gcs_core_suite(void)
   if (skip == false) {
       tcase_add_test  (tcase, gcs_core_test_api);
       tcase_add_test  (tcase, gcs_core_test_own);
+      tcase_add_test  (tcase, gcs_core_test_causal);
       //  tcase_add_test  (tcase, gcs_core_test_foreign);
       // tcase_add_test (tcase, gcs_core_test_gh74);
   }
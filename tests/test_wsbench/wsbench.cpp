@@ -0,0 +1,699 @@
+//
+// Copyright (C) 2017 Codership Oy <info@codership.com>
+//
+
+//
+// wsrep API load generator.
+//
+// Loads wsrep provider (libgalera_smm.so) the way DBMS does and runs
+// a number of client threads replicating synthetic writesets through
+// append_key()/append_data()/pre_commit()/post_commit() while applier
+// threads sit in recv(). Several instances form a cluster over loopback,
+// see wsbench.sh. Reports TPS, commit latency percentiles and certification
+// failure rate.
+//
+// For commandline options, run with --help.
+//
+// Build requirements:
+// * C++11 capable compiler
+// * wsrep_api.h from common
+// * Boost program options
+//
+// Example build command:
+//
+// g++ -std=c++0x -g -O3 -Wextra -Wall -I../../common wsbench.cpp
+//     -lboost_program_options -ldl -lpthread -o wsbench
+//
+
+#include "wsrep_api.h"
+
+#include <dlfcn.h>
+
+#include <stdexcept>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <memory>
+
+#include <boost/program_options.hpp>
+namespace po = boost::program_options;
+
+namespace wsbench
+{
+    typedef std::chrono::steady_clock clock;
+
+    // Commandline parsing and configuration
+    class Config
+    {
+    public:
+        Config(int argc, char* argv[])
+            :
+            provider_     ("/usr/lib/galera/libgalera_smm.so"),
+            name_         ("wsbench"),
+            address_      ("gcomm://"),
+            options_      (),
+            data_dir_     ("."),
+            bootstrap_    (false),
+            clients_      (4),
+            appliers_     (4),
+            duration_     (10),
+            ws_size_      (128),
+            keys_         (1),
+            key_space_    (1000000),
+            dist_         ("uniform"),
+            zipf_s_       (0.99),
+            conflict_rate_(0.0),
+            hot_keys_     (16),
+            compact_      (false)
+        {
+            po::options_description other("Other options");
+            other.add_options()
+                ("help,h",  "Show help message")
+                ("dry-run", "Print config and exit");
+
+            po::options_description provider("Provider");
+            provider.add_options()
+                ("provider",  po::value<std::string>(&provider_),
+                 "Path to wsrep provider library")
+                ("name",      po::value<std::string>(&name_),
+                 "Node name")
+                ("address",   po::value<std::string>(&address_),
+                 "Cluster address (gcomm://host:port,...)")
+                ("options",   po::value<std::string>(&options_),
+                 "Provider options string")
+                ("data-dir",  po::value<std::string>(&data_dir_),
+                 "Directory for provider files (gcache, grastate.dat)")
+                ("bootstrap", "Bootstrap new cluster");
+
+            po::options_description load("Load");
+            load.add_options()
+                ("clients",       po::value<size_t>(&clients_),
+                 "Number of client threads")
+                ("appliers",      po::value<size_t>(&appliers_),
+                 "Number of applier threads")
+                ("duration",      po::value<time_t>(&duration_),
+                 "Test duration in seconds")
+                ("ws-size",       po::value<size_t>(&ws_size_),
+                 "Writeset payload size in bytes")
+                ("keys",          po::value<size_t>(&keys_),
+                 "Number of keys per writeset")
+                ("key-space",     po::value<size_t>(&key_space_),
+                 "Number of distinct keys, shared by all nodes")
+                ("dist",          po::value<std::string>(&dist_),
+                 "Key distribution: uniform or zipf")
+                ("zipf-s",        po::value<double>(&zipf_s_),
+                 "Zipf distribution exponent")
+                ("conflict-rate", po::value<double>(&conflict_rate_),
+                 "Fraction of writesets that also write one of the hot keys")
+                ("hot-keys",      po::value<size_t>(&hot_keys_),
+                 "Number of hot keys")
+                ("compact",       po::value<bool>(&compact_),
+                 "Print result in one line");
+
+            po::options_description opts;
+            opts.add(provider).add(load).add(other);
+
+            po::variables_map vm;
+            store(po::command_line_parser(argc, argv).options(opts).run(), vm);
+            notify(vm);
+
+            if (vm.count("bootstrap"))
+            {
+                bootstrap_ = true;
+            }
+
+            if (vm.count("help"))
+            {
+                std::cerr << "\nUsage: " << argv[0] << "\n"
+                          << opts << std::endl;
+                exit(EXIT_SUCCESS);
+            }
+
+            if (dist_ != "uniform" && dist_ != "zipf")
+            {
+                throw std::runtime_error("unknown key distribution: " + dist_);
+            }
+
+            if (key_space_ == 0 || hot_keys_ == 0 ||
+                conflict_rate_ < 0.0 || conflict_rate_ > 1.0)
+            {
+                throw std::runtime_error("invalid key configuration");
+            }
+
+            if (vm.count("dry-run"))
+            {
+                std::cerr << "Config: "
+                          << "provider      : " << provider_      << "\n"
+                          << "name          : " << name_          << "\n"
+                          << "address       : " << address_       << "\n"
+                          << "options       : " << options_       << "\n"
+                          << "data-dir      : " << data_dir_      << "\n"
+                          << "bootstrap     : " << bootstrap_     << "\n"
+                          << "clients       : " << clients_       << "\n"
+                          << "appliers      : " << appliers_      << "\n"
+                          << "duration      : " << duration_      << "\n"
+                          << "ws-size       : " << ws_size_       << "\n"
+                          << "keys          : " << keys_          << "\n"
+                          << "key-space     : " << key_space_     << "\n"
+                          << "dist          : " << dist_          << "\n"
+                          << "zipf-s        : " << zipf_s_        << "\n"
+                          << "conflict-rate : " << conflict_rate_ << "\n"
+                          << "hot-keys      : " << hot_keys_      << "\n"
+                          << "compact       : " << compact_ << std::endl;
+                exit(EXIT_SUCCESS);
+            }
+        }
+
+        const char* provider() const { return provider_.c_str(); }
+        const char* name() const { return name_.c_str(); }
+        const char* address() const { return address_.c_str(); }
+        const char* options() const { return options_.c_str(); }
+        const char* data_dir() const { return data_dir_.c_str(); }
+        bool bootstrap() const { return bootstrap_; }
+        size_t clients() const { return clients_; }
+        size_t appliers() const { return appliers_; }
+        time_t duration() const { return duration_; }
+        size_t ws_size() const { return ws_size_; }
+        size_t keys() const { return keys_; }
+        size_t key_space() const { return key_space_; }
+        bool zipf() const { return dist_ == "zipf"; }
+        double zipf_s() const { return zipf_s_; }
+        double conflict_rate() const { return conflict_rate_; }
+        size_t hot_keys() const { return hot_keys_; }
+        bool compact() const { return compact_; }
+    private:
+        std::string provider_;
+        std::string name_;
+        std::string address_;
+        std::string options_;
+        std::string data_dir_;
+        bool bootstrap_;
+        size_t clients_;
+        size_t appliers_;
+        time_t duration_;
+        size_t ws_size_;
+        size_t keys_;
+        size_t key_space_;
+        std::string dist_;
+        double zipf_s_;
+        double conflict_rate_;
+        size_t hot_keys_;
+        bool compact_;
+    };
+
+
+    // Global state
+    class Global
+    {
+    public:
+        static std::atomic_llong commits_;
+        static std::atomic_llong cert_failures_;
+        static std::atomic_llong errors_;
+        static std::atomic_llong applied_;
+        static std::atomic_bool  synced_;
+        static std::atomic_bool  stop_;
+        static std::mutex              mtx_;
+        static std::condition_variable cond_;
+    };
+    std::atomic_llong Global::commits_(0);
+    std::atomic_llong Global::cert_failures_(0);
+    std::atomic_llong Global::errors_(0);
+    std::atomic_llong Global::applied_(0);
+    std::atomic_bool  Global::synced_(false);
+    std::atomic_bool  Global::stop_(false);
+    std::mutex              Global::mtx_;
+    std::condition_variable Global::cond_;
+
+
+    // Key generator. Zipf keys are drawn by binary search in precomputed
+    // CDF, rank 0 being the most popular key.
+    class KeyDist
+    {
+    public:
+        KeyDist(const Config& config)
+            :
+            config_(config),
+            cdf_   ()
+        {
+            if (config_.zipf())
+            {
+                cdf_.resize(config_.key_space());
+                double sum(0.0);
+                for (size_t i(0); i < cdf_.size(); ++i)
+                {
+                    sum += 1.0/std::pow(double(i + 1), config_.zipf_s());
+                    cdf_[i] = sum;
+                }
+                for (size_t i(0); i < cdf_.size(); ++i) cdf_[i] /= sum;
+            }
+        }
+
+        template <class R>
+        uint64_t key(R& rng) const
+        {
+            if (config_.zipf())
+            {
+                double const u(std::uniform_real_distribution<double>()(rng));
+                return std::lower_bound(cdf_.begin(), cdf_.end(), u)
+                    - cdf_.begin();
+            }
+            return std::uniform_int_distribution<uint64_t>(
+                0, config_.key_space() - 1)(rng);
+        }
+
+        KeyDist(const KeyDist&)          = delete;
+        void operator=(const KeyDist&)   = delete;
+    private:
+        const Config&       config_;
+        std::vector<double> cdf_;
+    };
+
+
+    // Loaded provider
+    class Provider
+    {
+    public:
+        Provider(const Config& config)
+            :
+            dlh_(dlopen(config.provider(), RTLD_NOW | RTLD_LOCAL)),
+            wsrep_()
+        {
+            if (!dlh_)
+            {
+                throw std::runtime_error(std::string("dlopen() failed: ")
+                                         + dlerror());
+            }
+
+            typedef int (*loader_t)(wsrep_t*);
+            loader_t const loader(reinterpret_cast<loader_t>(
+                                      dlsym(dlh_, "wsrep_loader")));
+
+            if (!loader || loader(&wsrep_) != 0)
+            {
+                dlclose(dlh_);
+                throw std::runtime_error("failed to load wsrep provider");
+            }
+
+            if (strcmp(wsrep_.version, WSREP_INTERFACE_VERSION))
+            {
+                dlclose(dlh_);
+                throw std::runtime_error(
+                    std::string("wsrep interface version mismatch: ")
+                    + wsrep_.version);
+            }
+
+            wsrep_.dlh = dlh_;
+        }
+
+        ~Provider()
+        {
+            wsrep_.free(&wsrep_);
+            dlclose(dlh_);
+        }
+
+        wsrep_t* operator->() { return &wsrep_; }
+        wsrep_t* get() { return &wsrep_; }
+
+        Provider(const Provider&)       = delete;
+        void operator=(const Provider&) = delete;
+    private:
+        void*   dlh_;
+        wsrep_t wsrep_;
+    };
+
+
+    // Callbacks
+    void logger_cb(wsrep_log_level_t level, const char* msg)
+    {
+        static const char* const lvl[] =
+            { "FATAL", "ERROR", "WARN", "INFO", "DEBUG" };
+        if (level <= WSREP_LOG_INFO)
+        {
+            std::cerr << lvl[level] << ": " << msg << std::endl;
+        }
+    }
+
+    wsrep_cb_status_t view_cb(void*                    app_ctx,
+                              void*                    recv_ctx,
+                              const wsrep_view_info_t* view,
+                              const char*              state,
+                              size_t                   state_len,
+                              void**                   sst_req,
+                              size_t*                  sst_req_len)
+    {
+        std::cerr << "View: " << view->view << ", members: " << view->memb_num
+                  << (view->status == WSREP_VIEW_PRIMARY ? " primary" : "")
+                  << std::endl;
+
+        if (view->state_gap)
+        {
+            // writesets carry no state, nothing to transfer
+            *sst_req_len = strlen(WSREP_STATE_TRANSFER_TRIVIAL) + 1;
+            *sst_req     = strdup(WSREP_STATE_TRANSFER_TRIVIAL);
+        }
+        else
+        {
+            *sst_req     = 0;
+            *sst_req_len = 0;
+        }
+
+        return WSREP_CB_SUCCESS;
+    }
+
+    wsrep_cb_status_t apply_cb(void*                   recv_ctx,
+                               const void*             data,
+                               size_t                  size,
+                               uint32_t                flags,
+                               const wsrep_trx_meta_t* meta)
+    {
+        return WSREP_CB_SUCCESS;
+    }
+
+    wsrep_cb_status_t commit_cb(void*                   recv_ctx,
+                                uint32_t                flags,
+                                const wsrep_trx_meta_t* meta,
+                                wsrep_bool_t*           exit,
+                                wsrep_bool_t            commit)
+    {
+        if (commit) ++Global::applied_;
+        return WSREP_CB_SUCCESS;
+    }
+
+    wsrep_cb_status_t unordered_cb(void* recv_ctx, const void* data,
+                                   size_t size)
+    {
+        return WSREP_CB_SUCCESS;
+    }
+
+    wsrep_cb_status_t sst_donate_cb(void*               app_ctx,
+                                    void*               recv_ctx,
+                                    const void*         msg,
+                                    size_t              msg_len,
+                                    const wsrep_gtid_t* state_id,
+                                    const char*         state,
+                                    size_t              state_len,
+                                    wsrep_bool_t        bypass)
+    {
+        // only trivial SST is ever requested, which provider handles itself
+        return WSREP_CB_FAILURE;
+    }
+
+    void synced_cb(void* app_ctx)
+    {
+        std::lock_guard<std::mutex> lock(Global::mtx_);
+        Global::synced_ = true;
+        Global::cond_.notify_all();
+    }
+
+
+    // Client thread: replicates writesets until stopped, collects commit
+    // latencies in microseconds
+    class Client
+    {
+    public:
+        Client(const Config& config, Provider& provider, const KeyDist& dist,
+               size_t idx)
+            :
+            config_  (config),
+            provider_(provider),
+            dist_    (dist),
+            idx_     (idx),
+            rng_     (std::random_device()() + idx),
+            payload_ (config.ws_size(), 'x'),
+            lat_     ()
+        {
+            lat_.reserve(1 << 20);
+        }
+
+        void run()
+        {
+            wsrep_conn_id_t const conn_id(idx_ + 1);
+            // trx ids must be unique within the node
+            wsrep_trx_id_t trx_id(uint64_t(idx_) << 48);
+            std::bernoulli_distribution hot(config_.conflict_rate());
+            std::uniform_int_distribution<uint64_t> hot_key(
+                0, config_.hot_keys() - 1);
+
+            std::vector<uint64_t> key_vals(config_.keys() + 1);
+
+            while (!Global::stop_)
+            {
+                wsrep_ws_handle_t ws_handle = { ++trx_id, 0 };
+                wsrep_trx_meta_t  meta;
+                size_t            n_keys(0);
+
+                // hot keys are distinct from the key space ones
+                if (hot(rng_))
+                {
+                    key_vals[n_keys++] = config_.key_space() + hot_key(rng_);
+                }
+
+                for (size_t i(0); i < config_.keys(); ++i)
+                {
+                    key_vals[n_keys++] = dist_.key(rng_);
+                }
+
+                clock::time_point const start(clock::now());
+
+                wsrep_status_t rc(WSREP_OK);
+
+                for (size_t i(0); rc == WSREP_OK && i < n_keys; ++i)
+                {
+                    static const char table[] = "wsbench";
+                    wsrep_buf_t const parts[2] =
+                        {
+                            { table, sizeof(table) },
+                            { &key_vals[i], sizeof(key_vals[i]) }
+                        };
+                    wsrep_key_t const key = { parts, 2 };
+
+                    rc = provider_->append_key(provider_.get(), &ws_handle,
+                                               &key, 1, WSREP_KEY_EXCLUSIVE,
+                                               true);
+                }
+
+                if (rc == WSREP_OK && payload_.size() > 0)
+                {
+                    wsrep_buf_t const data =
+                        { payload_.data(), payload_.size() };
+                    rc = provider_->append_data(provider_.get(), &ws_handle,
+                                                &data, 1, WSREP_DATA_ORDERED,
+                                                true);
+                }
+
+                if (rc == WSREP_OK)
+                {
+                    rc = provider_->pre_commit(provider_.get(), conn_id,
+                                               &ws_handle, WSREP_FLAG_COMMIT,
+                                               &meta);
+                }
+
+                switch (rc)
+                {
+                case WSREP_OK:
+                    provider_->post_commit(provider_.get(), &ws_handle);
+                    lat_.push_back(
+                        std::chrono::duration_cast<std::chrono::microseconds>(
+                            clock::now() - start).count());
+                    ++Global::commits_;
+                    break;
+                case WSREP_TRX_FAIL:
+                case WSREP_BF_ABORT:
+                    provider_->post_rollback(provider_.get(), &ws_handle);
+                    ++Global::cert_failures_;
+                    break;
+                default:
+                    provider_->post_rollback(provider_.get(), &ws_handle);
+                    ++Global::errors_;
+                    if (rc >= WSREP_CONN_FAIL)
+                    {
+                        std::cerr << "client " << idx_ << ": fatal error "
+                                  << rc << std::endl;
+                        return;
+                    }
+                }
+            }
+
+            provider_->free_connection(provider_.get(), conn_id);
+        }
+
+        const std::vector<long long>& latencies() const { return lat_; }
+
+        Client(const Client&)          = delete;
+        void operator=(const Client&)  = delete;
+    private:
+        const Config&          config_;
+        Provider&              provider_;
+        const KeyDist&         dist_;
+        size_t const           idx_;
+        std::mt19937_64        rng_;
+        std::string const      payload_;
+        std::vector<long long> lat_;
+    };
+
+
+    long long percentile(const std::vector<long long>& sorted, double p)
+    {
+        if (sorted.empty()) return 0;
+        size_t idx(std::ceil(p * sorted.size()));
+        if (idx > 0) --idx;
+        return sorted[std::min(idx, sorted.size() - 1)];
+    }
+}
+
+
+int main(int argc, char* argv[])
+{
+    wsbench::Config   config(argc, argv);
+    wsbench::Provider provider(config);
+    wsbench::KeyDist  dist(config);
+
+    wsrep_gtid_t const state_id = { WSREP_UUID_UNDEFINED,
+                                    WSREP_SEQNO_UNDEFINED };
+
+    struct wsrep_init_args args;
+    memset(&args, 0, sizeof(args));
+    args.app_ctx         = 0;
+    args.node_name       = config.name();
+    args.node_address    = "";
+    args.node_incoming   = "";
+    args.data_dir        = config.data_dir();
+    args.options         = config.options();
+    args.proto_ver       = 127;
+    args.state_id        = &state_id;
+    args.state           = 0;
+    args.state_len       = 0;
+    args.logger_cb       = wsbench::logger_cb;
+    args.view_handler_cb = wsbench::view_cb;
+    args.apply_cb        = wsbench::apply_cb;
+    args.commit_cb       = wsbench::commit_cb;
+    args.unordered_cb    = wsbench::unordered_cb;
+    args.sst_donate_cb   = wsbench::sst_donate_cb;
+    args.synced_cb       = wsbench::synced_cb;
+
+    if (provider->init(provider.get(), &args) != WSREP_OK)
+    {
+        std::cerr << "Failed to initialize provider" << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    if (provider->connect(provider.get(), "wsbench", config.address(), "",
+                          config.bootstrap()) != WSREP_OK)
+    {
+        std::cerr << "Failed to connect to " << config.address() << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    std::vector<std::thread> appliers;
+    for (size_t i(0); i < config.appliers(); ++i)
+    {
+        appliers.push_back(std::thread([&provider]()
+            { provider->recv(provider.get(), 0); }));
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(wsbench::Global::mtx_);
+        wsbench::Global::cond_.wait(lock,
+            []() { return wsbench::Global::synced_.load(); });
+    }
+
+    std::vector<std::unique_ptr<wsbench::Client> > clients;
+    std::vector<std::thread> client_thds;
+    for (size_t i(0); i < config.clients(); ++i)
+    {
+        clients.push_back(std::unique_ptr<wsbench::Client>(
+                              new wsbench::Client(config, provider, dist, i)));
+        client_thds.push_back(
+            std::thread(&wsbench::Client::run, clients.back().get()));
+    }
+
+    wsbench::clock::time_point const start(wsbench::clock::now());
+    long long last_commits(0);
+
+    for (time_t s(1); s <= config.duration(); ++s)
+    {
+        std::this_thread::sleep_until(start + std::chrono::seconds(s));
+        long long const commits(wsbench::Global::commits_.load());
+        if (!config.compact())
+        {
+            std::cerr << "[" << std::setw(4) << s << "s] tps: "
+                      << commits - last_commits
+                      << ", cert failures: "
+                      << wsbench::Global::cert_failures_.load()
+                      << ", applied: " << wsbench::Global::applied_.load()
+                      << std::endl;
+        }
+        last_commits = commits;
+    }
+
+    wsbench::Global::stop_ = true;
+    std::for_each(client_thds.begin(), client_thds.end(),
+                  [](std::thread& thd) { thd.join(); });
+
+    double const elapsed(std::chrono::duration<double>(
+                             wsbench::clock::now() - start).count());
+
+    std::vector<long long> lat;
+    for (size_t i(0); i < clients.size(); ++i)
+    {
+        lat.insert(lat.end(), clients[i]->latencies().begin(),
+                   clients[i]->latencies().end());
+    }
+    std::sort(lat.begin(), lat.end());
+
+    long long const commits(wsbench::Global::commits_.load());
+    long long const failures(wsbench::Global::cert_failures_.load());
+    long long const errors(wsbench::Global::errors_.load());
+    long long const attempts(commits + failures + errors);
+    double const fail_rate(double(failures)/(attempts == 0 ? 1 : attempts));
+
+    if (config.compact() == true)
+    {
+        std::cout << "TPS " << commits/elapsed
+                  << " p50 " << wsbench::percentile(lat, 0.5)
+                  << " p99 " << wsbench::percentile(lat, 0.99)
+                  << " p999 " << wsbench::percentile(lat, 0.999)
+                  << " CertFailRate " << fail_rate
+                  << " Errors " << errors
+                  << std::endl;
+    }
+    else
+    {
+        std::cout << "Commits          : " << commits << "\n"
+                  << "TPS              : " << commits/elapsed << "\n"
+                  << "Latency p50, us  : " << wsbench::percentile(lat, 0.5)
+                  << "\n"
+                  << "Latency p90, us  : " << wsbench::percentile(lat, 0.9)
+                  << "\n"
+                  << "Latency p99, us  : " << wsbench::percentile(lat, 0.99)
+                  << "\n"
+                  << "Latency p99.9, us: " << wsbench::percentile(lat, 0.999)
+                  << "\n"
+                  << "Latency max, us  : " << (lat.empty() ? 0 : lat.back())
+                  << "\n"
+                  << "Cert failures    : " << failures << "\n"
+                  << "Cert failure rate: " << fail_rate << "\n"
+                  << "Errors           : " << errors << "\n"
+                  << "Applied          : " << wsbench::Global::applied_.load()
+                  << std::endl;
+    }
+
+    // makes appliers return from recv()
+    provider->disconnect(provider.get());
+    std::for_each(appliers.begin(), appliers.end(),
+                  [](std::thread& thd) { thd.join(); });
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,55 @@
+#!/bin/bash -eu
+#
+# Starts a local cluster of NODES wsbench instances over loopback and
+# prints results of each node. Extra arguments are passed to wsbench, e.g.
+#
+#   NODES=3 ./wsbench.sh --clients 8 --ws-size 512 --conflict-rate 0.01
+#
+
+declare -r BASE=$(cd $(dirname $0); pwd -P)
+
+NODES=${NODES:-3}
+PROVIDER=${PROVIDER:-"$BASE/../../libgalera_smm.so"}
+BASE_PORT=${BASE_PORT:-14567}
+WORK_DIR=${WORK_DIR:-"/tmp/wsbench"}
+WSBENCH=${WSBENCH:-"$BASE/wsbench"}
+
+PIDS=""
+trap 'kill $PIDS 2>/dev/null || :' EXIT
+
+for i in $(seq 0 $(( NODES - 1 )))
+do
+    DIR="$WORK_DIR/node$i"
+    rm -rf "$DIR" && mkdir -p "$DIR"
+    PORT=$(( BASE_PORT + i * 10 ))
+    OPTS="gmcast.listen_addr=tcp://127.0.0.1:$PORT; base_port=$PORT"
+    OPTS="$OPTS; ist.recv_addr=127.0.0.1:$(( PORT + 1 )); gcache.size=256M"
+
+    if [ $i -eq 0 ]
+    then
+        ARGS="--bootstrap --address gcomm://"
+    else
+        # let the first node come up, joiners connect to it
+        sleep 2
+        ARGS="--address gcomm://127.0.0.1:$BASE_PORT"
+    fi
+
+    $WSBENCH --provider "$PROVIDER" --name "node$i" --data-dir "$DIR" \
+             --options "$OPTS" $ARGS "$@" > "$DIR/result" 2> "$DIR/log" &
+    PIDS="$PIDS $!"
+done
+
+FAILED=0
+for pid in $PIDS
+do
+    wait $pid || FAILED=1
+done
+PIDS=""
+
+for i in $(seq 0 $(( NODES - 1 )))
+do
+    echo "node$i:"
+    cat "$WORK_DIR/node$i/result"
+done
+
+exit $FAILED